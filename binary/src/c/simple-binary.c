@@ -1,13 +1,47 @@
 #include <pebble.h>
 
+#include "dial_cache.h"
+#include "display_list.h"
+#include "face.h"
+#include "face_clock.h"
+#include "instrument.h"
+#include "peek.h"
+#include "power.h"
+#include "profile.h"
+#include "render_tier.h"
+#include "sector_fill.h"
+#include "settings.h"
+
 static Window *s_main_window; 
 static Layer *s_canvas_layer;
+// Minute hand and border, redrawn only where they change
+static DisplayList *s_display;
 
 static GPoint s_center;
+// Center with the screen clear and under a full Quick View peek
+static GPoint s_full_center;
+static GPoint s_peek_center;
 static int s_radius;
 static int s_minute_hand_length = 50;
 static GColor s_background_color;
 static bool s_use_rect;
+static Settings s_settings;
+
+// Snapshot of the background and hour fill, which change once an hour
+static DialCache s_dial_cache;
+static uint32_t s_dial_key;
+
+// What each render tier draws beyond the hour fill and the minute hand
+enum {
+  ElementBorder = 1 << 0,
+};
+
+static const uint32_t s_tiers[RenderTierCount] = {
+  [RenderTierFull] = ElementBorder,
+  [RenderTierSaver] = 0,
+};
+
+static void update_overlay(bool full);
 
 // Calculate the angle for hour hand (0 = 12 o'clock, clockwise)
 static int32_t get_hour_angle(struct tm *tick_time) {
@@ -17,9 +51,8 @@ static int32_t get_hour_angle(struct tm *tick_time) {
   if (hour >= 12) {
     hour -= 12;
   }
-  int minute = tick_time->tm_min;
-  
-  // Calculate precise angle including minutes
+
+  // The hand steps once an hour
   return TRIG_MAX_ANGLE / 12 * hour;
 }
 
@@ -33,42 +66,31 @@ static bool is_white_phase(int hour) {
   return hour < 12;
 }
 
-// Load settings
+// Load settings, from the blob or the keys older versions used
 static void load_settings() {
-  s_use_rect = persist_exists(MESSAGE_KEY_USE_RECT) ? 
-               persist_read_bool(MESSAGE_KEY_USE_RECT) : false;
-  s_background_color = persist_exists(MESSAGE_KEY_BACKGROUND_COLOR) ? (GColor){ .argb = (uint8_t)persist_read_int(MESSAGE_KEY_BACKGROUND_COLOR) } : GColorWhite;
-}
+  s_use_rect = false;
+  s_background_color = GColorWhite;
 
-// Save settings
-static void save_settings() {
-  persist_write_bool(MESSAGE_KEY_USE_RECT, s_use_rect);
-  persist_write_int(MESSAGE_KEY_BACKGROUND_COLOR, s_background_color.argb);
+  settings_init(&s_settings, 1);
+  settings_add_bool(&s_settings, MESSAGE_KEY_USE_RECT, &s_use_rect);
+  settings_add_color(&s_settings, MESSAGE_KEY_BACKGROUND_COLOR, &s_background_color);
+  power_add_settings(&s_settings);
+  render_tier_add_settings(&s_settings);
+  settings_load(&s_settings);
 }
 
 // Inbox received callback
 static void inbox_received_callback(DictionaryIterator *iterator, void *context) {
-  Tuple *rect_tuple = dict_find(iterator, MESSAGE_KEY_USE_RECT);
-  bool changed = false;
-  
-  if (rect_tuple) {
-    s_use_rect = rect_tuple->value->int32 == 1;
-    changed = true;
-  }
-
-  Tuple *bgcolor_tuple = dict_find(iterator, MESSAGE_KEY_BACKGROUND_COLOR);
-  if (bgcolor_tuple) {
-    s_background_color = GColorFromHEX(bgcolor_tuple->value->int32);
-    changed = true;
-  }
-
-  save_settings();
-
-  if (changed) {
-    layer_mark_dirty(s_canvas_layer);
+  profile_receive(iterator);
+  if (settings_apply(&s_settings, iterator)) {
+    power_settings_changed();
+    render_tier_settings_changed();
+    update_overlay(true);
   }
 }
 
+#ifdef PBL_BW
+// Only black and white displays draw the border in the reverse color
 static GColor reverse_color(GColor color) {
   // Simple inversion for black and white
   if (color.argb == GColorBlack.argb) {
@@ -77,50 +99,41 @@ static GColor reverse_color(GColor color) {
     return GColorBlack;
   }
 }
+#endif
 
-static void canvas_update_proc(Layer *layer, GContext *ctx) {
-  GRect bounds = layer_get_bounds(layer);
-  s_center = grect_center_point(&bounds);
+// Records the minute hand for the current time, and the border over its
+// outer end
+static void update_overlay(bool full) {
+  GRect bounds = layer_get_bounds(s_canvas_layer);
+  s_center = peek_lerp_point(s_full_center, s_peek_center);
   
-  // Calculate radius to fit in the display
-  s_radius = !s_use_rect ? ((bounds.size.w - 2) / 2) : ((bounds.size.h) / 2 + 40);
+  // Calculate radius to fit in the display; in square mode the fill has to
+  // reach the bottom corners however far up a peek moves the center
+  s_radius = !s_use_rect ? ((bounds.size.w - 2) / 2) : ((bounds.size.h) / 2 + 40 + s_full_center.y - s_center.y);
   
-  time_t now = time(NULL);
-  struct tm *tick_time = localtime(&now);
+  struct tm now = face_clock_now();
+  struct tm *tick_time = &now;
   
   int32_t hour_angle = get_hour_angle(tick_time);
   int32_t minute_angle = get_minute_angle(tick_time);
   int hour = tick_time->tm_hour;
   
   bool white_phase = is_white_phase(hour);
-  
-  // Fill the background white
-  graphics_context_set_fill_color(ctx, s_background_color);
-  graphics_fill_rect(ctx, bounds, 0, GCornerNone);
-  
-  // Create bounding rect for radial fill
-  GRect rect = GRect(s_center.x - s_radius, s_center.y - s_radius, s_radius * 2, s_radius * 2);
-  
-  int32_t start_at_12 = TRIG_MAX_ANGLE / 4;
-  
-  int32_t end_angle = start_at_12 - hour_angle;
-  while (end_angle < 0) end_angle += TRIG_MAX_ANGLE;
-  
-  if (white_phase) {
-    // 0-12 hours: Start black, fill white clockwise from 12
-    graphics_context_set_fill_color(ctx, GColorBlack);
-    graphics_fill_circle(ctx, s_center, s_radius);
-    
-    graphics_context_set_fill_color(ctx, GColorWhite);
-    graphics_fill_radial(ctx, rect, GOvalScaleModeFitCircle, s_radius, 0, hour_angle);
-  } else {
-    // 12-24 hours: Start white, fill black clockwise from 12
-    graphics_context_set_fill_color(ctx, GColorWhite);
-    graphics_fill_circle(ctx, s_center, s_radius);
-    
-    graphics_context_set_fill_color(ctx, GColorBlack);
-    graphics_fill_radial(ctx, rect, GOvalScaleModeFitCircle, s_radius, 0, hour_angle);
+
+  // The hour fill depends on the hour of the day, the settings and where
+  // the peek leaves the center only; a new one has to be drawn in full
+  s_dial_key = hour | (s_use_rect ? 1 << 5 : 0) | ((uint32_t)s_background_color.argb << 6) |
+               ((uint32_t)s_center.y << 14);
+  full = full || !dial_cache_has(&s_dial_cache, s_dial_key);
+
+  // Without a display list (out of memory at load) the dial goes without
+  // the parts it records
+  if (!s_display) {
+    layer_mark_dirty(s_canvas_layer);
+    return;
   }
+
+  display_list_begin(s_display);
   
   // Draw minute hand
   // Determine color based on background at minute position
@@ -134,9 +147,6 @@ static void canvas_update_proc(Layer *layer, GContext *ctx) {
     minute_on_white_bg = (minute_angle > hour_angle);
   }
   
-  graphics_context_set_stroke_color(ctx, minute_on_white_bg ? GColorBlack : GColorWhite);
-  graphics_context_set_stroke_width(ctx, 2);
-  
   // Calculate direction vector
   int32_t sin_val = sin_lookup(minute_angle);
   int32_t cos_val = cos_lookup(minute_angle);
@@ -152,26 +162,124 @@ static void canvas_update_proc(Layer *layer, GContext *ctx) {
     .y = s_center.y - (cos_val * (s_minute_hand_length) / TRIG_MAX_RATIO)
   };
   
-  graphics_draw_line(ctx, minute_start, minute_end);
+  display_list_draw_line(s_display, minute_start, minute_end, 2, minute_on_white_bg ? GColorBlack : GColorWhite);
   
   // Draw border
-  graphics_context_set_stroke_color(ctx, PBL_IF_COLOR_ELSE(GColorLightGray, reverse_color(s_background_color)));
-  graphics_context_set_stroke_width(ctx, 2);
+  GColor border_color = PBL_IF_COLOR_ELSE(GColorLightGray, reverse_color(s_background_color));
   
-  if (!s_use_rect) {
+  if (!render_tier_draws(ElementBorder)) {
+    // Left out at this tier
+  } else if (!s_use_rect) {
     // Round screen: draw circle border
-    graphics_draw_circle(ctx, s_center, s_radius);
+    display_list_draw_circle(s_display, s_center, s_radius, 2, border_color);
   } else {
     // Rectangular screen: draw 2px border following screen edge
     // Draw two rectangles to create a 2px border
-    graphics_draw_rect(ctx, GRect(0, 0, bounds.size.w, bounds.size.h));
-    graphics_draw_rect(ctx, GRect(1, 1, bounds.size.w - 2, bounds.size.h - 2));
+    display_list_draw_rect(s_display, GRect(0, 0, bounds.size.w, bounds.size.h), border_color);
+    display_list_draw_rect(s_display, GRect(1, 1, bounds.size.w - 2, bounds.size.h - 2), border_color);
+  }
+
+  display_list_end(s_display, full);
+}
+
+// Keeps a snapshot of the dial, except on the frames of a peek animation,
+// which each place it differently
+static void store_dial(GContext *ctx) {
+  if (!peek_is_animating()) {
+    dial_cache_store(&s_dial_cache, ctx, s_dial_key);
   }
 }
 
+// Draws the background and hour fill, and keeps a snapshot of them
+static void draw_dial(GContext *ctx, GRect bounds) {
+  struct tm now = face_clock_now();
+  struct tm *tick_time = &now;
+  
+  int32_t hour_angle = get_hour_angle(tick_time);
+  bool white_phase = is_white_phase(tick_time->tm_hour);
+
+  // 0-12 hours: black, filled white clockwise from 12; 12-24 hours the
+  // other way around. In square mode most of the circle is off screen, so
+  // it is filled row by row, each pixel once, only where it shows.
+  GColor fill_color = white_phase ? GColorWhite : GColorBlack;
+  GColor rest_color = white_phase ? GColorBlack : GColorWhite;
+  if (sector_fill(ctx, s_center, s_radius, hour_angle, fill_color, rest_color, s_background_color)) {
+    store_dial(ctx);
+    return;
+  }
+
+  // Same with the SDK's primitives when the frame buffer can't be captured
+  // Fill the background white
+  graphics_context_set_fill_color(ctx, s_background_color);
+  graphics_fill_rect(ctx, bounds, 0, GCornerNone);
+  
+  // Create bounding rect for radial fill
+  GRect rect = GRect(s_center.x - s_radius, s_center.y - s_radius, s_radius * 2, s_radius * 2);
+  
+  if (white_phase) {
+    // 0-12 hours: Start black, fill white clockwise from 12
+    graphics_context_set_fill_color(ctx, GColorBlack);
+    graphics_fill_circle(ctx, s_center, s_radius);
+    
+    graphics_context_set_fill_color(ctx, GColorWhite);
+    graphics_fill_radial(ctx, rect, GOvalScaleModeFitCircle, s_radius, 0, hour_angle);
+  } else {
+    // 12-24 hours: Start white, fill black clockwise from 12
+    graphics_context_set_fill_color(ctx, GColorWhite);
+    graphics_fill_circle(ctx, s_center, s_radius);
+    
+    graphics_context_set_fill_color(ctx, GColorBlack);
+    graphics_fill_radial(ctx, rect, GOvalScaleModeFitCircle, s_radius, 0, hour_angle);
+  }
+
+  store_dial(ctx);
+}
+
+// Restores the background and hour fill under the display list's regions
+static void canvas_update_proc(Layer *layer, GContext *ctx) {
+  instrument_stack_begin();
+  profile_frame_begin();
+
+  if (s_display && dial_cache_has(&s_dial_cache, s_dial_key)) {
+    for (uint8_t i = 0; i < display_list_get_num_regions(s_display); i++) {
+      dial_cache_restore_rect(&s_dial_cache, ctx, s_dial_key, display_list_get_region(s_display, i));
+    }
+  } else {
+    // Without a snapshot the list redraws everything, so draw the whole dial
+    draw_dial(ctx, layer_get_bounds(layer));
+  }
+
+  profile_frame_end();
+  instrument_frame(true);
+  instrument_heap(InstrumentPointUpdateProc);
+  instrument_stack_end();
+}
+
+// The hour fill and minute hand only move with the center
+static void peek_layout(GRect bounds, GRect obstructed) {
+  s_full_center = grect_center_point(&bounds);
+  s_peek_center = grect_center_point(&obstructed);
+}
+
+static void peek_frame(void) {
+  update_overlay(false);
+}
+
+// Redraws everything for the tier the battery charge calls for
+static void render_tier_handler(RenderTier tier) {
+  update_overlay(true);
+}
+
+// Catches up at once on a tap while the power policy held back redraws
+static void power_wake_handler(void) {
+  update_overlay(false);
+}
+
 static void tick_handler(struct tm *tick_time, TimeUnits units_changed) {
-  // Redraw the canvas
-  layer_mark_dirty(s_canvas_layer);
+  if (power_tick(tick_time, units_changed)) {
+    update_overlay(false);
+  }
+  instrument_report();
 }
 
 static void main_window_load(Window *window) {
@@ -182,18 +290,33 @@ static void main_window_load(Window *window) {
   s_canvas_layer = layer_create(bounds);
   layer_set_update_proc(s_canvas_layer, canvas_update_proc);
   layer_add_child(window_layer, s_canvas_layer);
+
+  s_display = display_list_create(s_canvas_layer, 4);
+  peek_init(s_canvas_layer, peek_layout, peek_frame);
+  update_overlay(true);
+
+  instrument_heap(InstrumentPointWindowLoad);
 }
 
 static void main_window_unload(Window *window) {
+  peek_deinit();
+  display_list_destroy(s_display);
   layer_destroy(s_canvas_layer);
+  dial_cache_destroy(&s_dial_cache);
 }
 
 static void init() {
+  instrument_heap(InstrumentPointInit);
+
   // Load settings
   load_settings();
+  render_tier_init(s_tiers, render_tier_handler);
+  profile_init(&s_settings);
   
   // Create main window
   s_main_window = window_create();
+  // The frame buffer keeps the last frame; only changed regions are redrawn
+  window_set_background_color(s_main_window, GColorClear);
   window_set_window_handlers(s_main_window, (WindowHandlers) {
     .load = main_window_load,
     .unload = main_window_unload
@@ -202,18 +325,26 @@ static void init() {
   
   // Register with TickTimerService
   tick_timer_service_subscribe(MINUTE_UNIT, tick_handler);
+  power_init(power_wake_handler);
 
   // Register callbacks
-  app_message_register_inbox_received(inbox_received_callback);
-  app_message_open(128, 128);
+  face_open_messages(inbox_received_callback, settings_inbox_size(&s_settings), 128);
+  instrument_heap(InstrumentPointAppMessageOpen);
 }
 
 static void deinit(void) {
+  power_deinit();
+  render_tier_deinit();
+  tick_timer_service_unsubscribe();
   window_destroy(s_main_window);
 }
 
+#ifdef FACE_COLLECTION
+const Face face_binary = { .name = "binary", .init = init, .deinit = deinit };
+#else
 int main(void) {
   init();
   app_event_loop();
   deinit();
 }
+#endif
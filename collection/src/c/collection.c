@@ -0,0 +1,103 @@
+#include <pebble.h>
+
+#include <stdlib.h>
+
+#include "face.h"
+#include "settings.h"
+
+// All five faces in one app, built with FACE_COLLECTION (common/src/c/face.h).
+// One of them runs at a time: the configuration page picks it with FACE,
+// and the collection stops the running face, which destroys its window and
+// with it the resources it loaded, before the next one starts.
+
+extern const Face face_eclipse;
+extern const Face face_trio;
+extern const Face face_enough;
+extern const Face face_binary;
+extern const Face face_hollow;
+
+// In the order of the configuration page's FACE options
+static const Face *const s_faces[] = {
+  &face_eclipse,
+  &face_trio,
+  &face_enough,
+  &face_binary,
+  &face_hollow,
+};
+
+#define NUM_FACES ((int)(sizeof(s_faces) / sizeof(s_faces[0])))
+
+// The face that runs, kept across launches
+#define FACE_PERSIST_KEY 1
+// Each face keeps its settings blob under a key of its own
+#define FACE_SETTINGS_PERSIST_KEY(index) (2 + (index))
+
+// The configuration page sends FACE and the settings of that face only
+#define COLLECTION_INBOX_SIZE (SETTINGS_INBOX_SIZE(SETTINGS_MAX_FIELDS) + sizeof(Tuple) + sizeof(int32_t))
+#define COLLECTION_OUTBOX_SIZE 128
+
+// Stays under the faces' windows, so the window stack never runs empty
+// while one face makes way for the next
+static Window *s_base_window;
+static int s_current;
+
+static void start_face(int index) {
+  s_current = index;
+  settings_set_persist_key(FACE_SETTINGS_PERSIST_KEY(index));
+  s_faces[index]->init();
+}
+
+static void stop_face(void) {
+  if (s_current < 0) {
+    return;
+  }
+  s_faces[s_current]->deinit();
+  face_forget_messages();
+  s_current = -1;
+}
+
+static void inbox_received_handler(DictionaryIterator *iterator, void *context) {
+  Tuple *face_t = dict_find(iterator, MESSAGE_KEY_FACE);
+  if (face_t) {
+    // A Clay select sends its value as a string
+    int index = face_t->type == TUPLE_CSTRING ? atoi(face_t->value->cstring) : face_t->value->int32;
+    if (index >= 0 && index < NUM_FACES && index != s_current) {
+      stop_face();
+      start_face(index);
+      persist_write_int(FACE_PERSIST_KEY, index);
+    }
+  }
+
+  // The face takes its own settings from the same message
+  AppMessageInboxReceived handler = face_get_inbox_handler();
+  if (handler) {
+    handler(iterator, context);
+  }
+}
+
+static void init(void) {
+  s_base_window = window_create();
+  window_set_background_color(s_base_window, GColorBlack);
+  window_stack_push(s_base_window, false);
+
+  int index = persist_exists(FACE_PERSIST_KEY) ? persist_read_int(FACE_PERSIST_KEY) : 0;
+  if (index < 0 || index >= NUM_FACES) {
+    index = 0;
+  }
+  s_current = -1;
+  start_face(index);
+
+  app_message_register_inbox_received(inbox_received_handler);
+  app_message_open(COLLECTION_INBOX_SIZE, COLLECTION_OUTBOX_SIZE);
+}
+
+static void deinit(void) {
+  stop_face();
+  window_destroy(s_base_window);
+}
+
+int main(void) {
+  init();
+  app_event_loop();
+  deinit();
+}
@@ -0,0 +1,144 @@
+// Settings the faces share a key for, like HOURS_COLOR, show once; each
+// face keeps what it was last sent for them. index.js shows only the ones
+// the chosen face uses.
+module.exports = [
+  {
+    "type": "heading",
+    "defaultValue": "Simple Collection Settings"
+  },
+  {
+    "type": "section",
+    "items": [
+      {
+        "type": "select",
+        "messageKey": "FACE",
+        "label": "Face",
+        "defaultValue": "0",
+        "options": [
+          { "label": "Eclipse", "value": "0" },
+          { "label": "Trio", "value": "1" },
+          { "label": "Enough", "value": "2" },
+          { "label": "Binary", "value": "3" },
+          { "label": "Hollow", "value": "4" }
+        ]
+      }
+    ]
+  },
+  {
+    "type": "section",
+    "items": [
+      {
+        "type": "heading",
+        "defaultValue": "Display Options"
+      },
+      {
+        "type": "color",
+        "messageKey": "HOURS_COLOR",
+        "defaultValue": "FFFFFF",
+        "label": "Hours Color",
+        "sunlight": true,
+        "allowGray": true,
+        "capabilities": ["COLOR"]
+      },
+      {
+        "type": "color",
+        "messageKey": "HOURS_OVERLAY_COLOR",
+        "defaultValue": "8EE69E",
+        "label": "Hours Overlay Color",
+        "sunlight": true,
+        "allowGray": true
+      },
+      {
+        "type": "color",
+        "messageKey": "MINUTES_COLOR",
+        "defaultValue": "000000",
+        "label": "Minutes Color",
+        "sunlight": true,
+        "allowGray": true
+      },
+      {
+        "type": "color",
+        "messageKey": "MINUTES_OVERLAY_COLOR",
+        "defaultValue": "8EE69E",
+        "label": "Minutes Overlay Color",
+        "sunlight": true,
+        "allowGray": true
+      },
+      {
+        "type": "color",
+        "messageKey": "BACKGROUND_COLOR",
+        "defaultValue": "FFFFFF",
+        "label": "Background Color",
+        "sunlight": true,
+        "allowGray": true
+      },
+      {
+        "type": "toggle",
+        "messageKey": "INVERT_COLORS",
+        "label": "Invert Colors",
+        "description": "Switch between light and dark theme.",
+        "defaultValue": false
+      },
+      {
+        "type": "toggle",
+        "messageKey": "USE_SQUARE",
+        "label": "Use Square design",
+        "description": "Switch between square and round design.",
+        "defaultValue": false,
+        "capabilities": ["RECT"]
+      },
+      {
+        "type": "toggle",
+        "messageKey": "USE_RECT",
+        "label": "Use Square design",
+        "description": "Switch between square and round design.",
+        "defaultValue": false,
+        "capabilities": ["RECT"]
+      }
+    ]
+  },
+  {
+    "type": "section",
+    "items": [
+      {
+        "type": "heading",
+        "defaultValue": "Power Saving"
+      },
+      {
+        "type": "select",
+        "messageKey": "POWER_POLICY",
+        "label": "Slow Down",
+        "description": "Redraw less often while you sleep (with Pebble Health) or while the watch lies still. A tap brings it back at once.",
+        "defaultValue": "0",
+        "options": [
+          { "label": "Never", "value": "0" },
+          { "label": "While asleep", "value": "1" },
+          { "label": "While asleep or still", "value": "2" }
+        ]
+      },
+      {
+        "type": "slider",
+        "messageKey": "POWER_INTERVAL",
+        "label": "Minutes Between Redraws",
+        "defaultValue": 10,
+        "min": 2,
+        "max": 30,
+        "step": 1
+      },
+      {
+        "type": "slider",
+        "messageKey": "BATTERY_SAVER",
+        "label": "Simpler Drawing At Battery (%)",
+        "description": "Leave out some details while the battery is this low or lower; 0 never does.",
+        "defaultValue": 20,
+        "min": 0,
+        "max": 50,
+        "step": 10
+      }
+    ]
+  },
+  {
+    "type": "submit",
+    "defaultValue": "Save Settings"
+  }
+];
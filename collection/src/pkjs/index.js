@@ -0,0 +1,98 @@
+var Clay = require('@rebble/clay');
+var clayConfig = require('./config');
+
+// Which settings each face uses, in the order it adds them; the indices are
+// FACE's values
+var FACE_SETTINGS = [
+  ['INVERT_COLORS', 'USE_SQUARE', 'HOURS_COLOR', 'POWER_POLICY', 'POWER_INTERVAL', 'BATTERY_SAVER'],
+  ['INVERT_COLORS', 'POWER_POLICY', 'POWER_INTERVAL', 'BATTERY_SAVER'],
+  ['INVERT_COLORS', 'POWER_POLICY', 'POWER_INTERVAL', 'BATTERY_SAVER'],
+  ['USE_RECT', 'BACKGROUND_COLOR', 'POWER_POLICY', 'POWER_INTERVAL', 'BATTERY_SAVER'],
+  ['USE_RECT', 'BACKGROUND_COLOR', 'HOURS_COLOR', 'MINUTES_COLOR', 'HOURS_OVERLAY_COLOR',
+    'MINUTES_OVERLAY_COLOR', 'POWER_POLICY', 'POWER_INTERVAL', 'BATTERY_SAVER']
+];
+
+// Runs in the configuration page, which only gets the function's source, so
+// it is handed the table as userData and shows the chosen face's settings
+function showFaceSettings() {
+  var clayConfig = this;
+  clayConfig.on(clayConfig.EVENTS.AFTER_BUILD, function() {
+    var face = clayConfig.getItemByMessageKey('FACE');
+    var update = function() {
+      var used = clayConfig.meta.userData[face.get()] || [];
+      clayConfig.getItemsByType('color').concat(clayConfig.getItemsByType('toggle')).forEach(function(item) {
+        if (used.indexOf(item.messageKey) >= 0) {
+          item.show();
+        } else {
+          item.hide();
+        }
+      });
+    };
+    face.on('change', update);
+    update();
+  });
+}
+
+var clay = new Clay(clayConfig, showFaceSettings, { userData: FACE_SETTINGS, autoHandleEvents: false });
+
+// Settings go to the watch as deltas it acknowledges (common/src/pkjs). Of
+// the chosen face's settings, each face keeping a version of its own, and
+// FACE with every delta and on its own when it changed.
+require('simple-common/settings')(clay, {
+  scope: function(settings) {
+    return parseInt(settings.FACE, 10) || 0;
+  },
+  keys: function(settings) {
+    return FACE_SETTINGS[parseInt(settings.FACE, 10) || 0] || [];
+  },
+  header: 'FACE'
+});
+
+// The face the watch runs, as last saved on the configuration page
+function currentFace() {
+  try {
+    return parseInt(JSON.parse(localStorage.getItem('clay-settings')).FACE, 10) || 0;
+  } catch (e) {
+    return 0;
+  }
+}
+
+// Heap, stack and launch figures from builds with INSTRUMENTATION set, laid
+// out as InstrumentSummary in common/src/c/instrument.h
+Pebble.addEventListener('appmessage', function(e) {
+  var data = e.payload.INSTRUMENTATION;
+  if (!data || data[0] !== 2) {
+    return;
+  }
+  var u32 = function(i) {
+    return (data[i] | (data[i + 1] << 8) | (data[i + 2] << 16) | (data[i + 3] << 24)) >>> 0;
+  };
+  var points = ['init', 'window load', 'app message open', 'update proc'];
+  var heap = points.map(function(name, i) {
+    return name + ' ' + u32(1 + i * 8) + ' used/' + u32(5 + i * 8) + ' free';
+  });
+  var u16 = function(i) {
+    return data[i] | (data[i + 1] << 8);
+  };
+  console.log('heap: ' + heap.join(', ') + '; update proc stack: ' + u16(33) + ' bytes; launch: first frame ' +
+    u16(35) + ' ms, complete ' + u16(37) + ' ms');
+});
+
+// Minutes spent in each power mode, laid out as PowerReport in
+// common/src/c/power.h
+Pebble.addEventListener('appmessage', function(e) {
+  var data = e.payload.POWER_REPORT;
+  if (!data || data[0] !== 1) {
+    return;
+  }
+  var u32 = function(i) {
+    return (data[i] | (data[i + 1] << 8) | (data[i + 2] << 16) | (data[i + 3] << 24)) >>> 0;
+  };
+  console.log('power: ' + u32(1) + ' minutes active, ' + u32(5) + ' idle, ' + u32(9) + ' redraws skipped');
+});
+
+// Frame times from builds with PROFILING set (common/src/pkjs), with the
+// settings of the face the watch runs
+require('simple-common/profile')(function() {
+  return FACE_SETTINGS[currentFace()];
+});
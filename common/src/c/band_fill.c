@@ -0,0 +1,228 @@
+#include "band_fill.h"
+
+#include "span_fill.h"
+
+// The columns a shape covers on the current row
+typedef struct {
+  int16_t from;
+  int16_t to;
+} Span;
+
+// Per shape state kept from row to row
+typedef struct {
+  // Circles: the last half width, floor(sqrt(r^2 + r - dy^2))
+  int32_t half;
+  // Rects: how far in the rounded corners start on their rows
+  uint8_t insets[BAND_FILL_MAX_CORNER_RADIUS];
+  uint16_t corner_radius;
+} ShapeState;
+
+static int32_t isqrt(int32_t value) {
+  if (value <= 0) {
+    return 0;
+  }
+  int32_t root = 0;
+  int32_t bit = 1 << 30;
+  while (bit > value) {
+    bit >>= 2;
+  }
+  while (bit) {
+    if (value >= root + bit) {
+      value -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return root;
+}
+
+static int32_t div_floor(int32_t a, int32_t b) {
+  int32_t q = a / b;
+  return (a % b != 0 && ((a < 0) != (b < 0))) ? q - 1 : q;
+}
+
+// graphics_fill_rect() insets corner row i by ceil(r - sqrt(r^2 - d^2) - 0.5)
+// with d = r - (i + 0.5); doubled, that is ceil((2r - 1 - sqrt(t)) / 2)
+static void corner_table(ShapeState *state, uint16_t radius) {
+  for (int32_t i = 0; i < radius; i++) {
+    int32_t d = 2 * radius - 2 * i - 1;
+    int32_t inset = -div_floor(-(2 * radius - 1 - isqrt(4 * radius * radius - d * d)), 2);
+    state->insets[i] = inset > 0 ? inset : 0;
+  }
+}
+
+static bool shape_span(const BandShape *shape, ShapeState *state, int16_t y, Span *span) {
+  if (shape->type == BandShapeCircle) {
+    int32_t dy = y - shape->center.y;
+    int32_t r = shape->radius;
+    int32_t value = r * r + r - dy * dy;
+    if (value < 0) {
+      return false;
+    }
+    // Rows come in order, so the root moves a step or two at a time
+    while ((state->half + 1) * (state->half + 1) <= value) {
+      state->half++;
+    }
+    while (state->half * state->half > value) {
+      state->half--;
+    }
+    span->from = shape->center.x - state->half;
+    span->to = shape->center.x + state->half;
+    return true;
+  }
+
+  int16_t row = y - shape->rect.origin.y;
+  int16_t h = shape->rect.size.h;
+  if (row < 0 || row >= h || shape->rect.size.w <= 0) {
+    return false;
+  }
+  int16_t inset = 0;
+  uint16_t radius = state->corner_radius;
+  if (row < radius) {
+    inset = state->insets[row];
+  } else if (row >= h - radius) {
+    inset = state->insets[h - 1 - row];
+  }
+  span->from = shape->rect.origin.x + inset;
+  span->to = shape->rect.origin.x + shape->rect.size.w - 1 - inset;
+  return true;
+}
+
+// Each covering shape lies within the one before it, as rings do: the
+// row runs out to in on the left, across the innermost, and back out
+static void fill_nested(const GBitmapDataRowInfo *row, bool bw, int16_t y, const BandShape *shapes, const Span *spans,
+                        const uint8_t *order, uint8_t count) {
+  for (uint8_t k = 0; k + 1 < count; k++) {
+    const Span *outer = &spans[order[k]];
+    const Span *inner = &spans[order[k + 1]];
+    if (outer->from < inner->from) {
+      span_fill(row, bw, y, outer->from, inner->from - 1, shapes[order[k]].color);
+    }
+  }
+  const Span *innermost = &spans[order[count - 1]];
+  span_fill(row, bw, y, innermost->from, innermost->to, shapes[order[count - 1]].color);
+  for (int k = count - 2; k >= 0; k--) {
+    const Span *outer = &spans[order[k]];
+    const Span *inner = &spans[order[k + 1]];
+    if (inner->to < outer->to) {
+      span_fill(row, bw, y, inner->to + 1, outer->to, shapes[order[k]].color);
+    }
+  }
+}
+
+// Any other overlap: every shape's edges cut the row, and the runs between
+// two cuts each take the color of the last shape covering them
+static void fill_cut(const GBitmapDataRowInfo *row, bool bw, int16_t y, const BandShape *shapes, const Span *spans,
+                     const uint8_t *order, uint8_t count) {
+  int16_t cuts[2 * BAND_FILL_MAX_SHAPES];
+  uint8_t num_cuts = 0;
+  for (uint8_t k = 0; k < count; k++) {
+    int16_t ends[2] = { spans[order[k]].from, spans[order[k]].to + 1 };
+    for (uint8_t e = 0; e < 2; e++) {
+      uint8_t j = num_cuts++;
+      for (; j > 0 && cuts[j - 1] > ends[e]; j--) {
+        cuts[j] = cuts[j - 1];
+      }
+      cuts[j] = ends[e];
+    }
+  }
+
+  for (uint8_t c = 0; c + 1 < num_cuts; c++) {
+    int16_t x0 = cuts[c];
+    int16_t x1 = cuts[c + 1] - 1;
+    if (x0 > x1) {
+      continue;
+    }
+    for (int k = count - 1; k >= 0; k--) {
+      const Span *span = &spans[order[k]];
+      if (span->from <= x0 && span->to >= x1) {
+        span_fill(row, bw, y, x0, x1, shapes[order[k]].color);
+        break;
+      }
+    }
+  }
+}
+
+bool band_fill(GContext *ctx, const BandShape *shapes, uint8_t count) {
+  if (count > BAND_FILL_MAX_SHAPES) {
+    return false;
+  }
+  ShapeState states[BAND_FILL_MAX_SHAPES];
+  int16_t top = INT16_MAX;
+  int16_t bottom = INT16_MIN;
+  for (uint8_t i = 0; i < count; i++) {
+    const BandShape *shape = &shapes[i];
+    ShapeState *state = &states[i];
+    state->half = 0;
+    state->corner_radius = 0;
+    int16_t y0, y1;
+    if (shape->type == BandShapeCircle) {
+      y0 = shape->center.y - shape->radius;
+      y1 = shape->center.y + shape->radius;
+    } else {
+      // Clamped like graphics_fill_rect() does
+      int16_t w = shape->rect.size.w;
+      int16_t h = shape->rect.size.h;
+      uint16_t radius = shape->corner_radius;
+      if (radius > (w < h ? w : h) / 2) {
+        radius = (w < h ? w : h) / 2;
+      }
+      if (radius > BAND_FILL_MAX_CORNER_RADIUS) {
+        return false;
+      }
+      state->corner_radius = radius;
+      corner_table(state, radius);
+      y0 = shape->rect.origin.y;
+      y1 = shape->rect.origin.y + h - 1;
+    }
+    if (y0 < top) top = y0;
+    if (y1 > bottom) bottom = y1;
+  }
+
+  GBitmap *fb = graphics_capture_frame_buffer(ctx);
+  if (!fb) {
+    return false;
+  }
+  GRect bounds = gbitmap_get_bounds(fb);
+  bool bw = gbitmap_get_format(fb) == GBitmapFormat1Bit;
+  if (top < 0) top = 0;
+  if (bottom > bounds.size.h - 1) bottom = bounds.size.h - 1;
+
+  for (int16_t y = top; y <= bottom; y++) {
+    GBitmapDataRowInfo info = gbitmap_get_data_row_info(fb, y);
+
+    Span spans[BAND_FILL_MAX_SHAPES];
+    uint8_t order[BAND_FILL_MAX_SHAPES];
+    uint8_t num_covering = 0;
+    bool nested = true;
+    for (uint8_t i = 0; i < count; i++) {
+      Span *span = &spans[i];
+      if (!shape_span(&shapes[i], &states[i], y, span) || shapes[i].color.a == 0) {
+        continue;
+      }
+      if (span->from < info.min_x) span->from = info.min_x;
+      if (span->to > info.max_x) span->to = info.max_x;
+      if (span->from > span->to) {
+        continue;
+      }
+      if (num_covering) {
+        const Span *outer = &spans[order[num_covering - 1]];
+        nested = nested && span->from >= outer->from && span->to <= outer->to;
+      }
+      order[num_covering++] = i;
+    }
+    if (!num_covering) {
+      continue;
+    }
+    if (nested) {
+      fill_nested(&info, bw, y, shapes, spans, order, num_covering);
+    } else {
+      fill_cut(&info, bw, y, shapes, spans, order, num_covering);
+    }
+  }
+
+  graphics_release_frame_buffer(ctx, fb);
+  return true;
+}
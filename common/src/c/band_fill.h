@@ -0,0 +1,41 @@
+#pragma once
+
+#include <pebble.h>
+
+// Paints a stack of filled shapes, such as the nested rings of a bezel,
+// straight into the frame buffer in one pass. Each shape is painted over
+// the ones before it, but rather than filling them in turn, every visible
+// row is cut at the shapes' edges and each run is written once, in the
+// color of the last shape that covers it. Round displays only get their
+// visible row ranges.
+//
+// Circles cover the same pixels as graphics_fill_circle(), their half
+// widths stepped from row to row as integer square roots. Rects cover the
+// same pixels as graphics_fill_rect() with GCornersAll, the insets of their
+// rounded corners worked out once per shape into a table. Runs are written
+// by span_fill(), which dithers the grays on 1-bit displays as the SDK does.
+
+#define BAND_FILL_MAX_SHAPES 6
+// Larger corners fall back to the SDK
+#define BAND_FILL_MAX_CORNER_RADIUS 16
+
+typedef enum {
+  BandShapeRect,
+  BandShapeCircle,
+} BandShapeType;
+
+typedef struct {
+  BandShapeType type;
+  GColor color;
+  // BandShapeRect, in frame buffer coordinates
+  GRect rect;
+  uint16_t corner_radius;
+  // BandShapeCircle, in frame buffer coordinates
+  GPoint center;
+  uint16_t radius;
+} BandShape;
+
+// Paints shapes[0] first and shapes[count - 1] last. Returns false, having
+// drawn nothing, when the frame buffer can't be captured or the shapes are
+// more or larger cornered than the limits above.
+bool band_fill(GContext *ctx, const BandShape *shapes, uint8_t count);
@@ -0,0 +1,191 @@
+#include "dial_cache.h"
+
+#include <string.h>
+
+// Bytes of row y that hold visible pixels. Rows of the round frame buffer
+// only store their visible range, starting at min_x.
+static uint16_t row_span(GBitmap *fb, uint16_t y, uint8_t **start) {
+  GBitmapDataRowInfo info = gbitmap_get_data_row_info(fb, y);
+  if (gbitmap_get_format(fb) == GBitmapFormat1Bit) {
+    *start = info.data;
+    return gbitmap_get_bytes_per_row(fb);
+  }
+  *start = info.data + info.min_x;
+  return info.max_x - info.min_x + 1;
+}
+
+static size_t snapshot_size(GBitmap *fb) {
+  GRect bounds = gbitmap_get_bounds(fb);
+  size_t size = 0;
+  for (int16_t y = 0; y < bounds.size.h; y++) {
+    uint8_t *start;
+    size += row_span(fb, y, &start);
+  }
+  return size;
+}
+
+bool dial_cache_restore(DialCache *cache, GContext *ctx, uint32_t key) {
+  if (!cache->valid || cache->key != key) {
+    return false;
+  }
+  GBitmap *fb = graphics_capture_frame_buffer(ctx);
+  if (!fb) {
+    return false;
+  }
+  GRect bounds = gbitmap_get_bounds(fb);
+  const uint8_t *src = cache->data;
+  for (int16_t y = 0; y < bounds.size.h; y++) {
+    uint8_t *start;
+    uint16_t len = row_span(fb, y, &start);
+    memcpy(start, src, len);
+    src += len;
+  }
+  graphics_release_frame_buffer(ctx, fb);
+  return true;
+}
+
+bool dial_cache_restore_rect(DialCache *cache, GContext *ctx, uint32_t key, GRect rect) {
+  if (!dial_cache_has(cache, key)) {
+    return false;
+  }
+  GBitmap *fb = graphics_capture_frame_buffer(ctx);
+  if (!fb) {
+    return false;
+  }
+  GRect bounds = gbitmap_get_bounds(fb);
+  bool bw = gbitmap_get_format(fb) == GBitmapFormat1Bit;
+  int16_t x0 = rect.origin.x > 0 ? rect.origin.x : 0;
+  int16_t y0 = rect.origin.y > 0 ? rect.origin.y : 0;
+  int16_t x1 = rect.origin.x + rect.size.w - 1;
+  int16_t y1 = rect.origin.y + rect.size.h - 1;
+  if (x1 >= bounds.size.w) x1 = bounds.size.w - 1;
+  if (y1 >= bounds.size.h) y1 = bounds.size.h - 1;
+
+  // Rows are packed back to back, so skip to the first one in the rect
+  const uint8_t *src = cache->data;
+  for (int16_t y = 0; y < y0; y++) {
+    uint8_t *start;
+    src += row_span(fb, y, &start);
+  }
+
+  for (int16_t y = y0; y <= y1 && x0 <= x1; y++) {
+    uint8_t *start;
+    uint16_t len = row_span(fb, y, &start);
+    if (bw) {
+      // Pixel x is bit x % 8 of byte x / 8; mask the partial end bytes
+      for (int16_t byte = x0 / 8; byte <= x1 / 8; byte++) {
+        uint8_t mask = 0xff;
+        if (byte == x0 / 8) mask &= (uint8_t)(0xff << (x0 % 8));
+        if (byte == x1 / 8) mask &= (uint8_t)(0xff >> (7 - x1 % 8));
+        start[byte] = (start[byte] & ~mask) | (src[byte] & mask);
+      }
+    } else {
+      // The row holds columns min_x..max_x from start
+      GBitmapDataRowInfo info = gbitmap_get_data_row_info(fb, y);
+      int16_t from = x0 > info.min_x ? x0 : info.min_x;
+      int16_t to = x1 < info.max_x ? x1 : info.max_x;
+      if (from <= to) {
+        memcpy(start + (from - info.min_x), src + (from - info.min_x), to - from + 1);
+      }
+    }
+    src += len;
+  }
+  graphics_release_frame_buffer(ctx, fb);
+  return true;
+}
+
+bool dial_cache_restore_moved(DialCache *cache, GContext *ctx, uint32_t key, int16_t dy) {
+  if (!dial_cache_has(cache, key)) {
+    return false;
+  }
+  GBitmap *fb = graphics_capture_frame_buffer(ctx);
+  if (!fb) {
+    return false;
+  }
+  GRect bounds = gbitmap_get_bounds(fb);
+  bool bw = gbitmap_get_format(fb) == GBitmapFormat1Bit;
+
+  // Rows are packed back to back; the source row only ever moves down, so
+  // walk to it from the last one
+  const uint8_t *src = cache->data;
+  int16_t src_y = 0;
+  for (int16_t y = 0; y < bounds.size.h; y++) {
+    int16_t from_y = y - dy;
+    if (from_y < 0) from_y = 0;
+    if (from_y >= bounds.size.h) from_y = bounds.size.h - 1;
+    uint8_t *start;
+    while (src_y < from_y) {
+      src += row_span(fb, src_y++, &start);
+    }
+
+    uint16_t len = row_span(fb, y, &start);
+    if (bw) {
+      memcpy(start, src, len);
+      continue;
+    }
+    // Each row holds columns min_x..max_x; copy where the two rows overlap
+    // and stretch the source's ends over the rest
+    GBitmapDataRowInfo info = gbitmap_get_data_row_info(fb, y);
+    GBitmapDataRowInfo from = gbitmap_get_data_row_info(fb, from_y);
+    int16_t x0 = info.min_x > from.min_x ? info.min_x : from.min_x;
+    int16_t x1 = info.max_x < from.max_x ? info.max_x : from.max_x;
+    if (x0 > info.min_x) {
+      memset(start, src[0], x0 - info.min_x);
+    }
+    memcpy(start + (x0 - info.min_x), src + (x0 - from.min_x), x1 - x0 + 1);
+    if (x1 < info.max_x) {
+      memset(start + (x1 - info.min_x + 1), src[from.max_x - from.min_x], info.max_x - x1);
+    }
+  }
+  graphics_release_frame_buffer(ctx, fb);
+  return true;
+}
+
+bool dial_cache_has(const DialCache *cache, uint32_t key) {
+  return cache->valid && cache->key == key;
+}
+
+void dial_cache_store(DialCache *cache, GContext *ctx, uint32_t key) {
+  cache->valid = false;
+  GBitmap *fb = graphics_capture_frame_buffer(ctx);
+  if (!fb) {
+    return;
+  }
+
+  size_t size = snapshot_size(fb);
+  if (size != cache->size) {
+    free(cache->data);
+    cache->data = NULL;
+    cache->size = 0;
+    // Leave the rest of the heap to the face; without a snapshot it simply
+    // draws the dial every frame
+    if (size + DIAL_CACHE_HEAP_RESERVE <= heap_bytes_free()) {
+      cache->data = malloc(size);
+    }
+    if (!cache->data) {
+      graphics_release_frame_buffer(ctx, fb);
+      return;
+    }
+    cache->size = size;
+  }
+
+  GRect bounds = gbitmap_get_bounds(fb);
+  uint8_t *dst = cache->data;
+  for (int16_t y = 0; y < bounds.size.h; y++) {
+    uint8_t *start;
+    uint16_t len = row_span(fb, y, &start);
+    memcpy(dst, start, len);
+    dst += len;
+  }
+  graphics_release_frame_buffer(ctx, fb);
+
+  cache->key = key;
+  cache->valid = true;
+}
+
+void dial_cache_destroy(DialCache *cache) {
+  free(cache->data);
+  cache->data = NULL;
+  cache->size = 0;
+  cache->valid = false;
+}
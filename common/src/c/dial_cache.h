@@ -0,0 +1,44 @@
+#pragma once
+
+#include <pebble.h>
+
+// Snapshot of the static part of a face (background, rings, ticks, numerals)
+// taken straight from the frame buffer. A face draws its dial once, stores
+// it, and on later frames restores it and draws only the hands.
+//
+// The key is whatever the face derives from the settings that change the
+// dial; a restore with a different key misses. When the snapshot would not
+// leave DIAL_CACHE_HEAP_RESERVE bytes free (aplite) nothing is stored and
+// the face keeps drawing its dial directly.
+
+#define DIAL_CACHE_HEAP_RESERVE 2048
+
+typedef struct {
+  uint8_t *data;
+  size_t size;
+  uint32_t key;
+  bool valid;
+} DialCache;
+
+// Copies the snapshot back into the frame buffer. Returns false if there is
+// no snapshot for this key, in which case the dial has to be drawn.
+bool dial_cache_restore(DialCache *cache, GContext *ctx, uint32_t key);
+
+// Copies back only the part of the snapshot inside rect, in frame buffer
+// coordinates. Returns false if there is no snapshot for this key.
+bool dial_cache_restore_rect(DialCache *cache, GContext *ctx, uint32_t key, GRect rect);
+
+// Copies the snapshot back moved dy rows down, or up when dy is negative,
+// for the frames of a Quick View animation, when the dial slides between
+// two layouts. Rows moved in from beyond the snapshot repeat its nearest
+// one; on the round frame buffer, so do the columns a row lacks. Returns
+// false if there is no snapshot for this key.
+bool dial_cache_restore_moved(DialCache *cache, GContext *ctx, uint32_t key, int16_t dy);
+
+// Whether a restore with this key would hit
+bool dial_cache_has(const DialCache *cache, uint32_t key);
+
+// Captures the frame buffer as the snapshot for key
+void dial_cache_store(DialCache *cache, GContext *ctx, uint32_t key);
+
+void dial_cache_destroy(DialCache *cache);
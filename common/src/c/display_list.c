@@ -0,0 +1,546 @@
+#include "display_list.h"
+
+#include <string.h>
+
+#include "thick_line.h"
+
+#ifdef DISPLAY_LIST_OBSERVER
+// Host builds hand every finished frame to the harness
+void DISPLAY_LIST_OBSERVER(const DisplayList *list);
+#endif
+
+static DisplayList *s_focus_list;
+
+// Rectangles
+
+static bool rect_is_empty(GRect rect) {
+  return rect.size.w <= 0 || rect.size.h <= 0;
+}
+
+static bool rects_overlap(GRect a, GRect b) {
+  return a.origin.x < b.origin.x + b.size.w && b.origin.x < a.origin.x + a.size.w &&
+         a.origin.y < b.origin.y + b.size.h && b.origin.y < a.origin.y + a.size.h;
+}
+
+static GRect rect_union(GRect a, GRect b) {
+  int16_t x0 = a.origin.x < b.origin.x ? a.origin.x : b.origin.x;
+  int16_t y0 = a.origin.y < b.origin.y ? a.origin.y : b.origin.y;
+  int16_t ax1 = a.origin.x + a.size.w;
+  int16_t bx1 = b.origin.x + b.size.w;
+  int16_t ay1 = a.origin.y + a.size.h;
+  int16_t by1 = b.origin.y + b.size.h;
+  return GRect(x0, y0, (ax1 > bx1 ? ax1 : bx1) - x0, (ay1 > by1 ? ay1 : by1) - y0);
+}
+
+static GRect rect_clip(GRect rect, GRect bounds) {
+  int16_t x0 = rect.origin.x > bounds.origin.x ? rect.origin.x : bounds.origin.x;
+  int16_t y0 = rect.origin.y > bounds.origin.y ? rect.origin.y : bounds.origin.y;
+  int16_t rx1 = rect.origin.x + rect.size.w;
+  int16_t bx1 = bounds.origin.x + bounds.size.w;
+  int16_t ry1 = rect.origin.y + rect.size.h;
+  int16_t by1 = bounds.origin.y + bounds.size.h;
+  int16_t x1 = rx1 < bx1 ? rx1 : bx1;
+  int16_t y1 = ry1 < by1 ? ry1 : by1;
+  if (x1 <= x0 || y1 <= y0) {
+    return GRectZero;
+  }
+  return GRect(x0, y0, x1 - x0, y1 - y0);
+}
+
+static int32_t rect_area(GRect rect) {
+  return (int32_t)rect.size.w * rect.size.h;
+}
+
+// Box from inclusive corners, grown by margin on every side
+static GRect box_around(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t margin) {
+  if (x1 < x0) {
+    int16_t t = x0;
+    x0 = x1;
+    x1 = t;
+  }
+  if (y1 < y0) {
+    int16_t t = y0;
+    y0 = y1;
+    y1 = t;
+  }
+  return GRect(x0 - margin, y0 - margin, x1 - x0 + 1 + 2 * margin, y1 - y0 + 1 + 2 * margin);
+}
+
+// Recording
+
+static DisplayCommand *push_command(DisplayList *list, DisplayCommandType type, GColor color) {
+  if (list->num_commands == list->capacity) {
+    list->overflow = true;
+    return NULL;
+  }
+  DisplayCommand *command = &list->commands[list->num_commands++];
+  // Zeroed so padding and unused fields don't disturb the hash
+  memset(command, 0, sizeof(*command));
+  command->type = type;
+  command->color = color;
+  return command;
+}
+
+void display_list_begin(DisplayList *list) {
+  list->num_commands = 0;
+  list->overflow = false;
+}
+
+void display_list_fill_rect(DisplayList *list, GRect rect, uint16_t corner_radius, GCornerMask corners, GColor color) {
+  DisplayCommand *command = push_command(list, DisplayCommandFillRect, color);
+  if (command) {
+    command->box = rect;
+    command->rect.rect = rect;
+    command->rect.corner_radius = corner_radius;
+    command->rect.corners = corners;
+  }
+}
+
+void display_list_draw_rect(DisplayList *list, GRect rect, GColor color) {
+  DisplayCommand *command = push_command(list, DisplayCommandDrawRect, color);
+  if (command) {
+    command->box = rect;
+    command->rect.rect = rect;
+  }
+}
+
+void display_list_fill_circle(DisplayList *list, GPoint center, uint16_t radius, GColor color) {
+  DisplayCommand *command = push_command(list, DisplayCommandFillCircle, color);
+  if (command) {
+    command->box = box_around(center.x - radius, center.y - radius, center.x + radius, center.y + radius, 1);
+    command->circle.center = center;
+    command->circle.radius = radius;
+  }
+}
+
+void display_list_draw_circle(DisplayList *list, GPoint center, uint16_t radius, uint8_t stroke_width, GColor color) {
+  DisplayCommand *command = push_command(list, DisplayCommandDrawCircle, color);
+  if (command) {
+    command->stroke_width = stroke_width;
+    command->box = box_around(center.x - radius, center.y - radius, center.x + radius, center.y + radius,
+                              stroke_width / 2 + 2);
+    command->circle.center = center;
+    command->circle.radius = radius;
+  }
+}
+
+void display_list_fill_radial(DisplayList *list, GRect rect, uint16_t inset, int32_t angle_start, int32_t angle_end,
+                              GColor color) {
+  DisplayCommand *command = push_command(list, DisplayCommandFillRadial, color);
+  if (command) {
+    command->box = GRect(rect.origin.x - 1, rect.origin.y - 1, rect.size.w + 2, rect.size.h + 2);
+    command->radial.rect = rect;
+    command->radial.inset = inset;
+    command->radial.angle_start = angle_start;
+    command->radial.angle_end = angle_end;
+  }
+}
+
+// Round caps and antialiasing reach past a line's center by this much
+static int16_t line_margin(uint8_t stroke_width) {
+  return stroke_width / 2 + 2;
+}
+
+void display_list_draw_line(DisplayList *list, GPoint p0, GPoint p1, uint8_t stroke_width, GColor color) {
+  DisplayCommand *command = push_command(list, DisplayCommandDrawLine, color);
+  if (command) {
+    command->stroke_width = stroke_width;
+    command->box = box_around(p0.x, p0.y, p1.x, p1.y, line_margin(stroke_width));
+    command->line.p0 = p0;
+    command->line.p1 = p1;
+  }
+}
+
+void display_list_fill_path(DisplayList *list, const GPath *path, GColor color) {
+  if (path->num_points > DISPLAY_LIST_PATH_POINTS) {
+    list->overflow = true;
+    return;
+  }
+  DisplayCommand *command = push_command(list, DisplayCommandFillPath, color);
+  if (!command) {
+    return;
+  }
+
+  // Same transform as gpath_draw_filled(), so the replay at rotation 0 hits
+  // the same pixels
+  int32_t cosine = cos_lookup(path->rotation);
+  int32_t sine = sin_lookup(path->rotation);
+  int16_t min_x = INT16_MAX, min_y = INT16_MAX, max_x = INT16_MIN, max_y = INT16_MIN;
+  for (uint32_t i = 0; i < path->num_points; i++) {
+    GPoint p = path->points[i];
+    int16_t x = (p.x * cosine - p.y * sine) / TRIG_MAX_RATIO + path->offset.x;
+    int16_t y = (p.y * cosine + p.x * sine) / TRIG_MAX_RATIO + path->offset.y;
+    command->path.points[i] = GPoint(x, y);
+    if (x < min_x) min_x = x;
+    if (x > max_x) max_x = x;
+    if (y < min_y) min_y = y;
+    if (y > max_y) max_y = y;
+  }
+  command->path.num_points = path->num_points;
+  command->box = path->num_points ? box_around(min_x, min_y, max_x, max_y, 1) : GRectZero;
+}
+
+void display_list_draw_image(DisplayList *list, GDrawCommandImage *image, GPoint origin) {
+  if (!image) {
+    return;
+  }
+  DisplayCommand *command = push_command(list, DisplayCommandDrawImage, GColorClear);
+  if (command) {
+    GSize size = gdraw_command_image_get_bounds_size(image);
+    command->box = GRect(origin.x - 1, origin.y - 1, size.w + 2, size.h + 2);
+    command->image.image = image;
+    command->image.origin = origin;
+  }
+}
+
+// Replay
+
+static void draw_command(GContext *ctx, const DisplayCommand *command, GRect clip) {
+  switch ((DisplayCommandType)command->type) {
+    case DisplayCommandFillRect:
+      graphics_context_set_fill_color(ctx, command->color);
+      graphics_fill_rect(ctx, command->rect.rect, command->rect.corner_radius, command->rect.corners);
+      break;
+    case DisplayCommandDrawRect:
+      graphics_context_set_stroke_color(ctx, command->color);
+      graphics_draw_rect(ctx, command->rect.rect);
+      break;
+    case DisplayCommandFillCircle:
+      graphics_context_set_fill_color(ctx, command->color);
+      graphics_fill_circle(ctx, command->circle.center, command->circle.radius);
+      break;
+    case DisplayCommandDrawCircle:
+      graphics_context_set_stroke_color(ctx, command->color);
+      graphics_context_set_stroke_width(ctx, command->stroke_width);
+      graphics_draw_circle(ctx, command->circle.center, command->circle.radius);
+      break;
+    case DisplayCommandFillRadial:
+      graphics_context_set_fill_color(ctx, command->color);
+      graphics_fill_radial(ctx, command->radial.rect, GOvalScaleModeFitCircle, command->radial.inset,
+                           command->radial.angle_start, command->radial.angle_end);
+      break;
+    case DisplayCommandDrawLine:
+      // Wide strokes go straight into the frame buffer, which the region's
+      // frame doesn't clip
+      if (command->stroke_width > 1 &&
+          thick_line_draw(ctx, clip, command->line.p0, command->line.p1, command->stroke_width, ThickLineCapRound,
+                          false, command->color)) {
+        break;
+      }
+      graphics_context_set_stroke_color(ctx, command->color);
+      graphics_context_set_stroke_width(ctx, command->stroke_width);
+      graphics_draw_line(ctx, command->line.p0, command->line.p1);
+      break;
+    case DisplayCommandFillPath: {
+      GPath path = {
+        .num_points = command->path.num_points,
+        .points = (GPoint *)command->path.points,
+        .rotation = 0,
+        .offset = GPointZero,
+      };
+      graphics_context_set_fill_color(ctx, command->color);
+      gpath_draw_filled(ctx, &path);
+      break;
+    }
+    case DisplayCommandDrawImage:
+      gdraw_command_image_draw(ctx, command->image.image, command->image.origin);
+      break;
+  }
+}
+
+static bool rect_inside(GRect inner, GRect outer) {
+  return inner.origin.x >= outer.origin.x && inner.origin.y >= outer.origin.y &&
+         inner.origin.x + inner.size.w <= outer.origin.x + outer.size.w &&
+         inner.origin.y + inner.size.h <= outer.origin.y + outer.size.h;
+}
+
+// Whether the command can draw inside rect. Outlines don't reach a rect that
+// lies wholly within their hollow middle, such as a band along a hand.
+static bool command_touches(const DisplayCommand *command, GRect rect) {
+  if (!rects_overlap(command->box, rect)) {
+    return false;
+  }
+  if (command->type == DisplayCommandDrawRect) {
+    GRect inside = command->rect.rect;
+    return !rect_inside(rect, GRect(inside.origin.x + 2, inside.origin.y + 2, inside.size.w - 4, inside.size.h - 4));
+  }
+  if (command->type == DisplayCommandDrawCircle) {
+    int32_t inner = (int32_t)command->circle.radius - command->stroke_width / 2 - 2;
+    if (inner <= 0) {
+      return true;
+    }
+    // The rect's farthest corner from the center
+    int32_t dx0 = rect.origin.x - command->circle.center.x;
+    int32_t dx1 = rect.origin.x + rect.size.w - 1 - command->circle.center.x;
+    int32_t dy0 = rect.origin.y - command->circle.center.y;
+    int32_t dy1 = rect.origin.y + rect.size.h - 1 - command->circle.center.y;
+    int32_t dx = dx0 * dx0 > dx1 * dx1 ? dx0 : dx1;
+    int32_t dy = dy0 * dy0 > dy1 * dy1 ? dy0 : dy1;
+    return dx * dx + dy * dy >= inner * inner;
+  }
+  return true;
+}
+
+// Region layers draw in parent coordinates, clipped to their frame
+static void region_update_proc(Layer *layer, GContext *ctx) {
+  DisplayList *list = *(DisplayList **)layer_get_data(layer);
+  GRect clip = layer_get_frame(layer);
+  list->pending = false;
+  for (uint16_t i = 0; i < list->num_commands; i++) {
+    if (command_touches(&list->commands[i], clip)) {
+      draw_command(ctx, &list->commands[i], clip);
+    }
+  }
+}
+
+// Diffing
+
+static uint32_t command_hash(const DisplayCommand *command) {
+  // FNV-1a
+  const uint8_t *bytes = (const uint8_t *)command;
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < sizeof(*command); i++) {
+    hash = (hash ^ bytes[i]) * 16777619u;
+  }
+  return hash;
+}
+
+static void remove_region(DisplayList *list, uint8_t index) {
+  list->regions[index] = list->regions[--list->num_regions];
+}
+
+// Adds box to the regions, keeping them disjoint and within the maximum
+static void add_region(DisplayList *list, GRect box) {
+  box = rect_clip(box, layer_get_bounds(list->parent));
+  if (rect_is_empty(box)) {
+    return;
+  }
+
+  // A merged region can reach further ones, so go again until nothing overlaps
+  bool merged = true;
+  while (merged) {
+    merged = false;
+    for (uint8_t i = 0; i < list->num_regions; i++) {
+      if (rects_overlap(list->regions[i], box)) {
+        box = rect_union(list->regions[i], box);
+        remove_region(list, i);
+        merged = true;
+        break;
+      }
+    }
+  }
+
+  if (list->num_regions < DISPLAY_LIST_MAX_REGIONS) {
+    list->regions[list->num_regions++] = box;
+    return;
+  }
+
+  // Out of regions: fold the box into the one that grows least
+  uint8_t best = 0;
+  int32_t best_growth = INT32_MAX;
+  for (uint8_t i = 0; i < list->num_regions; i++) {
+    int32_t growth = rect_area(rect_union(list->regions[i], box)) - rect_area(list->regions[i]);
+    if (growth < best_growth) {
+      best = i;
+      best_growth = growth;
+    }
+  }
+  GRect grown = rect_union(list->regions[best], box);
+  remove_region(list, best);
+  add_region(list, grown);
+}
+
+static int16_t floor_to(int16_t value, int16_t step) {
+  int16_t rest = value % step;
+  return rest < 0 ? value - rest - step : value - rest;
+}
+
+// Columns the center of the line p0-p1 crosses within rows y0..y1
+static void line_columns(GPoint p0, GPoint p1, int16_t y0, int16_t y1, int16_t *x0, int16_t *x1) {
+  if (p0.y == p1.y) {
+    *x0 = p0.x < p1.x ? p0.x : p1.x;
+    *x1 = p0.x < p1.x ? p1.x : p0.x;
+    return;
+  }
+  if (p1.y < p0.y) {
+    GPoint t = p0;
+    p0 = p1;
+    p1 = t;
+  }
+  if (y0 < p0.y) y0 = p0.y;
+  if (y1 > p1.y) y1 = p1.y;
+  int32_t run = p1.x - p0.x;
+  int32_t rise = p1.y - p0.y;
+  int16_t a = p0.x + run * (y0 - p0.y) / rise;
+  int16_t b = p0.x + run * (y1 - p0.y) / rise;
+  // A column either side for the truncated division
+  *x0 = (a < b ? a : b) - 1;
+  *x1 = (a < b ? b : a) + 1;
+}
+
+// Adds the area of a line as bands on the grid of DISPLAY_LIST_BAND_HEIGHT
+// rows, each as wide as the line with its margin is in those rows
+static void add_line_regions(DisplayList *list, const DisplayCommandSummary *line) {
+  GRect box = rect_clip(line->box, layer_get_bounds(list->parent));
+  if (rect_is_empty(box)) {
+    return;
+  }
+  int16_t bottom = box.origin.y + box.size.h;
+  for (int16_t band = floor_to(box.origin.y, DISPLAY_LIST_BAND_HEIGHT); band < bottom;
+       band += DISPLAY_LIST_BAND_HEIGHT) {
+    int16_t y0 = band > box.origin.y ? band : box.origin.y;
+    int16_t y1 = band + DISPLAY_LIST_BAND_HEIGHT < bottom ? band + DISPLAY_LIST_BAND_HEIGHT : bottom;
+    // Rows up to a margin away hold centers whose caps reach into the band
+    int16_t x0, x1;
+    line_columns(line->p0, line->p1, y0 - line->margin, y1 - 1 + line->margin, &x0, &x1);
+    add_region(list, GRect(x0 - line->margin, y0, x1 - x0 + 1 + 2 * line->margin, y1 - y0));
+  }
+}
+
+static void add_summary_region(DisplayList *list, const DisplayCommandSummary *summary) {
+  if (summary->line) {
+    add_line_regions(list, summary);
+  } else {
+    add_region(list, summary->box);
+  }
+}
+
+static void apply_regions(DisplayList *list) {
+  GRect bounds = layer_get_bounds(list->parent);
+  for (uint8_t i = 0; i < DISPLAY_LIST_MAX_REGIONS; i++) {
+    Layer *layer = list->region_layers[i];
+    if (i < list->num_regions) {
+      GRect region = list->regions[i];
+      layer_set_frame(layer, region);
+      layer_set_bounds(layer, GRect(-region.origin.x, -region.origin.y, bounds.size.w, bounds.size.h));
+      layer_set_hidden(layer, false);
+    } else {
+      layer_set_hidden(layer, true);
+    }
+  }
+  if (list->num_regions) {
+    list->pending = true;
+    layer_mark_dirty(list->parent);
+  }
+}
+
+void display_list_end(DisplayList *list, bool full) {
+  // Regions that were never drawn still have to be, along with this frame's
+  if (!list->pending) {
+    list->num_regions = 0;
+  }
+  list->num_changed = 0;
+
+  uint16_t count = list->num_commands > list->num_previous ? list->num_commands : list->num_previous;
+  for (uint16_t i = 0; i < count; i++) {
+    bool current = i < list->num_commands;
+    bool previous = i < list->num_previous;
+    uint32_t hash = current ? command_hash(&list->commands[i]) : 0;
+    if (current && previous && list->previous[i].hash == hash &&
+        grect_equal(&list->previous[i].box, &list->commands[i].box)) {
+      continue;
+    }
+    list->num_changed++;
+    if (previous) {
+      add_summary_region(list, &list->previous[i]);
+    }
+    if (current) {
+      const DisplayCommand *command = &list->commands[i];
+      DisplayCommandSummary *summary = &list->previous[i];
+      *summary = (DisplayCommandSummary) { .box = command->box, .hash = hash };
+      if (command->type == DisplayCommandDrawLine) {
+        summary->line = true;
+        summary->margin = line_margin(command->stroke_width);
+        summary->p0 = command->line.p0;
+        summary->p1 = command->line.p1;
+      }
+      add_summary_region(list, summary);
+    }
+  }
+  list->num_previous = list->num_commands;
+
+  if (full || !list->has_previous || list->overflow) {
+    list->num_regions = 1;
+    list->regions[0] = layer_get_bounds(list->parent);
+  }
+  list->has_previous = true;
+  apply_regions(list);
+
+#ifdef DISPLAY_LIST_OBSERVER
+  DISPLAY_LIST_OBSERVER(list);
+#endif
+}
+
+void display_list_invalidate(DisplayList *list) {
+  list->num_regions = 1;
+  list->regions[0] = layer_get_bounds(list->parent);
+  apply_regions(list);
+}
+
+uint8_t display_list_get_num_regions(const DisplayList *list) {
+  return list->num_regions;
+}
+
+GRect display_list_get_region(const DisplayList *list, uint8_t index) {
+  return list->regions[index];
+}
+
+// Lifetime
+
+static void app_did_focus(bool in_focus) {
+  // Whatever covered the app may have drawn over the frame buffer
+  if (in_focus && s_focus_list) {
+    display_list_invalidate(s_focus_list);
+  }
+}
+
+DisplayList *display_list_create(Layer *parent, uint16_t capacity) {
+  DisplayList *list = calloc(1, sizeof(DisplayList));
+  if (!list) {
+    return NULL;
+  }
+  list->parent = parent;
+  list->capacity = capacity;
+  list->commands = malloc(capacity * sizeof(DisplayCommand));
+  list->previous = malloc(capacity * sizeof(DisplayCommandSummary));
+  if (!list->commands || !list->previous) {
+    display_list_destroy(list);
+    return NULL;
+  }
+
+  GRect bounds = layer_get_bounds(parent);
+  for (uint8_t i = 0; i < DISPLAY_LIST_MAX_REGIONS; i++) {
+    Layer *layer = layer_create_with_data(bounds, sizeof(DisplayList *));
+    if (!layer) {
+      display_list_destroy(list);
+      return NULL;
+    }
+    *(DisplayList **)layer_get_data(layer) = list;
+    layer_set_update_proc(layer, region_update_proc);
+    layer_set_hidden(layer, true);
+    layer_add_child(parent, layer);
+    list->region_layers[i] = layer;
+  }
+
+  s_focus_list = list;
+  app_focus_service_subscribe_handlers((AppFocusHandlers) { .did_focus = app_did_focus });
+  return list;
+}
+
+void display_list_destroy(DisplayList *list) {
+  if (!list) {
+    return;
+  }
+  if (s_focus_list == list) {
+    app_focus_service_unsubscribe();
+    s_focus_list = NULL;
+  }
+  for (uint8_t i = 0; i < DISPLAY_LIST_MAX_REGIONS; i++) {
+    if (list->region_layers[i]) {
+      layer_destroy(list->region_layers[i]);
+    }
+  }
+  free(list->commands);
+  free(list->previous);
+  free(list);
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <pebble.h>
+
+// Retained drawing for the parts of a face that change every tick (hands,
+// markers, hubs), on top of a static base the face can restore by area,
+// such as a DialCache snapshot or a plain background fill.
+//
+// Whenever the time or the settings change the face records the whole
+// overlay into the list, and ends the frame. The list diffs the commands
+// with the previous frame and merges the areas of the ones that changed into
+// at most DISPLAY_LIST_MAX_REGIONS disjoint regions. A line's area is cut
+// into bands DISPLAY_LIST_BAND_HEIGHT rows high, each only as wide as the
+// line is within it, so a moving hand dirties a strip along its old and new
+// positions rather than the box around both. Each region is a child layer of
+// the parent; its frame clips the replay of every command that touches it.
+// The parent's update proc only restores the base under each region, so the
+// rest of the frame buffer keeps the previous frame.
+//
+// This relies on the frame buffer surviving between frames: the window needs
+// a GColorClear background and the parent layer has to sit at the frame
+// buffer origin. The first frame, and any frame ended with full set, is one
+// region covering the whole parent.
+
+#define DISPLAY_LIST_MAX_REGIONS 8
+// Bands sit on a grid of the parent's rows, so the bands of two lines in the
+// same rows merge without spilling into the next ones
+#define DISPLAY_LIST_BAND_HEIGHT 16
+#define DISPLAY_LIST_PATH_POINTS 6
+
+typedef enum {
+  DisplayCommandFillRect,
+  DisplayCommandDrawRect,
+  DisplayCommandFillCircle,
+  DisplayCommandDrawCircle,
+  DisplayCommandFillRadial,
+  DisplayCommandDrawLine,
+  DisplayCommandFillPath,
+  DisplayCommandDrawImage,
+} DisplayCommandType;
+
+typedef struct {
+  uint8_t type;
+  GColor color;
+  uint8_t stroke_width;
+  // Every pixel the command can touch
+  GRect box;
+  union {
+    struct {
+      GRect rect;
+      uint16_t corner_radius;
+      GCornerMask corners;
+    } rect;
+    struct {
+      GPoint center;
+      uint16_t radius;
+    } circle;
+    struct {
+      GRect rect;
+      uint16_t inset;
+      int32_t angle_start;
+      int32_t angle_end;
+    } radial;
+    struct {
+      GPoint p0;
+      GPoint p1;
+    } line;
+    // Points already rotated and moved, as gpath_draw_filled() would
+    struct {
+      uint8_t num_points;
+      GPoint points[DISPLAY_LIST_PATH_POINTS];
+    } path;
+    struct {
+      GDrawCommandImage *image;
+      GPoint origin;
+    } image;
+  };
+} DisplayCommand;
+
+// What is kept of a command for the next frame's diff
+typedef struct {
+  GRect box;
+  uint32_t hash;
+  // Lines are dirtied band by band
+  bool line;
+  uint8_t margin;
+  GPoint p0;
+  GPoint p1;
+} DisplayCommandSummary;
+
+typedef struct {
+  Layer *parent;
+  Layer *region_layers[DISPLAY_LIST_MAX_REGIONS];
+  DisplayCommand *commands;
+  DisplayCommandSummary *previous;
+  uint16_t capacity;
+  uint16_t num_commands;
+  uint16_t num_previous;
+  // Commands that differ from the previous frame's, and whether one was
+  // dropped because the list was full
+  uint16_t num_changed;
+  bool overflow;
+  bool has_previous;
+  // Whether the regions are still waiting to be drawn
+  bool pending;
+  uint8_t num_regions;
+  GRect regions[DISPLAY_LIST_MAX_REGIONS];
+} DisplayList;
+
+// Creates the list with room for capacity commands per frame, and its region
+// layers as children of parent. Returns NULL if out of memory. A face has
+// one list; it takes over the app focus service.
+DisplayList *display_list_create(Layer *parent, uint16_t capacity);
+void display_list_destroy(DisplayList *list);
+
+// Starts recording a frame
+void display_list_begin(DisplayList *list);
+
+void display_list_fill_rect(DisplayList *list, GRect rect, uint16_t corner_radius, GCornerMask corners, GColor color);
+void display_list_draw_rect(DisplayList *list, GRect rect, GColor color);
+void display_list_fill_circle(DisplayList *list, GPoint center, uint16_t radius, GColor color);
+void display_list_draw_circle(DisplayList *list, GPoint center, uint16_t radius, uint8_t stroke_width, GColor color);
+// Always GOvalScaleModeFitCircle
+void display_list_fill_radial(DisplayList *list, GRect rect, uint16_t inset, int32_t angle_start, int32_t angle_end,
+                              GColor color);
+void display_list_draw_line(DisplayList *list, GPoint p0, GPoint p1, uint8_t stroke_width, GColor color);
+void display_list_fill_path(DisplayList *list, const GPath *path, GColor color);
+void display_list_draw_image(DisplayList *list, GDrawCommandImage *image, GPoint origin);
+
+// Ends the frame: works out the regions to redraw and marks the parent
+// dirty if there are any. With full set the whole parent is redrawn, for
+// when the base has to be drawn from scratch.
+void display_list_end(DisplayList *list, bool full);
+
+// Redraws the last frame in full, e.g. after something else drew over the
+// frame buffer. The list does this itself when the app regains focus.
+void display_list_invalidate(DisplayList *list);
+
+// Regions of the last frame, in parent coordinates, for restoring the base
+uint8_t display_list_get_num_regions(const DisplayList *list);
+GRect display_list_get_region(const DisplayList *list, uint8_t index);
@@ -0,0 +1,26 @@
+#include "face.h"
+
+#ifdef FACE_COLLECTION
+
+static AppMessageInboxReceived s_inbox_handler;
+
+void face_open_messages(AppMessageInboxReceived handler, uint32_t inbox_size, uint32_t outbox_size) {
+  s_inbox_handler = handler;
+}
+
+AppMessageInboxReceived face_get_inbox_handler(void) {
+  return s_inbox_handler;
+}
+
+void face_forget_messages(void) {
+  s_inbox_handler = NULL;
+}
+
+#else
+
+void face_open_messages(AppMessageInboxReceived handler, uint32_t inbox_size, uint32_t outbox_size) {
+  app_message_register_inbox_received(handler);
+  app_message_open(inbox_size, outbox_size);
+}
+
+#endif
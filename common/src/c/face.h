@@ -0,0 +1,34 @@
+#pragma once
+
+#include <pebble.h>
+
+// The faces run either as apps of their own or, built with FACE_COLLECTION,
+// all in the collection app (collection/), which runs one of them at a time
+// and switches to another when the phone asks for it.
+//
+// In the collection a face exports a Face instead of main(). The next face
+// starts in the same app after its deinit(), so that has to release
+// everything init() took, and init() has to reset the statics it relies on.
+
+typedef struct {
+  const char *name;
+  // Loads the face's settings, pushes its window and subscribes to what it
+  // needs
+  void (*init)(void);
+  void (*deinit)(void);
+} Face;
+
+// Registers the face's inbox handler and opens AppMessage with buffers of
+// these sizes. In the collection AppMessage is opened once, with room for
+// every face, and the collection passes each message on to this handler.
+void face_open_messages(AppMessageInboxReceived handler, uint32_t inbox_size, uint32_t outbox_size);
+
+#ifdef FACE_COLLECTION
+
+// The handler the running face registered, if any
+AppMessageInboxReceived face_get_inbox_handler(void);
+
+// Drops it, once the face has stopped
+void face_forget_messages(void);
+
+#endif
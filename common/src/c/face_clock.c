@@ -0,0 +1,14 @@
+#include "face_clock.h"
+
+#ifdef FACE_CLOCK
+time_t FACE_CLOCK(void);
+#endif
+
+struct tm face_clock_now(void) {
+#ifdef FACE_CLOCK
+  time_t now = FACE_CLOCK();
+#else
+  time_t now = time(NULL);
+#endif
+  return *localtime(&now);
+}
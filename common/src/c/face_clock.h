@@ -0,0 +1,13 @@
+#pragma once
+
+#include <pebble.h>
+
+// The local time the faces draw, read in one place for their update procs,
+// tick handlers and window loads alike.
+//
+// On the watch it is the real clock, time() and localtime(). Faces built
+// with FACE_CLOCK naming a function returning a time_t, as the host harness
+// builds them (host/Makefile), ask that function instead, so the harness
+// decides the minute every frame shows.
+
+struct tm face_clock_now(void);
@@ -0,0 +1,112 @@
+#include "instrument.h"
+
+#ifdef INSTRUMENTATION
+
+#define STACK_PATTERN 0xa5
+// Left unpainted right below the update proc's frame, for the frames of the
+// instrumentation calls themselves
+#define STACK_SKIP 256
+
+static const char *const s_point_names[InstrumentPointCount] = {
+  "init",
+  "window load",
+  "app message open",
+  "update proc",
+};
+
+static InstrumentSummary s_summary = { .version = INSTRUMENT_SUMMARY_VERSION };
+static bool s_changed;
+// Stack pointer of the update proc, roughly
+static uint8_t *s_stack_base;
+// When init started, and whether the first frame and the first complete one
+// have been timed since
+static time_t s_launch;
+static uint16_t s_launch_ms;
+static bool s_first_frame_timed;
+static bool s_complete_timed;
+
+void instrument_heap(InstrumentPoint point) {
+  uint32_t used = heap_bytes_used();
+  uint32_t free = heap_bytes_free();
+  if (point == InstrumentPointInit) {
+    // A new run, which matters where the app's statics outlive it (the host
+    // harness): start from an empty summary that is always sent once
+    s_summary = (InstrumentSummary) { .version = INSTRUMENT_SUMMARY_VERSION };
+    s_changed = true;
+    s_launch_ms = time_ms(&s_launch, NULL);
+    s_first_frame_timed = s_complete_timed = false;
+  }
+  if (used == s_summary.heap[point].used && free == s_summary.heap[point].free) {
+    return;
+  }
+  s_summary.heap[point].used = used;
+  s_summary.heap[point].free = free;
+  s_changed = true;
+  APP_LOG(APP_LOG_LEVEL_INFO, "heap at %s: %lu used, %lu free", s_point_names[point], (unsigned long)used,
+          (unsigned long)free);
+}
+
+// Not inlined, so its frame sits just below the caller's
+__attribute__((noinline)) void instrument_stack_begin(void) {
+  s_stack_base = __builtin_frame_address(0);
+  volatile uint8_t *p = s_stack_base - INSTRUMENT_STACK_PAINT;
+  while (p < s_stack_base - STACK_SKIP) {
+    *p++ = STACK_PATTERN;
+  }
+}
+
+__attribute__((noinline)) void instrument_stack_end(void) {
+  if (!s_stack_base) {
+    return;
+  }
+  // The deepest byte that lost the pattern
+  const volatile uint8_t *p = s_stack_base - INSTRUMENT_STACK_PAINT;
+  while (p < s_stack_base - STACK_SKIP && *p == STACK_PATTERN) {
+    p++;
+  }
+  uint16_t depth = s_stack_base - (const uint8_t *)p;
+  s_stack_base = NULL;
+  if (depth > s_summary.stack_peak) {
+    s_summary.stack_peak = depth;
+    s_changed = true;
+    APP_LOG(APP_LOG_LEVEL_INFO, "update proc stack: %u bytes", depth);
+  }
+}
+
+void instrument_frame(bool complete) {
+  if (s_complete_timed || (s_first_frame_timed && !complete)) {
+    return;
+  }
+  time_t now;
+  uint16_t now_ms = time_ms(&now, NULL);
+  int32_t elapsed = (int32_t)(now - s_launch) * 1000 + now_ms - s_launch_ms;
+  uint16_t ms = elapsed < 0 ? 0 : elapsed > UINT16_MAX ? UINT16_MAX : elapsed;
+  if (!s_first_frame_timed) {
+    s_first_frame_timed = true;
+    s_summary.launch_first_frame = ms;
+    APP_LOG(APP_LOG_LEVEL_INFO, "launch: first frame after %u ms", ms);
+  }
+  if (complete) {
+    s_complete_timed = true;
+    s_summary.launch_complete = ms;
+    APP_LOG(APP_LOG_LEVEL_INFO, "launch: complete frame after %u ms", ms);
+  }
+  s_changed = true;
+}
+
+void instrument_report(void) {
+  if (!s_changed) {
+    return;
+  }
+  // If the outbox is busy, the next call tries again
+  DictionaryIterator *iterator;
+  if (app_message_outbox_begin(&iterator) != APP_MSG_OK) {
+    return;
+  }
+  dict_write_data(iterator, MESSAGE_KEY_INSTRUMENTATION, (const uint8_t *)&s_summary, sizeof(s_summary));
+  if (app_message_outbox_send() == APP_MSG_OK) {
+    s_changed = false;
+  }
+}
+
+#endif
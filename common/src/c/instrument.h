@@ -0,0 +1,73 @@
+#pragma once
+
+#include <pebble.h>
+
+// Heap and stack figures, to see how close a face runs to the memory limit
+// (aplite's above all). Only built when INSTRUMENTATION is defined, which
+// the wscripts do when INSTRUMENTATION is set in the environment of
+// `pebble build`; otherwise every call below compiles to nothing.
+//
+// Heap use is sampled at fixed points of the face's life. Stack use is
+// measured around the canvas update proc by filling INSTRUMENT_STACK_PAINT
+// bytes below its frame with a pattern and finding the deepest byte its
+// calls overwrote. The launch is timed with time_ms() from init to the
+// first frame and to the first frame with everything on it, for faces that
+// load some of it after the first frame. Samples are logged when they
+// change, and the latest of each goes to the phone as an InstrumentSummary
+// under MESSAGE_KEY_INSTRUMENTATION.
+
+typedef enum {
+  InstrumentPointInit,
+  // At the end of window load; resources loaded after the first frame
+  // count from the update proc on
+  InstrumentPointWindowLoad,
+  InstrumentPointAppMessageOpen,
+  // At the end of the canvas update proc
+  InstrumentPointUpdateProc,
+  InstrumentPointCount,
+} InstrumentPoint;
+
+#define INSTRUMENT_SUMMARY_VERSION 2
+#define INSTRUMENT_STACK_PAINT 1024
+
+// Sent as a byte array, little endian
+typedef struct __attribute__((__packed__)) {
+  uint8_t version;
+  struct __attribute__((__packed__)) {
+    uint32_t used;
+    uint32_t free;
+  } heap[InstrumentPointCount];
+  // Deepest stack use below the update proc's frame, in bytes; equal to
+  // INSTRUMENT_STACK_PAINT if it went past the painted area
+  uint16_t stack_peak;
+  // Milliseconds from init to the end of the first frame, and of the first
+  // complete one
+  uint16_t launch_first_frame;
+  uint16_t launch_complete;
+} InstrumentSummary;
+
+#ifdef INSTRUMENTATION
+
+void instrument_heap(InstrumentPoint point);
+
+// Call first and last thing in the update proc
+void instrument_stack_begin(void);
+void instrument_stack_end(void);
+
+// Call at the end of the update proc, with whether the frame has everything
+// the face draws
+void instrument_frame(bool complete);
+
+// Sends the summary if it changed since the last one went out. Call it
+// outside of rendering, e.g. from the tick handler.
+void instrument_report(void);
+
+#else
+
+#define instrument_heap(point)
+#define instrument_stack_begin()
+#define instrument_stack_end()
+#define instrument_frame(complete)
+#define instrument_report()
+
+#endif
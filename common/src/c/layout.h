@@ -0,0 +1,22 @@
+#pragma once
+
+#include <pebble.h>
+
+// Types of the per-platform tables that common/tools/gen_layout.py writes to
+// layout.auto.h. Points are offsets from the display center.
+
+typedef struct {
+  int8_t x;
+  int8_t y;
+} LayoutOffset8;
+
+typedef struct {
+  int16_t x;
+  int16_t y;
+} LayoutOffset16;
+
+// Works with either offset type
+#define LAYOUT_POINT(center, offset) GPoint((center).x + (offset).x, (center).y + (offset).y)
+
+// Index into the 720 entry hour tables
+#define LAYOUT_HOUR_INDEX(tm) (((tm)->tm_hour % 12) * 60 + (tm)->tm_min)
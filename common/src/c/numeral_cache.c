@@ -0,0 +1,129 @@
+#include "numeral_cache.h"
+
+#include <string.h>
+
+static bool is_bw(GBitmap *fb) {
+  return gbitmap_get_format(fb) == GBitmapFormat1Bit;
+}
+
+// Bytes a row of the piece takes: whole frame buffer bytes on 1 bit
+// displays, where pixel x is bit x % 8 of byte x / 8
+static uint16_t row_bytes(bool bw, GRect rect) {
+  if (bw) {
+    return (rect.origin.x + rect.size.w - 1) / 8 - rect.origin.x / 8 + 1;
+  }
+  return rect.size.w;
+}
+
+static GRect clip_to(GRect rect, GRect bounds) {
+  int16_t x0 = rect.origin.x > bounds.origin.x ? rect.origin.x : bounds.origin.x;
+  int16_t y0 = rect.origin.y > bounds.origin.y ? rect.origin.y : bounds.origin.y;
+  int16_t x1 = rect.origin.x + rect.size.w;
+  int16_t y1 = rect.origin.y + rect.size.h;
+  if (x1 > bounds.origin.x + bounds.size.w) x1 = bounds.origin.x + bounds.size.w;
+  if (y1 > bounds.origin.y + bounds.size.h) y1 = bounds.origin.y + bounds.size.h;
+  if (x1 <= x0 || y1 <= y0) {
+    return GRectZero;
+  }
+  return GRect(x0, y0, x1 - x0, y1 - y0);
+}
+
+// Copies the piece into the frame buffer, or out of it into the piece
+static void copy_patch(GBitmap *fb, const NumeralPatch *patch, bool to_fb) {
+  bool bw = is_bw(fb);
+  int16_t x0 = patch->rect.origin.x;
+  int16_t x1 = x0 + patch->rect.size.w - 1;
+  uint16_t len = row_bytes(bw, patch->rect);
+  uint8_t *data = patch->data;
+  for (int16_t y = patch->rect.origin.y; y < patch->rect.origin.y + patch->rect.size.h; y++, data += len) {
+    GBitmapDataRowInfo info = gbitmap_get_data_row_info(fb, y);
+    if (bw) {
+      uint8_t *row = info.data + x0 / 8;
+      if (!to_fb) {
+        memcpy(data, row, len);
+        continue;
+      }
+      // Keep the pixels of the end bytes that lie outside the piece
+      for (uint16_t i = 0; i < len; i++) {
+        uint8_t mask = 0xff;
+        if (i == 0) mask &= (uint8_t)(0xff << (x0 % 8));
+        if (i == len - 1) mask &= (uint8_t)(0xff >> (7 - x1 % 8));
+        row[i] = (row[i] & ~mask) | (data[i] & mask);
+      }
+    } else {
+      // Round displays only store each row's visible range
+      int16_t from = x0 > info.min_x ? x0 : info.min_x;
+      int16_t to = x1 < info.max_x ? x1 : info.max_x;
+      if (from > to) {
+        continue;
+      }
+      if (to_fb) {
+        memcpy(info.data + from, data + (from - x0), to - from + 1);
+      } else {
+        memcpy(data + (from - x0), info.data + from, to - from + 1);
+      }
+    }
+  }
+}
+
+void numeral_cache_store(NumeralCache *cache, GContext *ctx, uint32_t key, const GRect *rects, uint8_t count) {
+  numeral_cache_destroy(cache);
+  GBitmap *fb = graphics_capture_frame_buffer(ctx);
+  if (!fb) {
+    return;
+  }
+  GRect bounds = gbitmap_get_bounds(fb);
+  bool bw = is_bw(fb);
+  if (count > NUMERAL_CACHE_MAX) {
+    count = NUMERAL_CACHE_MAX;
+  }
+  for (uint8_t i = 0; i < count; i++) {
+    GRect rect = clip_to(rects[i], bounds);
+    if (rect.size.w == 0) {
+      continue;
+    }
+    size_t size = (size_t)row_bytes(bw, rect) * rect.size.h;
+    // Same as for the dial snapshot: without the pieces the numerals are
+    // simply drawn
+    uint8_t *data = size + NUMERAL_CACHE_HEAP_RESERVE <= heap_bytes_free() ? malloc(size) : NULL;
+    if (!data) {
+      graphics_release_frame_buffer(ctx, fb);
+      numeral_cache_destroy(cache);
+      return;
+    }
+    NumeralPatch *patch = &cache->patches[cache->num_patches++];
+    *patch = (NumeralPatch) { .rect = rect, .data = data };
+    copy_patch(fb, patch, false);
+  }
+  graphics_release_frame_buffer(ctx, fb);
+
+  cache->key = key;
+  cache->valid = true;
+}
+
+bool numeral_cache_draw(NumeralCache *cache, GContext *ctx, uint32_t key) {
+  if (!numeral_cache_has(cache, key)) {
+    return false;
+  }
+  GBitmap *fb = graphics_capture_frame_buffer(ctx);
+  if (!fb) {
+    return false;
+  }
+  for (uint8_t i = 0; i < cache->num_patches; i++) {
+    copy_patch(fb, &cache->patches[i], true);
+  }
+  graphics_release_frame_buffer(ctx, fb);
+  return true;
+}
+
+bool numeral_cache_has(const NumeralCache *cache, uint32_t key) {
+  return cache->valid && cache->key == key;
+}
+
+void numeral_cache_destroy(NumeralCache *cache) {
+  for (uint8_t i = 0; i < cache->num_patches; i++) {
+    free(cache->patches[i].data);
+  }
+  cache->num_patches = 0;
+  cache->valid = false;
+}
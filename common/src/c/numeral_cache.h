@@ -0,0 +1,45 @@
+#pragma once
+
+#include <pebble.h>
+
+// The numerals of a dial as drawn, kept as small pieces of the frame buffer
+// so they can be copied back instead of rendering their vector images (and
+// the background under them) again.
+//
+// Faces whose dial fits in a DialCache never redraw their numerals between
+// color changes. This is for when the snapshot doesn't fit (aplite, low
+// on heap): the dial is then drawn every frame, and copying the numerals
+// back costs a fraction of interpreting their draw commands. Each piece is
+// stored in the frame buffer's own format, so 1 bit per pixel on aplite.
+//
+// Like the dial cache, pieces are stored under a key derived from the
+// settings that change them and where they sit, and a draw with another
+// key misses.
+
+#define NUMERAL_CACHE_MAX 3
+#define NUMERAL_CACHE_HEAP_RESERVE 1024
+
+typedef struct {
+  // In frame buffer coordinates, clipped to the screen
+  GRect rect;
+  uint8_t *data;
+} NumeralPatch;
+
+typedef struct {
+  NumeralPatch patches[NUMERAL_CACHE_MAX];
+  uint8_t num_patches;
+  uint32_t key;
+  bool valid;
+} NumeralCache;
+
+// Copies the pixels inside each of rects, with the numerals drawn in them,
+// as the pieces for key. Drops the cache if any piece doesn't fit.
+void numeral_cache_store(NumeralCache *cache, GContext *ctx, uint32_t key, const GRect *rects, uint8_t count);
+
+// Copies every piece back into the frame buffer. Returns false if there
+// are none for this key, in which case the numerals have to be drawn.
+bool numeral_cache_draw(NumeralCache *cache, GContext *ctx, uint32_t key);
+
+bool numeral_cache_has(const NumeralCache *cache, uint32_t key);
+
+void numeral_cache_destroy(NumeralCache *cache);
@@ -0,0 +1,19 @@
+#include "pdc_color.h"
+
+static bool set_command_color(GDrawCommand *command, uint32_t index, void *context) {
+  GColor color = *(GColor *)context;
+  if (gdraw_command_get_stroke_color(command).a != 0) {
+    gdraw_command_set_stroke_color(command, color);
+  }
+  if (gdraw_command_get_fill_color(command).a != 0) {
+    gdraw_command_set_fill_color(command, color);
+  }
+  return true;
+}
+
+void pdc_color_set(GDrawCommandImage *image, GColor color) {
+  if (!image) {
+    return;
+  }
+  gdraw_command_list_iterate(gdraw_command_image_get_command_list(image), set_command_color, &color);
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <pebble.h>
+
+// Recolors a PDC image in place, so one resource serves every color scheme
+// instead of one copy per scheme. Every command's stroke and fill become
+// color, except those left transparent in the resource, which stay
+// transparent (numerals are drawn as outlines with a clear fill).
+
+void pdc_color_set(GDrawCommandImage *image, GColor color);
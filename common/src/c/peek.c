@@ -0,0 +1,94 @@
+#include "peek.h"
+
+static Layer *s_layer;
+static PeekLayoutHandler s_layout;
+static PeekFrameHandler s_frame;
+// The obstructed extreme the face was last laid out for
+static GRect s_obstructed;
+static int32_t s_amount;
+static bool s_animating;
+
+#if PBL_API_EXISTS(unobstructed_area_service_subscribe)
+
+// Amounts the running animation goes from and to
+static int32_t s_from;
+static int32_t s_to;
+
+static void will_change(GRect final_unobstructed_screen_area, void *context) {
+  GRect bounds = layer_get_bounds(s_layer);
+  bool covering = final_unobstructed_screen_area.size.h < bounds.size.h;
+  if (covering && !grect_equal(&final_unobstructed_screen_area, &s_obstructed)) {
+    s_obstructed = final_unobstructed_screen_area;
+    s_layout(bounds, s_obstructed);
+  }
+  s_from = s_amount;
+  s_to = covering ? ANIMATION_NORMALIZED_MAX : 0;
+  s_animating = true;
+}
+
+static void change(AnimationProgress progress, void *context) {
+  // Both factors can reach ANIMATION_NORMALIZED_MAX
+  s_amount = s_from + (int64_t)(s_to - s_from) * progress / ANIMATION_NORMALIZED_MAX;
+  s_frame();
+}
+
+static void did_change(void *context) {
+  s_amount = s_to;
+  s_animating = false;
+  s_frame();
+}
+
+#endif
+
+void peek_init(Layer *layer, PeekLayoutHandler layout, PeekFrameHandler frame) {
+  s_layer = layer;
+  s_layout = layout;
+  s_frame = frame;
+  s_animating = false;
+
+  // The app may start under a peek
+  GRect bounds = layer_get_bounds(layer);
+#if PBL_API_EXISTS(unobstructed_area_service_subscribe)
+  s_obstructed = layer_get_unobstructed_bounds(layer);
+#else
+  // No Quick View here: the layer is never covered
+  s_obstructed = bounds;
+#endif
+  s_amount = s_obstructed.size.h < bounds.size.h ? ANIMATION_NORMALIZED_MAX : 0;
+  s_layout(bounds, s_obstructed);
+
+#if PBL_API_EXISTS(unobstructed_area_service_subscribe)
+  unobstructed_area_service_subscribe((UnobstructedAreaHandlers) {
+    .will_change = will_change,
+    .change = change,
+    .did_change = did_change,
+  }, NULL);
+#endif
+}
+
+void peek_deinit(void) {
+#if PBL_API_EXISTS(unobstructed_area_service_subscribe)
+  unobstructed_area_service_unsubscribe();
+#endif
+  s_layer = NULL;
+}
+
+void peek_relayout(void) {
+  s_layout(layer_get_bounds(s_layer), s_obstructed);
+}
+
+int32_t peek_get_amount(void) {
+  return s_amount;
+}
+
+bool peek_is_animating(void) {
+  return s_animating;
+}
+
+int16_t peek_lerp(int16_t full, int16_t obstructed) {
+  return full + (obstructed - full) * s_amount / ANIMATION_NORMALIZED_MAX;
+}
+
+GPoint peek_lerp_point(GPoint full, GPoint obstructed) {
+  return GPoint(peek_lerp(full.x, obstructed.x), peek_lerp(full.y, obstructed.y));
+}
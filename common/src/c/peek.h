@@ -0,0 +1,42 @@
+#pragma once
+
+#include <pebble.h>
+
+// Timeline Quick View. While a peek covers the bottom of the screen the faces
+// move their dial up into the area it leaves. A face lays itself out once for
+// each extreme, the layer's bounds and the part of them a full peek leaves,
+// and during the animation only interpolates between the two with
+// peek_lerp(), rather than solving its layout again for every frame.
+//
+// The faces' layers fill the screen, so the unobstructed area the service
+// reports in screen coordinates is taken as is. Platforms without the
+// service (aplite) are never covered: peek_get_amount() stays 0 and both
+// extremes are the layer's bounds.
+
+// Given the layer's bounds and the part of them a full peek leaves; equal
+// until the first peek
+typedef void (*PeekLayoutHandler)(GRect bounds, GRect obstructed);
+
+// Called for every step of the animation and once at its end
+typedef void (*PeekFrameHandler)(void);
+
+// Call once layer exists, before the first frame; layout is called from here
+// for the extremes as they stand
+void peek_init(Layer *layer, PeekLayoutHandler layout, PeekFrameHandler frame);
+
+void peek_deinit(void);
+
+// Calls layout again for the extremes as they stand, when something the
+// face's layout depends on has changed since
+void peek_relayout(void);
+
+// How far in the peek is, from 0 with the screen clear to
+// ANIMATION_NORMALIZED_MAX at its fullest
+int32_t peek_get_amount(void);
+
+bool peek_is_animating(void);
+
+// full with the screen clear, obstructed at the full peek, and in between
+// while it moves
+int16_t peek_lerp(int16_t full, int16_t obstructed);
+GPoint peek_lerp_point(GPoint full, GPoint obstructed);
@@ -0,0 +1,191 @@
+#include "power.h"
+
+#include <stdlib.h>
+
+#ifdef INSTRUMENTATION
+static const char *const s_mode_names[PowerModeCount] = {
+  "active",
+  "idle",
+};
+#endif
+
+static uint8_t s_policy = PowerPolicyOff;
+static uint8_t s_interval = POWER_DEFAULT_INTERVAL;
+
+static PowerWakeHandler s_wake_handler;
+static PowerMode s_mode;
+static bool s_tap_subscribed;
+static bool s_accel_subscribed;
+static AccelData s_last_accel;
+static bool s_has_accel;
+static uint16_t s_still_minutes;
+static uint16_t s_wake_minutes;
+static PowerReport s_report = { .version = POWER_REPORT_VERSION };
+static bool s_report_pending;
+
+void power_add_settings(Settings *settings) {
+  s_policy = PowerPolicyOff;
+  s_interval = POWER_DEFAULT_INTERVAL;
+  settings_add_uint8(settings, MESSAGE_KEY_POWER_POLICY, &s_policy);
+  settings_add_uint8(settings, MESSAGE_KEY_POWER_INTERVAL, &s_interval);
+}
+
+// Sends the minutes so far; if the outbox is busy, the next tick tries again
+static void send_report(void) {
+  DictionaryIterator *iterator;
+  if (app_message_outbox_begin(&iterator) != APP_MSG_OK) {
+    return;
+  }
+  dict_write_data(iterator, MESSAGE_KEY_POWER_REPORT, (const uint8_t *)&s_report, sizeof(s_report));
+  if (app_message_outbox_send() == APP_MSG_OK) {
+    s_report_pending = false;
+  }
+}
+
+static void set_mode(PowerMode mode) {
+  if (mode == s_mode) {
+    return;
+  }
+  s_mode = mode;
+#ifdef INSTRUMENTATION
+  APP_LOG(APP_LOG_LEVEL_INFO, "power: %s; %lu minutes active, %lu idle, %lu redraws skipped",
+          s_mode_names[mode], (unsigned long)s_report.minutes[PowerModeActive],
+          (unsigned long)s_report.minutes[PowerModeIdle], (unsigned long)s_report.skipped);
+#endif
+  if (mode == PowerModeActive) {
+    s_report_pending = true;
+    send_report();
+  }
+}
+
+static void tap_handler(AccelAxisType axis, int32_t direction) {
+  s_still_minutes = 0;
+  s_wake_minutes = POWER_WAKE_MINUTES;
+  if (s_mode == PowerModeIdle) {
+    set_mode(PowerModeActive);
+    if (s_wake_handler) {
+      s_wake_handler();
+    }
+  }
+}
+
+void power_init(PowerWakeHandler wake_handler) {
+  // Statics can outlive a run of the app (the host harness)
+  s_wake_handler = wake_handler;
+  s_tap_subscribed = false;
+  s_accel_subscribed = false;
+  s_mode = PowerModeActive;
+  s_wake_minutes = 0;
+  s_report = (PowerReport) { .version = POWER_REPORT_VERSION };
+  s_report_pending = false;
+  power_settings_changed();
+}
+
+void power_settings_changed(void) {
+  if (s_policy >= PowerPolicyCount) {
+    s_policy = PowerPolicyOff;
+  }
+  if (s_interval < 1 || s_interval > POWER_MAX_INTERVAL) {
+    s_interval = POWER_DEFAULT_INTERVAL;
+  }
+
+  bool enabled = s_policy != PowerPolicyOff;
+  if (enabled && !s_tap_subscribed) {
+    accel_tap_service_subscribe(tap_handler);
+  } else if (!enabled && s_tap_subscribed) {
+    accel_tap_service_unsubscribe();
+  }
+  s_tap_subscribed = enabled;
+
+  // accel_service_peek() only has a reading while accel data is subscribed
+  // to; no samples are delivered, and the slowest rate is enough
+  bool still = s_policy == PowerPolicySleepOrStill;
+  if (still && !s_accel_subscribed) {
+    accel_data_service_subscribe(0, NULL);
+    accel_service_set_sampling_rate(ACCEL_SAMPLING_10HZ);
+  } else if (!still && s_accel_subscribed) {
+    accel_data_service_unsubscribe();
+  }
+  s_accel_subscribed = still;
+  s_has_accel = false;
+  s_still_minutes = 0;
+  // The face redraws for the new settings anyway
+  set_mode(PowerModeActive);
+}
+
+void power_deinit(void) {
+  if (s_tap_subscribed) {
+    accel_tap_service_unsubscribe();
+    s_tap_subscribed = false;
+  }
+  if (s_accel_subscribed) {
+    accel_data_service_unsubscribe();
+    s_accel_subscribed = false;
+  }
+  s_wake_handler = NULL;
+}
+
+static bool is_asleep(void) {
+#if defined(PBL_HEALTH)
+  return health_service_peek_current_activities() & (HealthActivitySleep | HealthActivityRestfulSleep);
+#else
+  return false;
+#endif
+}
+
+// Counts the minutes the accelerometer reading stayed put
+static void update_stillness(void) {
+  AccelData accel;
+  if (accel_service_peek(&accel) != 0) {
+    s_has_accel = false;
+    s_still_minutes = 0;
+    return;
+  }
+  if (s_has_accel) {
+    int32_t moved = abs(accel.x - s_last_accel.x) + abs(accel.y - s_last_accel.y) + abs(accel.z - s_last_accel.z);
+    if (moved < POWER_STILL_THRESHOLD) {
+      if (s_still_minutes < UINT16_MAX) {
+        s_still_minutes++;
+      }
+    } else {
+      s_still_minutes = 0;
+    }
+  }
+  s_last_accel = accel;
+  s_has_accel = true;
+}
+
+bool power_tick(struct tm *tick_time, TimeUnits units_changed) {
+  s_report.minutes[s_mode]++;
+  if (s_report_pending) {
+    send_report();
+  }
+  if (s_policy == PowerPolicyOff) {
+    return true;
+  }
+
+  bool idle = is_asleep();
+  if (s_policy == PowerPolicySleepOrStill) {
+    update_stillness();
+    idle = idle || s_still_minutes >= POWER_STILL_MINUTES;
+  }
+  if (s_wake_minutes) {
+    s_wake_minutes--;
+    idle = false;
+  }
+  set_mode(idle ? PowerModeIdle : PowerModeActive);
+  if (!idle) {
+    return true;
+  }
+
+  // Keep to minutes a multiple of the interval, so the time shown is a round one
+  if ((tick_time->tm_hour * 60 + tick_time->tm_min) % s_interval == 0) {
+    return true;
+  }
+  s_report.skipped++;
+  return false;
+}
+
+PowerMode power_get_mode(void) {
+  return s_mode;
+}
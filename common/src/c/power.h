@@ -0,0 +1,72 @@
+#pragma once
+
+#include <pebble.h>
+
+#include "settings.h"
+
+// Opt-in power policy shared by the faces. While the wearer sleeps, or the
+// watch has not moved for POWER_STILL_MINUTES, the face is idle and redraws
+// only on minutes that are a multiple of the configured interval. A tap
+// resumes per-minute redraws at once and holds them for POWER_WAKE_MINUTES;
+// a reading that moved ends stillness at the next tick.
+//
+// Sleep comes from the health service, where there is one (PBL_HEALTH), and
+// stillness from one accelerometer peek per minute; peeking needs accel data
+// subscribed to, which the still policy does at the slowest rate. The minutes
+// spent in each mode are sent to the phone as a PowerReport under
+// MESSAGE_KEY_POWER_REPORT each time the face leaves idle, and logged in
+// INSTRUMENTATION builds.
+
+typedef enum {
+  // Redraw every minute
+  PowerPolicyOff,
+  PowerPolicySleep,
+  PowerPolicySleepOrStill,
+  PowerPolicyCount,
+} PowerPolicy;
+
+typedef enum {
+  PowerModeActive,
+  PowerModeIdle,
+  PowerModeCount,
+} PowerMode;
+
+#define POWER_DEFAULT_INTERVAL 10
+#define POWER_MAX_INTERVAL 60
+#define POWER_STILL_MINUTES 15
+#define POWER_WAKE_MINUTES 5
+// Summed change of the three axes between two peeks, in milli-g, below
+// which the watch counts as still
+#define POWER_STILL_THRESHOLD 96
+
+#define POWER_REPORT_VERSION 1
+
+// Sent as a byte array, little endian
+typedef struct __attribute__((__packed__)) {
+  uint8_t version;
+  uint32_t minutes[PowerModeCount];
+  // Redraws skipped while idle
+  uint32_t skipped;
+} PowerReport;
+
+// Called to bring the face up to date right away, on a tap while idle
+typedef void (*PowerWakeHandler)(void);
+
+// Adds the policy and the interval to the face's settings, under
+// MESSAGE_KEY_POWER_POLICY and MESSAGE_KEY_POWER_INTERVAL. Call before
+// settings_load().
+void power_add_settings(Settings *settings);
+
+// Call once the settings are loaded
+void power_init(PowerWakeHandler wake_handler);
+
+// Call when settings_apply() reports a change
+void power_settings_changed(void);
+
+void power_deinit(void);
+
+// Call first in the minute tick handler. Returns whether the face should
+// redraw for this tick.
+bool power_tick(struct tm *tick_time, TimeUnits units_changed);
+
+PowerMode power_get_mode(void);
@@ -0,0 +1,156 @@
+#include "profile.h"
+
+#ifdef PROFILING
+
+#include "render_tier.h"
+
+typedef struct {
+  uint8_t tier;
+  uint8_t settings[SETTINGS_MAX_FIELDS];
+  uint16_t frames;
+  // Where the next duration goes
+  uint8_t head;
+  uint16_t ring[PROFILE_RING_SIZE];
+  // s_clock when the slot last got a frame; 0 for a free slot
+  uint32_t used;
+} ProfileSlot;
+
+static const Settings *s_settings;
+static ProfileSlot s_slots[PROFILE_SLOTS];
+static uint32_t s_clock;
+static time_t s_begin;
+static uint16_t s_begin_ms;
+
+static void send_stats(void *context);
+
+void profile_init(const Settings *settings) {
+  // Statics can outlive a run of the app (the host harness)
+  s_settings = settings;
+  memset(s_slots, 0, sizeof(s_slots));
+  s_clock = 0;
+  // Tell the phone there is something to ask for
+  app_timer_register(PROFILE_ANNOUNCE_MS, send_stats, (void *)0);
+}
+
+void profile_frame_begin(void) {
+  s_begin_ms = time_ms(&s_begin, NULL);
+}
+
+// The slot for the current tier and settings, taking over the least
+// recently used one if there is none yet
+static ProfileSlot *current_slot(void) {
+  uint8_t tier = render_tier_get();
+  ProfileSlot *oldest = &s_slots[0];
+  for (int i = 0; i < PROFILE_SLOTS; i++) {
+    ProfileSlot *slot = &s_slots[i];
+    if (slot->used && slot->tier == tier &&
+        memcmp(slot->settings, s_settings->stored, s_settings->num_fields) == 0) {
+      return slot;
+    }
+    if (slot->used < oldest->used) {
+      oldest = slot;
+    }
+  }
+  memset(oldest, 0, sizeof(*oldest));
+  oldest->tier = tier;
+  memcpy(oldest->settings, s_settings->stored, s_settings->num_fields);
+  return oldest;
+}
+
+void profile_frame_end(void) {
+  if (!s_settings) {
+    return;
+  }
+  time_t end;
+  uint16_t end_ms = time_ms(&end, NULL);
+  int32_t duration = (int32_t)(end - s_begin) * 1000 + end_ms - s_begin_ms;
+  if (duration < 0) {
+    // The clock was set back
+    duration = 0;
+  }
+
+  ProfileSlot *slot = current_slot();
+  slot->ring[slot->head] = duration > UINT16_MAX ? UINT16_MAX : duration;
+  slot->head = (slot->head + 1) % PROFILE_RING_SIZE;
+  if (slot->frames < UINT16_MAX) {
+    slot->frames++;
+  }
+  slot->used = ++s_clock;
+}
+
+// Fills in the figures over the durations still in the slot's ring
+static void fill_stats(ProfileSlotStats *stats, const ProfileSlot *slot) {
+  stats->tier = slot->tier;
+  stats->num_settings = s_settings->num_fields;
+  memcpy(stats->settings, slot->settings, sizeof(stats->settings));
+  stats->frames = slot->frames;
+
+  int count = slot->frames < PROFILE_RING_SIZE ? slot->frames : PROFILE_RING_SIZE;
+  if (!count) {
+    return;
+  }
+  // Sorted by insertion; the ring is short
+  uint16_t sorted[PROFILE_RING_SIZE];
+  uint32_t sum = 0;
+  for (int i = 0; i < count; i++) {
+    uint16_t value = slot->ring[i];
+    int j = i;
+    for (; j > 0 && sorted[j - 1] > value; j--) {
+      sorted[j] = sorted[j - 1];
+    }
+    sorted[j] = value;
+    sum += value;
+  }
+  stats->min = sorted[0];
+  stats->mean = sum / count;
+  // Nearest rank
+  stats->p95 = sorted[(count * 95 + 99) / 100 - 1];
+  stats->max = sorted[count - 1];
+}
+
+// Sends the figures for the slot at index context
+static void send_stats(void *context) {
+  if (!s_settings) {
+    return;
+  }
+
+  // The slots in use, in a fixed order the phone walks by index
+  const ProfileSlot *order[PROFILE_SLOTS];
+  uint8_t count = 0;
+  for (int i = 0; i < PROFILE_SLOTS; i++) {
+    if (s_slots[i].used) {
+      order[count++] = &s_slots[i];
+    }
+  }
+
+  ProfileSlotStats stats = {
+    .version = PROFILE_STATS_VERSION,
+    .index = (uintptr_t)context,
+    .count = count,
+  };
+  if (stats.index < count) {
+    fill_stats(&stats, order[stats.index]);
+  }
+
+  DictionaryIterator *out;
+  AppMessageResult result = app_message_outbox_begin(&out);
+  if (result == APP_MSG_BUSY) {
+    // Another message is still on its way
+    app_timer_register(PROFILE_RETRY_MS, send_stats, context);
+    return;
+  }
+  if (result != APP_MSG_OK) {
+    return;
+  }
+  dict_write_data(out, MESSAGE_KEY_PROFILE_STATS, (const uint8_t *)&stats, sizeof(stats));
+  app_message_outbox_send();
+}
+
+void profile_receive(DictionaryIterator *iterator) {
+  Tuple *tuple = dict_find(iterator, MESSAGE_KEY_PROFILE_REQUEST);
+  if (tuple) {
+    send_stats((void *)(uintptr_t)(uint8_t)tuple->value->int32);
+  }
+}
+
+#endif
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <pebble.h>
+
+#include "settings.h"
+
+// Frame times on the watch. Only built when PROFILING is defined, which the
+// wscripts do when PROFILING is set in the environment of `pebble build`;
+// otherwise every call below compiles to nothing.
+//
+// The canvas update proc is timed with time_ms(), and each duration goes
+// into the ring of the slot for the render tier and settings it was drawn
+// with. There are PROFILE_SLOTS of them, the least recently drawn one
+// making room for a new combination, and each keeps the last
+// PROFILE_RING_SIZE frames.
+//
+// The phone asks for a slot by sending its index under
+// MESSAGE_KEY_PROFILE_REQUEST, and the watch answers with a ProfileSlotStats
+// under MESSAGE_KEY_PROFILE_STATS; one at a time, so the answer fits the
+// smallest outbox the faces open. The phone only asks a build that has
+// sent it the first slot on its own, PROFILE_ANNOUNCE_MS after it started,
+// so builds without PROFILING never get a request. An answer that finds the
+// outbox busy goes out PROFILE_RETRY_MS later, and the phone asks again
+// for one that never arrives (common/src/pkjs/profile.js).
+
+#define PROFILE_SLOTS 4
+#define PROFILE_RING_SIZE 32
+#define PROFILE_ANNOUNCE_MS 10000
+#define PROFILE_RETRY_MS 500
+
+#define PROFILE_STATS_VERSION 1
+
+// Sent as a byte array, little endian; durations in milliseconds, over the
+// frames still in the ring
+typedef struct __attribute__((__packed__)) {
+  uint8_t version;
+  uint8_t index;
+  // Slots in use; an index past them answers with no frames
+  uint8_t count;
+  uint8_t tier;
+  // The face's settings as they are stored (common/src/c/settings.h)
+  uint8_t num_settings;
+  uint8_t settings[SETTINGS_MAX_FIELDS];
+  // Frames drawn with these, including those the ring no longer holds
+  uint16_t frames;
+  uint16_t min;
+  uint16_t mean;
+  uint16_t p95;
+  uint16_t max;
+} ProfileSlotStats;
+
+#ifdef PROFILING
+
+// Call once the settings are loaded
+void profile_init(const Settings *settings);
+
+// Call first and last thing in the update proc
+void profile_frame_begin(void);
+void profile_frame_end(void);
+
+// Answers a request in an inbox message, if it carries one
+void profile_receive(DictionaryIterator *iterator);
+
+#else
+
+#define profile_init(settings)
+#define profile_frame_begin()
+#define profile_frame_end()
+#define profile_receive(iterator)
+
+#endif
@@ -0,0 +1,26 @@
+#include "ray_box.h"
+
+// Components below this are too close to the axis to hit its edges
+#define RAY_BOX_MIN_COMPONENT (TRIG_MAX_RATIO / 100)
+
+GPoint ray_box_exit(int32_t angle, RayBox box) {
+  int32_t dx = sin_lookup(angle);
+  int32_t dy = -cos_lookup(angle);
+  int32_t abs_dx = dx < 0 ? -dx : dx;
+  int32_t abs_dy = dy < 0 ? -dy : dy;
+  int32_t extent_x = dx < 0 ? box.left : box.right;
+  int32_t extent_y = dy < 0 ? box.top : box.bottom;
+  bool hits_x = abs_dx > RAY_BOX_MIN_COMPONENT;
+  bool hits_y = abs_dy > RAY_BOX_MIN_COMPONENT;
+
+  // The side edge comes first when extent_x / abs_dx < extent_y / abs_dy;
+  // a tie goes to the top or bottom edge
+  if (hits_x && (!hits_y || extent_x * abs_dy < extent_y * abs_dx)) {
+    return GPoint(dx < 0 ? -extent_x : extent_x, dy * extent_x / abs_dx);
+  }
+  return GPoint(dx * extent_y / abs_dy, dy < 0 ? -extent_y : extent_y);
+}
+
+GPoint ray_point(int32_t angle, int16_t radius) {
+  return GPoint(sin_lookup(angle) * radius / TRIG_MAX_RATIO, -cos_lookup(angle) * radius / TRIG_MAX_RATIO);
+}
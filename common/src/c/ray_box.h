@@ -0,0 +1,23 @@
+#pragma once
+
+#include <pebble.h>
+
+// Placement of dial elements along a ray from the center, in integer maths
+// only. Angles are Pebble angles: 0 at 12 o'clock, increasing clockwise.
+// Results are offsets from the ray's origin, with y pointing down.
+
+// How far the box around the origin extends in each direction
+typedef struct {
+  int16_t left;
+  int16_t top;
+  int16_t right;
+  int16_t bottom;
+} RayBox;
+
+// Where the ray leaves the box. The coordinate of the edge it leaves through
+// is exact and the other is truncated toward zero. Directions within 1% of
+// an axis are treated as parallel to it.
+GPoint ray_box_exit(int32_t angle, RayBox box);
+
+// The point at distance radius along the ray, truncated toward zero
+GPoint ray_point(int32_t angle, int16_t radius);
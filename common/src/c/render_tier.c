@@ -0,0 +1,72 @@
+#include "render_tier.h"
+
+#ifdef INSTRUMENTATION
+static const char *const s_tier_names[RenderTierCount] = {
+  "full",
+  "saver",
+};
+#endif
+
+static uint8_t s_threshold = RENDER_TIER_DEFAULT_THRESHOLD;
+
+static const uint32_t *s_table;
+static RenderTierHandler s_handler;
+static RenderTier s_tier;
+
+void render_tier_add_settings(Settings *settings) {
+  s_threshold = RENDER_TIER_DEFAULT_THRESHOLD;
+  settings_add_uint8(settings, MESSAGE_KEY_BATTERY_SAVER, &s_threshold);
+}
+
+static RenderTier tier_for(BatteryChargeState state) {
+  // A threshold of 0 turns the saver off, even at 0%
+  if (s_threshold == 0 || state.is_plugged || state.charge_percent > s_threshold) {
+    return RenderTierFull;
+  }
+  return RenderTierSaver;
+}
+
+// Moves to the tier for state, telling the face when that's a change
+static void update_tier(BatteryChargeState state) {
+  RenderTier tier = tier_for(state);
+  if (tier == s_tier) {
+    return;
+  }
+  s_tier = tier;
+#ifdef INSTRUMENTATION
+  APP_LOG(APP_LOG_LEVEL_INFO, "render tier: %s at %u%%", s_tier_names[tier], state.charge_percent);
+#endif
+  if (s_handler) {
+    s_handler(tier);
+  }
+}
+
+static void battery_handler(BatteryChargeState state) {
+  update_tier(state);
+}
+
+void render_tier_init(const uint32_t table[RenderTierCount], RenderTierHandler handler) {
+  s_table = table;
+  s_handler = handler;
+  // The face draws its first frame at this tier anyway
+  s_tier = tier_for(battery_state_service_peek());
+  battery_state_service_subscribe(battery_handler);
+}
+
+void render_tier_settings_changed(void) {
+  // The face redraws for the new settings anyway
+  s_tier = tier_for(battery_state_service_peek());
+}
+
+void render_tier_deinit(void) {
+  battery_state_service_unsubscribe();
+  s_handler = NULL;
+}
+
+RenderTier render_tier_get(void) {
+  return s_tier;
+}
+
+bool render_tier_draws(uint32_t elements) {
+  return !s_table || (s_table[s_tier] & elements) == elements;
+}
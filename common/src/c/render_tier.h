@@ -0,0 +1,43 @@
+#pragma once
+
+#include <pebble.h>
+
+#include "settings.h"
+
+// Battery-aware render tiers. A face names its optional elements as bits and
+// declares in a tier table which of them each tier draws. While the battery
+// is at or below the configured charge and not plugged in, the face renders
+// at RenderTierSaver and leaves out what the table drops there.
+//
+// The charge comes from the battery state service. The face is told when
+// the tier changes so it can redraw in full; anything it caches per frame
+// should be keyed on the tier as well.
+
+typedef enum {
+  RenderTierFull,
+  RenderTierSaver,
+  RenderTierCount,
+} RenderTier;
+
+// Percent of charge at or below which the saver tier is used; 0 never
+#define RENDER_TIER_DEFAULT_THRESHOLD 20
+
+typedef void (*RenderTierHandler)(RenderTier tier);
+
+// Adds the threshold to the face's settings, under MESSAGE_KEY_BATTERY_SAVER.
+// Call before settings_load().
+void render_tier_add_settings(Settings *settings);
+
+// table holds, per tier, the elements drawn at it; it must outlive the face.
+// Call once the settings are loaded, before the first frame.
+void render_tier_init(const uint32_t table[RenderTierCount], RenderTierHandler handler);
+
+// Call when settings_apply() reports a change
+void render_tier_settings_changed(void);
+
+void render_tier_deinit(void);
+
+RenderTier render_tier_get(void);
+
+// Whether the current tier draws all of elements
+bool render_tier_draws(uint32_t elements);
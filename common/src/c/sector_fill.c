@@ -0,0 +1,138 @@
+#include "sector_fill.h"
+
+#include "span_fill.h"
+
+// Runs of a row, as offsets from the center column. Wider than a row: the
+// end ray can cross it far off screen when it is close to horizontal.
+typedef struct {
+  int32_t from;
+  int32_t to;
+} Run;
+
+static int32_t isqrt(int32_t value) {
+  if (value <= 0) {
+    return 0;
+  }
+  int32_t root = 0;
+  int32_t bit = 1 << 30;
+  while (bit > value) {
+    bit >>= 2;
+  }
+  while (bit) {
+    if (value >= root + bit) {
+      value -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return root;
+}
+
+static int32_t div_floor(int32_t a, int32_t b) {
+  int32_t q = a / b;
+  return (a % b != 0 && ((a < 0) != (b < 0))) ? q - 1 : q;
+}
+
+// The columns of row dy inside the sector, as up to two runs. A column dx
+// is clockwise of the 12 o'clock ray when dx >= 0, and not past the end
+// ray e = (sin, -cos) when dx * e.y - dy * e.x >= 0.
+static uint8_t sector_runs(int32_t angle, int32_t end_x, int32_t end_y, int16_t dy, Run *runs) {
+  if (angle <= 0) {
+    return 0;
+  }
+  if (angle >= TRIG_MAX_ANGLE) {
+    runs[0] = (Run) { INT16_MIN, INT16_MAX };
+    return 1;
+  }
+
+  // Columns not past the end ray: a half-line, or all or none of the row
+  // when the ray is horizontal
+  Run end;
+  int32_t cross = dy * end_x;
+  if (end_y > 0) {
+    end = (Run) { -div_floor(-cross, end_y), INT16_MAX };
+  } else if (end_y < 0) {
+    end = (Run) { INT16_MIN, div_floor(cross, end_y) };
+  } else if (cross <= 0) {
+    end = (Run) { INT16_MIN, INT16_MAX };
+  } else {
+    end = (Run) { 1, 0 };
+  }
+  if (end.from > end.to) {
+    // Past the end ray everywhere
+    if (angle <= TRIG_MAX_ANGLE / 2) {
+      return 0;
+    }
+    runs[0] = (Run) { 0, INT16_MAX };
+    return 1;
+  }
+
+  if (angle <= TRIG_MAX_ANGLE / 2) {
+    // Both conditions hold
+    runs[0] = (Run) { end.from > 0 ? end.from : 0, end.to };
+    return runs[0].from <= runs[0].to ? 1 : 0;
+  }
+  // Reflex sectors take either
+  if (end.to == INT16_MAX) {
+    runs[0] = (Run) { end.from < 0 ? end.from : 0, INT16_MAX };
+    return 1;
+  }
+  if (end.to >= -1) {
+    runs[0] = (Run) { INT16_MIN, INT16_MAX };
+    return 1;
+  }
+  runs[0] = end;
+  runs[1] = (Run) { 0, INT16_MAX };
+  return 2;
+}
+
+bool sector_fill(GContext *ctx, GPoint center, int16_t radius, int32_t angle, GColor sector, GColor disk,
+                 GColor background) {
+  GBitmap *fb = graphics_capture_frame_buffer(ctx);
+  if (!fb) {
+    return false;
+  }
+  GRect bounds = gbitmap_get_bounds(fb);
+  bool bw = gbitmap_get_format(fb) == GBitmapFormat1Bit;
+  int32_t end_x = sin_lookup(angle);
+  int32_t end_y = -cos_lookup(angle);
+  // graphics_fill_circle() takes the pixels with dx^2 + dy^2 <= r^2 + r
+  int32_t reach = (int32_t)radius * radius + radius;
+
+  for (int16_t y = 0; y < bounds.size.h; y++) {
+    GBitmapDataRowInfo info = gbitmap_get_data_row_info(fb, y);
+    int16_t dy = y - center.y;
+    int32_t span_sq = reach - (int32_t)dy * dy;
+    if (span_sq < 0) {
+      span_fill(&info, bw, y, info.min_x, info.max_x, background);
+      continue;
+    }
+    int16_t half = isqrt(span_sq);
+    int16_t left = center.x - half;
+    int16_t right = center.x + half;
+    span_fill(&info, bw, y, info.min_x, left - 1, background);
+
+    Run runs[2];
+    uint8_t num_runs = sector_runs(angle, end_x, end_y, dy, runs);
+    int16_t x = left;
+    for (uint8_t i = 0; i < num_runs; i++) {
+      int32_t from = center.x + runs[i].from;
+      int32_t to = center.x + runs[i].to;
+      if (from < left) from = left;
+      if (to > right) to = right;
+      if (from > to) {
+        continue;
+      }
+      span_fill(&info, bw, y, x, from - 1, disk);
+      span_fill(&info, bw, y, from, to, sector);
+      x = to + 1;
+    }
+    span_fill(&info, bw, y, x, right, disk);
+    span_fill(&info, bw, y, right + 1, info.max_x, background);
+  }
+
+  graphics_release_frame_buffer(ctx, fb);
+  return true;
+}
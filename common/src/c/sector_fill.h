@@ -0,0 +1,18 @@
+#pragma once
+
+#include <pebble.h>
+
+// Paints a disk with a filled sector, and the screen around it, straight
+// into the frame buffer in one pass. Each visible row is split into at most
+// five runs (background, disk, sector, disk, background) which are written
+// once, so nothing is painted twice and the parts of a disk larger than the
+// screen cost nothing. Round displays only get their visible row ranges.
+//
+// The sector runs clockwise from 12 o'clock to angle, as with
+// graphics_fill_radial(), and the disk covers the same pixels as
+// graphics_fill_circle() with the same radius.
+
+// center is in frame buffer coordinates. Returns false if the frame buffer
+// could not be captured, in which case nothing was drawn.
+bool sector_fill(GContext *ctx, GPoint center, int16_t radius, int32_t angle, GColor sector, GColor disk,
+                 GColor background);
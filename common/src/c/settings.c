@@ -0,0 +1,196 @@
+#include "settings.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Version, number of values, one byte per setting, then the version of the
+// message they came from. Blobs from before that have no message version.
+typedef struct __attribute__((__packed__)) {
+  uint8_t version;
+  uint8_t num_values;
+  uint8_t values[SETTINGS_MAX_FIELDS + sizeof(uint32_t)];
+} SettingsBlob;
+
+#define SETTINGS_BLOB_HEADER 2
+
+static uint32_t s_persist_key = SETTINGS_PERSIST_KEY;
+
+void settings_set_persist_key(uint32_t key) {
+  s_persist_key = key;
+}
+
+void settings_init(Settings *settings, uint8_t version) {
+  memset(settings, 0, sizeof(*settings));
+  settings->version = version;
+  settings->persist_key = s_persist_key;
+}
+
+static void add_field(Settings *settings, uint32_t key, SettingsType type, void *value) {
+  if (settings->num_fields == SETTINGS_MAX_FIELDS) {
+    APP_LOG(APP_LOG_LEVEL_ERROR, "Too many settings");
+    return;
+  }
+  settings->fields[settings->num_fields++] = (SettingsField) { .key = key, .type = type, .value = value };
+}
+
+void settings_add_bool(Settings *settings, uint32_t key, bool *value) {
+  add_field(settings, key, SettingsTypeBool, value);
+}
+
+void settings_add_color(Settings *settings, uint32_t key, GColor *value) {
+  add_field(settings, key, SettingsTypeColor, value);
+}
+
+void settings_add_uint8(Settings *settings, uint32_t key, uint8_t *value) {
+  add_field(settings, key, SettingsTypeUint8, value);
+}
+
+static uint8_t field_get(const SettingsField *field) {
+  switch (field->type) {
+    case SettingsTypeBool:
+      return *(bool *)field->value ? 1 : 0;
+    case SettingsTypeColor:
+      return ((GColor *)field->value)->argb;
+    case SettingsTypeUint8:
+      return *(uint8_t *)field->value;
+  }
+  return 0;
+}
+
+static void field_set(const SettingsField *field, uint8_t byte) {
+  switch (field->type) {
+    case SettingsTypeBool:
+      *(bool *)field->value = byte != 0;
+      break;
+    case SettingsTypeColor:
+      *(GColor *)field->value = (GColor) { .argb = byte };
+      break;
+    case SettingsTypeUint8:
+      *(uint8_t *)field->value = byte;
+      break;
+  }
+}
+
+static void pack(const Settings *settings, uint8_t *values) {
+  for (uint8_t i = 0; i < settings->num_fields; i++) {
+    values[i] = field_get(&settings->fields[i]);
+  }
+}
+
+static bool write_blob(Settings *settings) {
+  SettingsBlob blob = { .version = settings->version, .num_values = settings->num_fields };
+  pack(settings, blob.values);
+  memcpy(blob.values + settings->num_fields, &settings->message_version, sizeof(uint32_t));
+  if (persist_write_data(settings->persist_key, &blob,
+                         SETTINGS_BLOB_HEADER + settings->num_fields + sizeof(uint32_t)) < 0) {
+    APP_LOG(APP_LOG_LEVEL_ERROR, "Cannot save settings");
+    return false;
+  }
+  memcpy(settings->stored, blob.values, settings->num_fields);
+  return true;
+}
+
+void settings_load(Settings *settings) {
+  SettingsBlob blob;
+  int size = persist_exists(settings->persist_key) ? persist_read_data(settings->persist_key, &blob, sizeof(blob)) : -1;
+  if (size >= SETTINGS_BLOB_HEADER && blob.version == settings->version) {
+    uint8_t count = blob.num_values;
+    if (count > size - SETTINGS_BLOB_HEADER) count = size - SETTINGS_BLOB_HEADER;
+    if (count > settings->num_fields) count = settings->num_fields;
+    for (uint8_t i = 0; i < count; i++) {
+      field_set(&settings->fields[i], blob.values[i]);
+    }
+    if (size >= SETTINGS_BLOB_HEADER + blob.num_values + (int)sizeof(uint32_t)) {
+      memcpy(&settings->message_version, blob.values + blob.num_values, sizeof(uint32_t));
+    }
+    // Settings the blob doesn't have yet are stored as their defaults
+    pack(settings, settings->stored);
+    return;
+  }
+
+  // Move the values older builds kept one per key into the blob
+  bool migrated = false;
+  for (uint8_t i = 0; i < settings->num_fields; i++) {
+    const SettingsField *field = &settings->fields[i];
+    if (!persist_exists(field->key)) {
+      continue;
+    }
+    if (field->type == SettingsTypeBool) {
+      field_set(field, persist_read_bool(field->key));
+    } else {
+      field_set(field, (uint8_t)persist_read_int(field->key));
+    }
+    migrated = true;
+  }
+  pack(settings, settings->stored);
+  // The old keys go only once the blob holds their values
+  if (migrated && write_blob(settings)) {
+    for (uint8_t i = 0; i < settings->num_fields; i++) {
+      if (persist_exists(settings->fields[i].key)) {
+        persist_delete(settings->fields[i].key);
+      }
+    }
+  }
+}
+
+// Tells the configuration page which version the watch holds; if the outbox
+// is busy the page finds out on its next message
+static void acknowledge(const Settings *settings) {
+  DictionaryIterator *iterator;
+  if (app_message_outbox_begin(&iterator) != APP_MSG_OK) {
+    return;
+  }
+  dict_write_int32(iterator, MESSAGE_KEY_SETTINGS_VERSION, (int32_t)settings->message_version);
+  app_message_outbox_send();
+}
+
+bool settings_apply(Settings *settings, DictionaryIterator *iterator) {
+  Tuple *version = dict_find(iterator, MESSAGE_KEY_SETTINGS_VERSION);
+  if (version) {
+    Tuple *base = dict_find(iterator, MESSAGE_KEY_SETTINGS_BASE);
+    if ((uint32_t)version->value->int32 == settings->message_version ||
+        (base && (uint32_t)base->value->int32 != settings->message_version)) {
+      acknowledge(settings);
+      return false;
+    }
+  }
+
+  for (uint8_t i = 0; i < settings->num_fields; i++) {
+    const SettingsField *field = &settings->fields[i];
+    Tuple *tuple = dict_find(iterator, field->key);
+    if (!tuple) {
+      continue;
+    }
+    switch (field->type) {
+      case SettingsTypeBool:
+        *(bool *)field->value = tuple->value->int32 != 0;
+        break;
+      case SettingsTypeColor:
+        *(GColor *)field->value = GColorFromHEX(tuple->value->int32);
+        break;
+      case SettingsTypeUint8:
+        *(uint8_t *)field->value = tuple->type == TUPLE_CSTRING ? atoi(tuple->value->cstring) : tuple->value->int32;
+        break;
+    }
+  }
+
+  uint8_t values[SETTINGS_MAX_FIELDS];
+  pack(settings, values);
+  bool changed = memcmp(values, settings->stored, settings->num_fields) != 0;
+  if (version) {
+    // A new version is kept even when no value changed, so the next delta
+    // goes on top of it
+    settings->message_version = version->value->int32;
+  }
+  if (changed || version) {
+    write_blob(settings);
+  }
+  if (version) {
+    acknowledge(settings);
+  }
+  return changed;
+}
+
+uint32_t settings_inbox_size(const Settings *settings) {
+  return SETTINGS_INBOX_SIZE(settings->num_fields);
+}
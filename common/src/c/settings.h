@@ -0,0 +1,86 @@
+#pragma once
+
+#include <pebble.h>
+
+// Persistent settings kept as one blob under SETTINGS_PERSIST_KEY instead of
+// one persist key per setting.
+//
+// A face adds its settings once at startup, each as the message key the
+// configuration page sends it under and the static that holds it, already
+// set to its default. The blob stores one byte per setting in the order they
+// were added, behind a version byte. New settings go at the end: a blob from
+// before they existed still loads and they keep their defaults. Bump the
+// version when existing settings change meaning, which drops older blobs.
+//
+// Values older builds kept under their message keys are moved into the blob
+// on the first load. An inbox message is applied as a whole, and the blob is
+// only written when a value actually changed.
+//
+// The configuration pages send only the keys that changed since the watch
+// last acknowledged a message, with SETTINGS_VERSION, a number the page
+// picks anew for each, and SETTINGS_BASE, the version those changes go on
+// top of. The watch keeps the version of the last message it applied in the
+// blob and answers every versioned message with the version it then holds.
+// A message with the version it already has was applied before and is
+// skipped whole; one on top of any other version than it has is refused, so
+// the page sends every key again. Messages without a version are applied as
+// they come.
+//
+// The collection app (collection/) keeps each face's blob under a key of its
+// own, set with settings_set_persist_key() before the face starts.
+
+#define SETTINGS_PERSIST_KEY 1
+#define SETTINGS_MAX_FIELDS 12
+
+// The largest settings message num_fields settings come in: every one of
+// them, as an integer or a Clay select's short string, with the version and
+// base. Faces open their inbox with this rather than a guess.
+#define SETTINGS_INBOX_SIZE(num_fields) (1 + ((num_fields) + 2) * (sizeof(Tuple) + sizeof(int32_t)))
+
+typedef enum {
+  SettingsTypeBool,
+  SettingsTypeColor,
+  SettingsTypeUint8,
+} SettingsType;
+
+typedef struct {
+  uint32_t key;
+  SettingsType type;
+  // bool *, GColor * or uint8_t *
+  void *value;
+} SettingsField;
+
+typedef struct {
+  uint8_t version;
+  uint8_t num_fields;
+  // Where the blob is kept
+  uint32_t persist_key;
+  SettingsField fields[SETTINGS_MAX_FIELDS];
+  // The values as they are in persistent storage
+  uint8_t stored[SETTINGS_MAX_FIELDS];
+  // SETTINGS_VERSION of the message they came from, 0 before any
+  uint32_t message_version;
+} Settings;
+
+void settings_init(Settings *settings, uint8_t version);
+
+// The key settings_init() gives the blob from now on; SETTINGS_PERSIST_KEY
+// until changed
+void settings_set_persist_key(uint32_t key);
+
+// Settings are read from and written to *value, which holds the default
+void settings_add_bool(Settings *settings, uint32_t key, bool *value);
+void settings_add_color(Settings *settings, uint32_t key, GColor *value);
+// Sent as a number, or as the string a Clay select gives
+void settings_add_uint8(Settings *settings, uint32_t key, uint8_t *value);
+
+// Reads the blob, or migrates the per-key values older builds stored
+void settings_load(Settings *settings);
+
+// Takes every setting the message carries and writes the blob once if any
+// of them, or the message's version, changed, then acknowledges a versioned
+// message. Returns whether a setting changed, so the face redraws.
+bool settings_apply(Settings *settings, DictionaryIterator *iterator);
+
+// SETTINGS_INBOX_SIZE() for the settings added so far
+uint32_t settings_inbox_size(const Settings *settings);
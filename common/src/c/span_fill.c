@@ -0,0 +1,87 @@
+#include "span_fill.h"
+
+static bool is_gray(GColor color) {
+  return color.r == color.g && color.g == color.b && (color.r == 1 || color.r == 2);
+}
+
+// The bits of a 1-bit word filled with color on row y
+static uint32_t bw_word(GColor color, int16_t y) {
+  if (is_gray(color)) {
+    return (y & 1) ? 0x55555555u : 0xaaaaaaaau;
+  }
+  return color.r + color.g + color.b >= 5 ? 0xffffffffu : 0;
+}
+
+static void fill_8bit(uint8_t *row, int16_t x0, int16_t x1, uint8_t value) {
+  uint8_t *p = row + x0;
+  uint8_t *end = row + x1 + 1;
+  // Bytes up to the first word boundary, then four pixels per store
+  while (p < end && ((uintptr_t)p & 3)) {
+    *p++ = value;
+  }
+  uint32_t word = value * 0x01010101u;
+  uint32_t *w = (uint32_t *)p;
+  uint32_t *words_end = (uint32_t *)((uintptr_t)end & ~(uintptr_t)3);
+  while (w + 2 <= words_end) {
+    w[0] = word;
+    w[1] = word;
+    w += 2;
+  }
+  if (w < words_end) {
+    *w++ = word;
+  }
+  p = (uint8_t *)w;
+  while (p < end) {
+    *p++ = value;
+  }
+}
+
+static void fill_1bit(uint8_t *row, int16_t x0, int16_t x1, uint32_t fill) {
+  if ((uintptr_t)row & 3) {
+    // Not word aligned: the same masks a byte at a time
+    uint8_t *first = row + x0 / 8;
+    uint8_t *last = row + x1 / 8;
+    uint8_t first_mask = (uint8_t)(0xff << (x0 % 8));
+    uint8_t last_mask = (uint8_t)(0xff >> (7 - x1 % 8));
+    if (first == last) {
+      first_mask &= last_mask;
+    }
+    *first = (*first & ~first_mask) | ((uint8_t)fill & first_mask);
+    if (first != last) {
+      for (uint8_t *p = first + 1; p < last; p++) {
+        *p = (uint8_t)fill;
+      }
+      *last = (*last & ~last_mask) | ((uint8_t)fill & last_mask);
+    }
+    return;
+  }
+  // Pixel x is bit x % 8 of byte x / 8, which on a little endian word is
+  // bit x % 32 of word x / 32
+  uint32_t *first = (uint32_t *)row + x0 / 32;
+  uint32_t *last = (uint32_t *)row + x1 / 32;
+  uint32_t first_mask = 0xffffffffu << (x0 % 32);
+  uint32_t last_mask = 0xffffffffu >> (31 - x1 % 32);
+  if (first == last) {
+    first_mask &= last_mask;
+    *first = (*first & ~first_mask) | (fill & first_mask);
+    return;
+  }
+  *first = (*first & ~first_mask) | (fill & first_mask);
+  for (uint32_t *w = first + 1; w < last; w++) {
+    *w = fill;
+  }
+  *last = (*last & ~last_mask) | (fill & last_mask);
+}
+
+void span_fill(const GBitmapDataRowInfo *info, bool bw, int16_t y, int16_t x0, int16_t x1, GColor color) {
+  if (x0 < info->min_x) x0 = info->min_x;
+  if (x1 > info->max_x) x1 = info->max_x;
+  if (x0 > x1) {
+    return;
+  }
+  if (bw) {
+    fill_1bit(info->data, x0, x1, bw_word(color, y));
+  } else {
+    fill_8bit(info->data, x0, x1, color.argb);
+  }
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <pebble.h>
+
+// The run writer under the frame buffer rasterizers (sector_fill.c,
+// band_fill.c, thick_line.c): one color over pixels x0..x1 of a captured
+// frame buffer row, clipped to the row's min_x..max_x so nothing lands
+// outside a round display.
+//
+// Whole 32-bit words are stored at a time. On 8-bit rows that is four
+// pixels of the color repeated, after the bytes up to the first aligned
+// one; on 1-bit rows, where pixel x is bit x % 32 of word x / 32, the first
+// and last words are masked and the ones between set whole. 1-bit rows
+// threshold the color as the SDK does, white and the light colors setting
+// the bit, and dither the two grays to the pixels where x + y is odd.
+
+// info is the row y of a frame buffer, 1-bit when bw
+void span_fill(const GBitmapDataRowInfo *info, bool bw, int16_t y, int16_t x0, int16_t x1, GColor color);
@@ -0,0 +1,269 @@
+#include "thick_line.h"
+
+#include "span_fill.h"
+
+// Row edges are kept in sixteenths of a pixel
+#define EDGE_ONE 16
+// Points further out than this, in pixels, could overflow the row steps
+#define COORD_LIMIT 1024
+
+static int32_t isqrt(int32_t value) {
+  if (value <= 0) {
+    return 0;
+  }
+  int32_t root = 0;
+  int32_t bit = 1 << 30;
+  while (bit > value) {
+    bit >>= 2;
+  }
+  while (bit) {
+    if (value >= root + bit) {
+      value -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return root;
+}
+
+// Once per line, for the distance across it
+static int32_t isqrt64(int64_t value) {
+  if (value <= 0) {
+    return 0;
+  }
+  int64_t root = 0;
+  int64_t bit = (int64_t)1 << 62;
+  while (bit > value) {
+    bit >>= 2;
+  }
+  while (bit) {
+    if (value >= root + bit) {
+      value -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return (int32_t)root;
+}
+
+static int32_t div_floor(int32_t a, int32_t b) {
+  int32_t q = a / b;
+  return (a % b != 0 && ((a < 0) != (b < 0))) ? q - 1 : q;
+}
+
+// color over the 8-bit pixel by quarters of coverage, 1 to 3
+static void blend_pixel(uint8_t *pixel, GColor color, uint8_t quarters) {
+  GColor under = { .argb = *pixel };
+  uint8_t rest = 4 - quarters;
+  GColor over = {
+    .a = 3,
+    .r = (color.r * quarters + under.r * rest + 2) / 4,
+    .g = (color.g * quarters + under.g * rest + 2) / 4,
+    .b = (color.b * quarters + under.b * rest + 2) / 4,
+  };
+  *pixel = over.argb;
+}
+
+// floor(num / den) and its remainder, for a numerator that grows by the
+// same step every row
+typedef struct {
+  int32_t quotient;
+  int32_t remainder;
+  int32_t step_quotient;
+  int32_t step_remainder;
+  int32_t den;
+} RowStep;
+
+static void row_step_init(RowStep *step, int32_t num, int32_t num_step, int32_t den) {
+  step->den = den;
+  step->quotient = div_floor(num, den);
+  step->remainder = num - step->quotient * den;
+  step->step_quotient = div_floor(num_step, den);
+  step->step_remainder = num_step - step->step_quotient * den;
+}
+
+static void row_step_next(RowStep *step) {
+  step->quotient += step->step_quotient;
+  step->remainder += step->step_remainder;
+  if (step->remainder >= step->den) {
+    step->remainder -= step->den;
+    step->quotient++;
+  }
+}
+
+// The columns x with a * x within lo..hi, where lo and hi grow by step every
+// row: a band of the row's edges, or with a zero, every column or none
+typedef struct {
+  bool rows_only;
+  int32_t lo;
+  int32_t hi;
+  int32_t step;
+  RowStep from;
+  RowStep to;
+} Bound;
+
+static void bound_init(Bound *bound, int32_t a, int32_t lo, int32_t hi, int32_t step) {
+  if (a < 0) {
+    int32_t t = lo;
+    lo = -hi;
+    hi = -t;
+    step = -step;
+    a = -a;
+  }
+  bound->rows_only = a == 0;
+  bound->lo = lo;
+  bound->hi = hi;
+  bound->step = step;
+  if (a) {
+    row_step_init(&bound->from, lo, step, a);
+    row_step_init(&bound->to, hi, step, a);
+  }
+}
+
+// Narrows from..to, in sixteenths, to the bound on this row
+static void bound_clip(const Bound *bound, int32_t *from, int32_t *to) {
+  if (bound->rows_only) {
+    if (bound->lo > 0 || bound->hi < 0) {
+      *from = INT32_MAX;
+      *to = INT32_MIN;
+    }
+    return;
+  }
+  int32_t lo = bound->from.quotient + (bound->from.remainder != 0);
+  int32_t hi = bound->to.quotient;
+  if (lo > *from) *from = lo;
+  if (hi < *to) *to = hi;
+}
+
+static void bound_next(Bound *bound) {
+  if (bound->rows_only) {
+    bound->lo += bound->step;
+    bound->hi += bound->step;
+    return;
+  }
+  row_step_next(&bound->from);
+  row_step_next(&bound->to);
+}
+
+bool thick_line_draw(GContext *ctx, GRect clip, GPoint p0, GPoint p1, uint8_t width, ThickLineCap cap,
+                     bool antialiased, GColor color) {
+  if (p0.x < -COORD_LIMIT || p0.x > COORD_LIMIT || p0.y < -COORD_LIMIT || p0.y > COORD_LIMIT ||
+      p1.x < -COORD_LIMIT || p1.x > COORD_LIMIT || p1.y < -COORD_LIMIT || p1.y > COORD_LIMIT) {
+    return false;
+  }
+  if (color.a == 0 || width == 0) {
+    return true;
+  }
+
+  // Doubled, top end first
+  int32_t shift = width % 2 == 0 ? 1 : 0;
+  int32_t ax = 2 * p0.x - shift, ay = 2 * p0.y - shift;
+  int32_t bx = 2 * p1.x - shift, by = 2 * p1.y - shift;
+  if (by < ay) {
+    int32_t t = ax;
+    ax = bx;
+    bx = t;
+    t = ay;
+    ay = by;
+    by = t;
+  }
+  int32_t r = width;
+  int32_t dx = bx - ax;
+  int32_t dy = by - ay;
+  int32_t length_sq = dx * dx + dy * dy;
+
+  // Rows of the segment, within the clip and the frame buffer
+  int16_t top = -div_floor(-(ay - r), 2);
+  int16_t bottom = div_floor(by + r, 2);
+  int16_t left = div_floor((ax < bx ? ax : bx) - r, 2);
+  int16_t right = -div_floor(-((ax < bx ? bx : ax) + r), 2);
+  int16_t clip_right = clip.origin.x + clip.size.w - 1;
+  if (top < clip.origin.y) top = clip.origin.y;
+  if (bottom > clip.origin.y + clip.size.h - 1) bottom = clip.origin.y + clip.size.h - 1;
+  if (top > bottom || right < clip.origin.x || left > clip_right) {
+    return true;
+  }
+
+  GBitmap *fb = graphics_capture_frame_buffer(ctx);
+  if (!fb) {
+    return false;
+  }
+  bool bw = gbitmap_get_format(fb) == GBitmapFormat1Bit;
+  antialiased = antialiased && !bw;
+  GRect bounds = gbitmap_get_bounds(fb);
+  if (top < 0) top = 0;
+  if (bottom > bounds.size.h - 1) bottom = bounds.size.h - 1;
+
+  // Within width / 2 of the line: a * x within c -+ r * |d|, the numerators
+  // scaled to sixteenths and the square root rounded down, which leaves the
+  // rounded edges exact
+  Bound across, along;
+  if (length_sq) {
+    int32_t m = isqrt64((int64_t)EDGE_ONE * EDGE_ONE * r * r * length_sq);
+    int32_t c = ax * dy + (2 * top - ay) * dx;
+    bound_init(&across, 2 * dy, EDGE_ONE * c - m, EDGE_ONE * c + m, EDGE_ONE * 2 * dx);
+    // Between the ends: (p - a) . d within 0..|d|^2
+    int32_t e = (2 * top - ay) * dy - ax * dx;
+    bound_init(&along, 2 * dx, -EDGE_ONE * e, EDGE_ONE * (length_sq - e), -EDGE_ONE * 2 * dy);
+  }
+
+  for (int16_t y = top; y <= bottom; y++) {
+    int32_t from = INT32_MAX;
+    int32_t to = INT32_MIN;
+    if (length_sq) {
+      int32_t lo = INT32_MIN, hi = INT32_MAX;
+      bound_clip(&across, &lo, &hi);
+      bound_clip(&along, &lo, &hi);
+      bound_next(&across);
+      bound_next(&along);
+      if (lo <= hi) {
+        from = lo;
+        to = hi;
+      }
+    }
+    if (cap == ThickLineCapRound) {
+      // Each row of a capsule is one run, so the ends' discs join it
+      for (int i = 0; i < 2; i++) {
+        int32_t ex = i ? bx : ax;
+        int32_t ey = (2 * y) - (i ? by : ay);
+        int32_t span_sq = r * r - ey * ey;
+        if (span_sq < 0) {
+          continue;
+        }
+        int32_t half = isqrt((EDGE_ONE / 2) * (EDGE_ONE / 2) * span_sq);
+        int32_t lo = (EDGE_ONE / 2) * ex - half;
+        int32_t hi = (EDGE_ONE / 2) * ex + half;
+        if (lo < from) from = lo;
+        if (hi > to) to = hi;
+      }
+    }
+    if (from > to) {
+      continue;
+    }
+
+    int16_t x0 = -div_floor(-from, EDGE_ONE);
+    int16_t x1 = div_floor(to, EDGE_ONE);
+    GBitmapDataRowInfo info = gbitmap_get_data_row_info(fb, y);
+    int16_t min_x = info.min_x > clip.origin.x ? info.min_x : clip.origin.x;
+    int16_t max_x = info.max_x < clip_right ? info.max_x : clip_right;
+    span_fill(&info, bw, y, x0 < min_x ? min_x : x0, x1 > max_x ? max_x : x1, color);
+    if (antialiased && x0 <= x1) {
+      // How far the edge reaches past the last center it covers
+      uint8_t before = (x0 * EDGE_ONE - from) * 4 / EDGE_ONE;
+      uint8_t after = (to - x1 * EDGE_ONE) * 4 / EDGE_ONE;
+      if (before && x0 - 1 >= min_x && x0 - 1 <= max_x) {
+        blend_pixel(info.data + x0 - 1, color, before);
+      }
+      if (after && x1 + 1 >= min_x && x1 + 1 <= max_x) {
+        blend_pixel(info.data + x1 + 1, color, after);
+      }
+    }
+  }
+
+  graphics_release_frame_buffer(ctx, fb);
+  return true;
+}
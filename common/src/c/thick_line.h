@@ -0,0 +1,34 @@
+#pragma once
+
+#include <pebble.h>
+
+// Wide segments written straight into the frame buffer, for the hands the
+// display list replays. graphics_draw_line() draws a wide stroke as a sweep
+// of round caps; here each row of the segment is solved once in integers
+// and written as a single run.
+//
+// A pixel is drawn when its center lies within width / 2 of the segment
+// (round caps) or of its part between the two ends (flat caps), with even
+// widths half a pixel up and to the left, which is where the SDK puts them.
+// Coordinates are doubled so both come out as whole numbers. The row's
+// edges are stepped from row to row as quotients and remainders, in
+// sixteenths of a pixel; rows and columns outside the clip are skipped
+// before any of that, so a hand that starts far off screen costs only its
+// visible rows.
+
+typedef enum {
+  // Square across the segment at its ends
+  ThickLineCapFlat,
+  // Half discs past its ends, as graphics_draw_line() draws
+  ThickLineCapRound,
+} ThickLineCap;
+
+// Draws the segment p0-p1 width pixels wide, clipped to clip and to the
+// visible part of each row. With antialiased, on 8-bit frame buffers the
+// pixel just outside either end of each row is blended with color by how
+// far the edge reaches into it. Returns false, having drawn nothing, when
+// the frame buffer can't be captured or the points are out of the range the
+// arithmetic is sized for, so the caller can fall back to
+// graphics_draw_line().
+bool thick_line_draw(GContext *ctx, GRect clip, GPoint p0, GPoint p1, uint8_t width, ThickLineCap cap,
+                     bool antialiased, GColor color);
@@ -0,0 +1,80 @@
+// Frame times from builds with PROFILING set, laid out as ProfileSlotStats in
+// common/src/c/profile.h. The watch keeps a slot per render tier and
+// settings combination and answers for one slot at a time. A build with
+// PROFILING sends the first slot on its own once it has started; only then
+// are the others asked for in turn, and a new round every few minutes, so
+// other builds are never asked. A request that goes unanswered is sent
+// again, PROFILE_RETRIES times before the round is given up.
+//
+// settingNames are the face's settings in the order it adds them, or a
+// function that gives them.
+var PROFILE_INTERVAL = 5 * 60 * 1000;
+var PROFILE_TIMEOUT = 10 * 1000;
+var PROFILE_RETRIES = 3;
+
+module.exports = function(settingNames) {
+  var slots = [];
+  var timer = null;
+  var retries = 0;
+
+  function nextRound() {
+    slots = [];
+    retries = 0;
+    clearTimeout(timer);
+    timer = setTimeout(function() {
+      request(0);
+    }, PROFILE_INTERVAL);
+  }
+
+  function request(index) {
+    clearTimeout(timer);
+    timer = setTimeout(function() {
+      if (retries++ < PROFILE_RETRIES) {
+        request(index);
+      } else {
+        nextRound();
+      }
+    }, PROFILE_TIMEOUT);
+    Pebble.sendAppMessage({ PROFILE_REQUEST: index });
+  }
+
+  Pebble.addEventListener('appmessage', function(e) {
+    var data = e.payload.PROFILE_STATS;
+    if (!data || data[0] !== 1) {
+      return;
+    }
+    var index = data[1];
+    // A round starts with the first slot, asked for or not; anything else
+    // is a late answer to a request already sent again
+    if (index === 0) {
+      slots = [];
+    } else if (index !== slots.length) {
+      return;
+    }
+    retries = 0;
+    var u16 = function(i) {
+      return data[i] | (data[i + 1] << 8);
+    };
+    if (index < data[2]) {
+      // Colors as GColor's argb8
+      var names = (typeof settingNames === 'function' ? settingNames() : settingNames) || [];
+      var settings = {};
+      for (var i = 0; i < data[4]; i++) {
+        settings[names[i] || i] = data[5 + i];
+      }
+      slots.push({
+        tier: ['full', 'saver'][data[3]],
+        settings: settings,
+        frames: u16(17),
+        min: u16(19),
+        mean: u16(21),
+        p95: u16(23),
+        max: u16(25)
+      });
+      request(index + 1);
+      return;
+    }
+    console.log('profile: ' + JSON.stringify(slots));
+    nextRound();
+  });
+};
@@ -0,0 +1,96 @@
+// Settings go to the watch as a delta (common/src/c/settings.h): only the
+// keys that changed since the settings it last acknowledged, with a new
+// SETTINGS_VERSION and, on top of those, SETTINGS_BASE. The watch answers
+// with the version it holds; any other than the one sent means it has
+// something else, and every key is sent again.
+//
+// The face hands over its Clay, made with autoHandleEvents off; this opens
+// the configuration page and sends what it returns. Options, all optional:
+// - scope(settings): which of several sets of settings these are, for an
+//   app whose sets are each acknowledged with a version of their own
+// - keys(settings): the keys of them to send, by default all
+// - header: a key sent with every delta, and on its own when its value
+//   differs from the last one the watch took
+var SETTINGS_ACKED = 'settings-acked';
+var SETTINGS_HEADER = 'settings-header';
+
+module.exports = function(clay, options) {
+  options = options || {};
+  var scopeOf = options.scope || function() {
+    return '';
+  };
+  var keysOf = options.keys || function(settings) {
+    return Object.keys(settings);
+  };
+  var header = options.header;
+  var pendingSettings = null;
+
+  // What each scope acknowledged
+  function ackedSettings() {
+    try {
+      return JSON.parse(localStorage.getItem(SETTINGS_ACKED)) || {};
+    } catch (e) {
+      return {};
+    }
+  }
+
+  function sendSettings(settings) {
+    var scope = scopeOf(settings);
+    var acked = ackedSettings()[scope];
+    var message = {};
+    var changed = false;
+    keysOf(settings).forEach(function(key) {
+      if (key in settings && (!acked || acked.settings[key] !== settings[key])) {
+        message[key] = settings[key];
+        changed = true;
+      }
+    });
+    if (changed) {
+      // Seconds, so a version never comes round again after the phone forgets
+      var version = Math.max(Math.floor(Date.now() / 1000), acked ? acked.version + 1 : 1);
+      message.SETTINGS_VERSION = version;
+      if (acked) {
+        message.SETTINGS_BASE = acked.version;
+      }
+      pendingSettings = { scope: scope, version: version, settings: settings };
+    } else if (!header || localStorage.getItem(SETTINGS_HEADER) === String(settings[header])) {
+      return;
+    }
+    if (header) {
+      message[header] = settings[header];
+    }
+    Pebble.sendAppMessage(message, function() {
+      if (header) {
+        localStorage.setItem(SETTINGS_HEADER, String(settings[header]));
+      }
+    });
+  }
+
+  Pebble.addEventListener('showConfiguration', function() {
+    Pebble.openURL(clay.generateUrl());
+  });
+
+  Pebble.addEventListener('webviewclosed', function(e) {
+    if (e && e.response) {
+      sendSettings(clay.getSettings(e.response));
+    }
+  });
+
+  Pebble.addEventListener('appmessage', function(e) {
+    var version = e.payload.SETTINGS_VERSION;
+    if (version === undefined || !pendingSettings) {
+      return;
+    }
+    var pending = pendingSettings;
+    pendingSettings = null;
+    var acked = ackedSettings();
+    if (version === pending.version) {
+      acked[pending.scope] = { version: version, settings: pending.settings };
+      localStorage.setItem(SETTINGS_ACKED, JSON.stringify(acked));
+      return;
+    }
+    delete acked[pending.scope];
+    localStorage.setItem(SETTINGS_ACKED, JSON.stringify(acked));
+    sendSettings(pending.settings);
+  });
+};
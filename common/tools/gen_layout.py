@@ -0,0 +1,181 @@
+#!/usr/bin/env python3
+"""Generate a face's per-platform layout header.
+
+Loads <face_dir>/layout.py and calls its build(layout, platform), which adds
+constants and tables of points through the Layout methods below. The result is written as a C
+header, so hand endpoints and dial geometry are table reads on the watch
+instead of trig and division on every redraw.
+
+Points are stored as offsets from the display center, computed exactly like
+the integer expression the face used before
+
+    sin_lookup(angle) * radius / TRIG_MAX_RATIO
+
+so the tables reproduce the pixels of the runtime code. Tables use 8-bit
+offsets when every point fits.
+
+usage: gen_layout.py <face_dir> <platform> <out_header>
+"""
+
+from __future__ import division
+
+import errno
+import math
+import os
+import sys
+
+TRIG_MAX_ANGLE = 0x10000
+TRIG_MAX_RATIO = 0xffff
+QUARTER = TRIG_MAX_ANGLE // 4
+
+
+class Platform(object):
+    def __init__(self, name, width, height, round_display):
+        self.name = name
+        self.width = width
+        self.height = height
+        self.round = round_display
+        # The faces were designed for the 144 wide rectangular and the 180
+        # round displays; other sizes scale from those
+        self.scale = width / (180.0 if round_display else 144.0)
+
+    def scaled(self, length):
+        return int(math.floor(length * self.scale + 0.5))
+
+
+PLATFORMS = {
+    'aplite': Platform('aplite', 144, 168, False),
+    'basalt': Platform('basalt', 144, 168, False),
+    'chalk': Platform('chalk', 180, 180, True),
+    'diorite': Platform('diorite', 144, 168, False),
+    'emery': Platform('emery', 200, 228, False),
+    'flint': Platform('flint', 144, 168, False),
+}
+
+
+def _sin_quarter(angle):
+    # Same rounding as the firmware's quarter-wave table (lround; adding 0.5
+    # before flooring rounds x.4999... up)
+    value = math.sin(angle * (2 * math.pi / TRIG_MAX_ANGLE)) * TRIG_MAX_RATIO
+    whole = math.floor(value)
+    return int(whole + 1 if value - whole >= 0.5 else whole)
+
+
+def sin_lookup(angle):
+    a = angle & (TRIG_MAX_ANGLE - 1)
+    if a < QUARTER:
+        return _sin_quarter(a)
+    if a < 2 * QUARTER:
+        return _sin_quarter(2 * QUARTER - a)
+    if a < 3 * QUARTER:
+        return -_sin_quarter(a - 2 * QUARTER)
+    return -_sin_quarter(TRIG_MAX_ANGLE - a)
+
+
+def cos_lookup(angle):
+    return sin_lookup(angle + QUARTER)
+
+
+def tdiv(a, b):
+    """C integer division, truncating toward zero."""
+    q = abs(a) // abs(b)
+    return q if (a < 0) == (b < 0) else -q
+
+
+class Layout(object):
+    TRIG_MAX_ANGLE = TRIG_MAX_ANGLE
+
+    def __init__(self, platform):
+        self.platform = platform
+        self.items = []
+
+    @staticmethod
+    def ray(angle, radius):
+        """Offset of the point radius along angle, 0 = 12 o'clock, clockwise."""
+        return (tdiv(sin_lookup(angle) * radius, TRIG_MAX_RATIO),
+                tdiv(-cos_lookup(angle) * radius, TRIG_MAX_RATIO))
+
+    @staticmethod
+    def minute_angles():
+        return [TRIG_MAX_ANGLE * m // 60 for m in range(60)]
+
+    @staticmethod
+    def hour_angles():
+        """Hour hand angle for every minute of 12 hours, by tm_hour % 12 * 60 + tm_min."""
+        return [TRIG_MAX_ANGLE * k // 720 for k in range(720)]
+
+    def constant(self, name, value, comment=None):
+        self.items.append(('constant', name, value, comment))
+
+    def points(self, name, points, comment=None):
+        self.items.append(('points', name, list(points), comment))
+
+    def rays(self, name, angles, radius, comment=None):
+        self.points(name, [self.ray(a, radius) for a in angles], comment)
+
+    def render(self, face):
+        p = self.platform
+        out = ['// Generated by common/tools/gen_layout.py from %s/layout.py for %s (%dx%d).'
+               % (face, p.name, p.width, p.height),
+               '// Do not edit.',
+               '',
+               '#pragma once',
+               '',
+               '#include "layout.h"',
+               '']
+        for kind, name, value, comment in self.items:
+            if (comment or kind == 'points') and out[-1]:
+                out.append('')
+            if comment:
+                out.append('// ' + comment)
+            if kind == 'constant':
+                out.append('#define LAYOUT_%s %d' % (name, value))
+            else:
+                small = all(-128 <= c <= 127 for point in value for c in point)
+                out.append('static const %s LAYOUT_%s[%d] = {'
+                           % ('LayoutOffset8' if small else 'LayoutOffset16', name, len(value)))
+                line = ' '
+                for x, y in value:
+                    entry = ' { %d, %d },' % (x, y)
+                    if len(line) + len(entry) > 100:
+                        out.append(line)
+                        line = ' '
+                    line += entry
+                out.append(line)
+                out.append('};')
+        out.append('')
+        return '\n'.join(out)
+
+
+def main(argv):
+    if len(argv) != 4:
+        sys.stderr.write(__doc__)
+        return 2
+    face_dir, platform_name, out_path = argv[1:]
+    if platform_name not in PLATFORMS:
+        sys.stderr.write('unknown platform %s\n' % platform_name)
+        return 2
+
+    # The SDK's waf runs on Python 2, so no importlib
+    spec = {}
+    with open(os.path.join(face_dir, 'layout.py')) as f:
+        exec(compile(f.read(), f.name, 'exec'), spec)
+
+    layout = Layout(PLATFORMS[platform_name])
+    spec['build'](layout, layout.platform)
+
+    out_dir = os.path.dirname(out_path)
+    if out_dir:
+        try:
+            os.makedirs(out_dir)
+        except OSError as e:
+            if e.errno != errno.EEXIST:
+                raise
+    face = os.path.basename(os.path.abspath(face_dir))
+    with open(out_path, 'w') as f:
+        f.write(layout.render(face))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -1,6 +1,18 @@
 #include <pebble.h>
 #include <math.h>
 
+#include "band_fill.h"
+#include "dial_cache.h"
+#include "display_list.h"
+#include "face.h"
+#include "face_clock.h"
+#include "instrument.h"
+#include "peek.h"
+#include "power.h"
+#include "profile.h"
+#include "render_tier.h"
+#include "settings.h"
+
 // Define M_PI if not provided by the platform headers
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -17,93 +29,167 @@ static Layer *s_canvas_layer;
 static bool s_invert_colors = false;
 static bool s_use_square = false;
 static GColor s_hand_color;
+static Settings s_settings;
+static DialCache s_dial_cache;
+// Height of the rings in the snapshot; a peek squeezes them
+static int16_t s_dial_height;
+// Markers (and the center square in rect mode), redrawn only where they change
+static DisplayList *s_display;
+
+// Ring parameters
+#define RING_BORDER 2
+#ifdef PBL_PLATFORM_EMERY
+// Thicker ring for larger Emery screen
+#define RING_THICKNESS 25
+#else
+#define RING_THICKNESS PBL_IF_RECT_ELSE(15, 20)
+#endif
 
-// Load settings
+// Rect mode marker geometry, built on the first rect frame and whenever the
+// bounds change. Each entry holds the rotated corners of one marker angle
+// exactly as gpath_draw_filled() would transform them, relative to the
+// center: the first corner in full, the others as deltas from it. Corners
+// 0-3 are the marker and 3, 2, 4, 5 the hour marker's border strip. Angles
+// half a turn apart mirror each other, so only the first half is stored.
+typedef struct {
+  int16_t x;
+  int16_t y;
+  int8_t dx[5];
+  int8_t dy[5];
+} MarkerCorners;
+
+#define MARKER_MINUTES 30
+#define MARKER_HOURS 360
+
+// Paths for the per-frame marker drawing. They live as long as the window
+// and reference their own points, which are only rewritten when a marker's
+// radii or thickness change, so frames don't touch the heap.
+typedef struct {
+  GPath *path;
+  GPoint points[4];
+  int16_t inner_r;
+  int16_t outer_r;
+  int16_t y0;
+  int16_t y1;
+} MarkerPath;
+
+static MarkerPath s_minute_marker;
+static MarkerPath s_hour_marker;
+static MarkerPath s_hour_border;
+
+// What each render tier draws beyond the rings and markers
+enum {
+  ElementRingBorders = 1 << 0,
+  ElementHourBorder = 1 << 1,
+};
+
+static const uint32_t s_tiers[RenderTierCount] = {
+  [RenderTierFull] = ElementRingBorders | ElementHourBorder,
+  [RenderTierSaver] = 0,
+};
+
+typedef struct {
+  MarkerCorners *corners;  // MARKER_MINUTES minute entries, then MARKER_HOURS hour entries
+  GRect bounds;
+} MarkerTable;
+
+// For the dial with the screen clear and under a full Quick View peek; while
+// a peek moves, the markers are computed per frame
+static MarkerTable s_full_markers;
+static MarkerTable s_peek_markers;
+
+// Bounds the dial fills with the screen clear and under a full peek
+static GRect s_full_bounds;
+static GRect s_peek_bounds;
+
+static void update_overlay(bool full);
+
+// Load settings, from the blob or the keys older versions used
 static void load_settings() {
-  s_invert_colors = persist_exists(MESSAGE_KEY_INVERT_COLORS) ? 
-                    persist_read_bool(MESSAGE_KEY_INVERT_COLORS) : false;
-  s_use_square = persist_exists(MESSAGE_KEY_USE_SQUARE) ?
-                 persist_read_bool(MESSAGE_KEY_USE_SQUARE) : false;
-  if (persist_exists(MESSAGE_KEY_HOURS_COLOR)) {
-    s_hand_color = (GColor){ .argb = (uint8_t)persist_read_int(MESSAGE_KEY_HOURS_COLOR) };
-  } else {
-    s_hand_color = GColorWhite;
-  }
-}
-
-// Save settings
-static void save_settings() {
-  persist_write_bool(MESSAGE_KEY_INVERT_COLORS, s_invert_colors);
-  persist_write_bool(MESSAGE_KEY_USE_SQUARE, s_use_square);
-  persist_write_int(MESSAGE_KEY_HOURS_COLOR, s_hand_color.argb);
+  s_invert_colors = false;
+  s_use_square = false;
+  s_hand_color = GColorWhite;
+
+  settings_init(&s_settings, 1);
+  settings_add_bool(&s_settings, MESSAGE_KEY_INVERT_COLORS, &s_invert_colors);
+  settings_add_bool(&s_settings, MESSAGE_KEY_USE_SQUARE, &s_use_square);
+  settings_add_color(&s_settings, MESSAGE_KEY_HOURS_COLOR, &s_hand_color);
+  power_add_settings(&s_settings);
+  render_tier_add_settings(&s_settings);
+  settings_load(&s_settings);
 }
 
 // AppMessage inbox handler for settings
 static void inbox_received_handler(DictionaryIterator *iterator, void *context) {
-  Tuple *inv_t = dict_find(iterator, MESSAGE_KEY_INVERT_COLORS);
-  if (inv_t) {
-    s_invert_colors = inv_t->value->int32 != 0;
-    save_settings();
-    layer_mark_dirty(s_canvas_layer);
+  profile_receive(iterator);
+  if (settings_apply(&s_settings, iterator)) {
+    power_settings_changed();
+    render_tier_settings_changed();
+    update_overlay(true);
   }
-  Tuple *sq_t = dict_find(iterator, MESSAGE_KEY_USE_SQUARE);
-  if (sq_t) {
-    s_use_square = sq_t->value->int32 != 0;
-    save_settings();
-    layer_mark_dirty(s_canvas_layer);
+}
+
+static void marker_path_create(MarkerPath *marker) {
+  marker->inner_r = marker->outer_r = marker->y0 = marker->y1 = 0;
+  for (int i = 0; i < 4; i++) {
+    marker->points[i] = GPointZero;
   }
-  Tuple *h_color_t = dict_find(iterator, MESSAGE_KEY_HOURS_COLOR);
-  if (h_color_t) {
-    s_hand_color = GColorFromHEX(h_color_t->value->int32);
-    save_settings();
-    layer_mark_dirty(s_canvas_layer); 
+  GPathInfo info = { .num_points = 4, .points = marker->points };
+  marker->path = gpath_create(&info);
+}
+
+static void marker_path_destroy(MarkerPath *marker) {
+  if (marker->path) {
+    gpath_destroy(marker->path);
+    marker->path = NULL;
   }
 }
 
-// Draw a flat-ended rectangular marker using GPath
-static void draw_marker(GContext *ctx, GPoint center, int32_t angle, int16_t inner_r, int16_t outer_r, int16_t thickness, GColor color) {
+// Rectangle from inner_r to outer_r along the X axis, y0 to y1 across it
+static void marker_path_set(MarkerPath *marker, int16_t inner_r, int16_t outer_r, int16_t y0, int16_t y1) {
+  if (marker->inner_r == inner_r && marker->outer_r == outer_r && marker->y0 == y0 && marker->y1 == y1) {
+    return;
+  }
+  marker->inner_r = inner_r;
+  marker->outer_r = outer_r;
+  marker->y0 = y0;
+  marker->y1 = y1;
+  marker->points[0] = GPoint(inner_r, y0);
+  marker->points[1] = GPoint(outer_r, y0);
+  marker->points[2] = GPoint(outer_r, y1);
+  marker->points[3] = GPoint(inner_r, y1);
+}
+
+// Record a flat-ended rectangular marker using one of the persistent paths
+static void draw_marker(MarkerPath *marker, GPoint center, int32_t angle, int16_t inner_r, int16_t outer_r, int16_t thickness, GColor color) {
+  if (!marker->path) {
+    return;
+  }
   int16_t hw = thickness / 2;
 
   // Rectangle from inner_r to outer_r along X-axis, centered vertically
-  GPoint pts[4];
-  pts[0] = GPoint(inner_r, -hw);
-  pts[1] = GPoint(outer_r, -hw);
-  pts[2] = GPoint(outer_r, hw);
-  pts[3] = GPoint(inner_r, hw);
-
-  GPathInfo path_info = { .num_points = 4, .points = pts };
-  GPath *path = gpath_create(&path_info);
-  gpath_rotate_to(path, angle);
-  gpath_move_to(path, center);
+  marker_path_set(marker, inner_r, outer_r, -hw, hw);
+  gpath_rotate_to(marker->path, angle);
+  gpath_move_to(marker->path, center);
 
-  graphics_context_set_fill_color(ctx, color);
-  gpath_draw_filled(ctx, path);
-
-  gpath_destroy(path);
+  display_list_fill_path(s_display, marker->path, color);
 }
 
 // Draw a marker with a border on the clockwise/right side only
-static void draw_marker_with_border(GContext *ctx, GPoint center, int32_t angle, int16_t inner_r, int16_t outer_r, int16_t thickness, GColor fill_color, GColor border_color, int16_t border_width) {
+static void draw_marker_with_border(MarkerPath *marker, MarkerPath *border, GPoint center, int32_t angle, int16_t inner_r, int16_t outer_r, int16_t thickness, GColor fill_color, GColor border_color, int16_t border_width) {
   int16_t hw = thickness / 2;
 
   // Draw border strip on clockwise edge (local Y from hw -> hw+border_width)
-  GPoint border_pts[4];
-  border_pts[0] = GPoint(inner_r, hw);
-  border_pts[1] = GPoint(outer_r, hw);
-  border_pts[2] = GPoint(outer_r, hw + border_width);
-  border_pts[3] = GPoint(inner_r, hw + border_width);
-
-  GPathInfo border_info = { .num_points = 4, .points = border_pts };
-  GPath *border_path = gpath_create(&border_info);
-  gpath_rotate_to(border_path, angle);
-  gpath_move_to(border_path, center);
+  if (border->path) {
+    marker_path_set(border, inner_r, outer_r, hw, hw + border_width);
+    gpath_rotate_to(border->path, angle);
+    gpath_move_to(border->path, center);
 
-  graphics_context_set_fill_color(ctx, border_color);
-  gpath_draw_filled(ctx, border_path);
-  gpath_destroy(border_path);
+    display_list_fill_path(s_display, border->path, border_color);
+  }
 
   // Draw fill on top
-  draw_marker(ctx, center, angle, inner_r, outer_r, thickness, fill_color);
+  draw_marker(marker, center, angle, inner_r, outer_r, thickness, fill_color);
 }
 
 // Map colors when invert setting is enabled
@@ -161,115 +247,311 @@ static int16_t radial_distance_to_inset(GRect bounds, int16_t inset, int32_t ang
   return (int16_t)dist;
 }
 
-static void canvas_update_proc(Layer *layer, GContext *ctx) {
-  GRect bounds = layer_get_bounds(layer);
-  GPoint center = GPoint(bounds.size.w / 2, bounds.size.h / 2);
+static int32_t minute_marker_angle(int minute) {
+  return (TRIG_MAX_ANGLE * minute / 60) - (TRIG_MAX_ANGLE / 4);
+}
+
+static int32_t hour_marker_angle(int hour, int minute) {
+  return (TRIG_MAX_ANGLE * (hour % 12) / 12) + (TRIG_MAX_ANGLE * minute / 720) - (TRIG_MAX_ANGLE / 4);
+}
+
+// Fill one table entry; false if a corner lies too far from the first one
+static bool build_marker_corners(MarkerCorners *corners, GRect bounds, int32_t angle, int16_t outer_inset, int16_t inner_inset, int16_t thickness, int16_t border_width) {
+  int16_t inner_r = radial_distance_to_inset(bounds, inner_inset, angle) - 2;
+  int16_t outer_r = radial_distance_to_inset(bounds, outer_inset, angle) + 3;
+  if (inner_r < 0) inner_r = 0;
+  int16_t hw = thickness / 2;
+
+  GPoint pts[6] = {
+    GPoint(inner_r, -hw), GPoint(outer_r, -hw), GPoint(outer_r, hw),
+    GPoint(inner_r, hw), GPoint(outer_r, hw + border_width), GPoint(inner_r, hw + border_width),
+  };
+
+  // Same rotation as gpath_rotate_to() and gpath_draw_filled()
+  int32_t rotation = angle % TRIG_MAX_ANGLE;
+  int32_t cosine = cos_lookup(rotation);
+  int32_t sine = sin_lookup(rotation);
+  for (int i = 0; i < 6; i++) {
+    int32_t x = (pts[i].x * cosine - pts[i].y * sine) / TRIG_MAX_RATIO;
+    int32_t y = (pts[i].y * cosine + pts[i].x * sine) / TRIG_MAX_RATIO;
+    if (i == 0) {
+      corners->x = x;
+      corners->y = y;
+      continue;
+    }
+    x -= corners->x;
+    y -= corners->y;
+    if (x < INT8_MIN || x > INT8_MAX || y < INT8_MIN || y > INT8_MAX) {
+      return false;
+    }
+    corners->dx[i - 1] = x;
+    corners->dy[i - 1] = y;
+  }
+  return true;
+}
+
+// Make sure the marker table matches bounds; false if it can't be built, in
+// which case markers are computed per frame
+static bool ensure_markers(MarkerTable *table, GRect bounds, int16_t outer_inset, int16_t inner_inset) {
+#ifdef MARKERS_PER_FRAME
+  // A host build that checks the tables against the per-frame markers
+  return false;
+#endif
+  if (table->corners && grect_equal(&bounds, &table->bounds)) {
+    return true;
+  }
+  if (!table->corners) {
+    table->corners = malloc((MARKER_MINUTES + MARKER_HOURS) * sizeof(MarkerCorners));
+    if (!table->corners) {
+      return false;
+    }
+  }
 
-  // Ring parameters
-  int16_t border = 2;
-  #ifdef PBL_PLATFORM_EMERY
-  // Thicker ring for larger Emery screen
-  int16_t ring_thickness = 25;
-  #else
-  int16_t ring_thickness = PBL_IF_RECT_ELSE(15, 20);
-  #endif
+  MarkerCorners *corners = table->corners;
+  bool ok = true;
+  for (int m = 0; m < MARKER_MINUTES && ok; m++) {
+    ok = build_marker_corners(&corners[m], bounds, minute_marker_angle(m), outer_inset, inner_inset, 10, 0);
+  }
+  for (int k = 0; k < MARKER_HOURS && ok; k++) {
+    ok = build_marker_corners(&corners[MARKER_MINUTES + k], bounds, hour_marker_angle(k / 60, k % 60), outer_inset, inner_inset, 12, 2);
+  }
+  if (!ok) {
+    free(table->corners);
+    table->corners = NULL;
+    return false;
+  }
+  table->bounds = bounds;
+  return true;
+}
 
-  // Decide mode: rectangular inset ring when setting enabled and device is rectangular
-  bool rect_mode = s_use_square && PBL_IF_RECT_ELSE(true, false);
+static void destroy_markers(MarkerTable *table) {
+  free(table->corners);
+  table->corners = NULL;
+}
 
-  if (rect_mode) {
-    // Draw background
-    graphics_context_set_fill_color(ctx, map_color(GColorBlack));
-    graphics_fill_rect(ctx, bounds, 0, GCornerNone);
+// Fill the quad made of the given corners of a table entry, negated for the
+// mirrored half of the dial
+static void fill_marker_corners(GPoint center, const MarkerCorners *corners, bool mirror, const uint8_t order[4], GColor color) {
+  GPoint pts[4];
+  for (int i = 0; i < 4; i++) {
+    int16_t x = corners->x;
+    int16_t y = corners->y;
+    if (order[i] > 0) {
+      x += corners->dx[order[i] - 1];
+      y += corners->dy[order[i] - 1];
+    }
+    pts[i] = mirror ? GPoint(center.x - x, center.y - y) : GPoint(center.x + x, center.y + y);
+  }
+
+  GPath path = { .num_points = 4, .points = pts, .rotation = 0, .offset = GPointZero };
+  display_list_fill_path(s_display, &path, color);
+}
+
+// Settings that change the background and rings, and the render tier. The
+// hour color only affects the markers, which are drawn every frame.
+static uint32_t dial_key() {
+  return (s_invert_colors ? 1 : 0) | (s_use_square ? 2 : 0) | (render_tier_get() << 2);
+}
+
+// The rings fill the part of the layer a peek leaves, shrinking with it
+static GRect dial_bounds() {
+  return GRect(s_full_bounds.origin.x, s_full_bounds.origin.y, s_full_bounds.size.w,
+               peek_lerp(s_full_bounds.size.h, s_peek_bounds.size.h));
+}
+
+// Whether the snapshot holds the rings as the peek leaves them
+static bool dial_cached() {
+  return dial_cache_has(&s_dial_cache, dial_key()) && s_dial_height == dial_bounds().size.h;
+}
+
+// Decide mode: rectangular inset ring when setting enabled and device is rectangular
+static bool is_rect_mode() {
+  return s_use_square && PBL_IF_RECT_ELSE(true, false);
+}
+
+// Draw the background and rings, and keep a snapshot of them. They are
+// nested shapes painted from the outside in, which band_fill() writes in one
+// pass; the SDK paints them in turn if it can't.
+static void draw_dial(GContext *ctx, GRect layer_bounds) {
+  GRect bounds = dial_bounds();
+  GPoint center = GPoint(bounds.size.w / 2, bounds.size.h / 2);
+  int16_t border = RING_BORDER;
+  int16_t ring_thickness = RING_THICKNESS;
+  BandShape shapes[BAND_FILL_MAX_SHAPES];
+  uint8_t count = 0;
 
+  // Background, under the peek too
+  shapes[count++] = (BandShape) { .type = BandShapeRect, .color = map_color(GColorBlack), .rect = layer_bounds };
+
+  if (is_rect_mode()) {
     uint16_t corner_radius = 8; // rounded corners for inset rectangles
 
     // Outer dark gray border (full bounds)
-    graphics_context_set_fill_color(ctx, map_color(GColorDarkGray));
-    graphics_fill_rect(ctx, bounds, corner_radius, GCornersAll);
+    if (render_tier_draws(ElementRingBorders)) {
+      shapes[count++] = (BandShape) { .type = BandShapeRect, .color = map_color(GColorDarkGray), .rect = bounds,
+                                      .corner_radius = corner_radius };
+    }
 
     // White ring outer rect (inset by border)
     GRect white_outer = GRect(bounds.origin.x + border, bounds.origin.y + border, bounds.size.w - border*2, bounds.size.h - border*2);
-    graphics_context_set_fill_color(ctx, map_color(GColorWhite));
-    graphics_fill_rect(ctx, white_outer, corner_radius, GCornersAll);
+    shapes[count++] = (BandShape) { .type = BandShapeRect, .color = map_color(GColorWhite), .rect = white_outer,
+                                    .corner_radius = corner_radius };
 
     // Inner dark gray border (inset by border + ring_thickness)
-    GRect inner_border = GRect(bounds.origin.x + border + ring_thickness, bounds.origin.y + border + ring_thickness, bounds.size.w - 2*(border + ring_thickness), bounds.size.h - 2*(border + ring_thickness));
-    graphics_context_set_fill_color(ctx, map_color(GColorDarkGray));
-    graphics_fill_rect(ctx, inner_border, corner_radius, GCornersAll);
+    if (render_tier_draws(ElementRingBorders)) {
+      GRect inner_border = GRect(bounds.origin.x + border + ring_thickness, bounds.origin.y + border + ring_thickness, bounds.size.w - 2*(border + ring_thickness), bounds.size.h - 2*(border + ring_thickness));
+      shapes[count++] = (BandShape) { .type = BandShapeRect, .color = map_color(GColorDarkGray), .rect = inner_border,
+                                      .corner_radius = corner_radius };
+    }
 
     // Center rect (inset further by border)
     GRect center_rect = GRect(bounds.origin.x + border + ring_thickness + border, bounds.origin.y + border + ring_thickness + border, bounds.size.w - 2*(border + ring_thickness + border), bounds.size.h - 2*(border + ring_thickness + border));
-    graphics_context_set_fill_color(ctx, map_color(GColorBlack));
-    graphics_fill_rect(ctx, center_rect, corner_radius, GCornersAll);
+    shapes[count++] = (BandShape) { .type = BandShapeRect, .color = map_color(GColorBlack), .rect = center_rect,
+                                    .corner_radius = corner_radius };
+  } else {
+    // Calculate radii for each layer
+    int16_t outer_radius = (center.x < center.y ? center.x : center.y) - 1;
+    int16_t r_outer_border = outer_radius;
+    int16_t r_white_outer = outer_radius - border;
+    int16_t r_white_inner = r_white_outer - ring_thickness;
+    int16_t r_inner_border = r_white_inner;
+    int16_t r_center = r_white_inner - border;
 
-    // Get current time
-    time_t now = time(NULL);
-    struct tm *t = localtime(&now);
+    // Outer dark gray border
+    if (render_tier_draws(ElementRingBorders)) {
+      shapes[count++] = (BandShape) { .type = BandShapeCircle, .color = map_color(GColorDarkGray), .center = center,
+                                      .radius = r_outer_border };
+    }
+
+    // White ring
+    shapes[count++] = (BandShape) { .type = BandShapeCircle, .color = map_color(GColorWhite), .center = center,
+                                    .radius = r_white_outer };
+
+    // Inner dark gray border
+    if (render_tier_draws(ElementRingBorders)) {
+      shapes[count++] = (BandShape) { .type = BandShapeCircle, .color = map_color(GColorDarkGray), .center = center,
+                                      .radius = r_inner_border };
+    }
+
+    // Black center
+    shapes[count++] = (BandShape) { .type = BandShapeCircle, .color = map_color(GColorBlack), .center = center,
+                                    .radius = r_center };
+  }
 
-    // Calculate angles (0 = 12 o'clock, clockwise)
-    int32_t minute_angle = (TRIG_MAX_ANGLE * t->tm_min / 60) - (TRIG_MAX_ANGLE / 4);
-    int32_t hour_angle = (TRIG_MAX_ANGLE * (t->tm_hour % 12) / 12) + (TRIG_MAX_ANGLE * t->tm_min / 720) - (TRIG_MAX_ANGLE / 4);
+  if (!band_fill(ctx, shapes, count)) {
+    for (uint8_t i = 0; i < count; i++) {
+      graphics_context_set_fill_color(ctx, shapes[i].color);
+      if (shapes[i].type == BandShapeCircle) {
+        graphics_fill_circle(ctx, shapes[i].center, shapes[i].radius);
+      } else {
+        graphics_fill_rect(ctx, shapes[i].rect, shapes[i].corner_radius,
+                           shapes[i].corner_radius ? GCornersAll : GCornerNone);
+      }
+    }
+  }
+  // The frames of a peek animation each squeeze the rings differently
+  if (!peek_is_animating()) {
+    dial_cache_store(&s_dial_cache, ctx, dial_key());
+    s_dial_height = bounds.size.h;
+  }
+}
 
-    // For rectangular mode compute radial distances to the inset rectangles along the angle
-    int16_t outer_inset = border;
-    int16_t inner_inset = border + ring_thickness;
+// Record the markers for the current time
+static void update_overlay(bool full) {
+  GRect bounds = dial_bounds();
+  GPoint center = GPoint(bounds.size.w / 2, bounds.size.h / 2);
+  int16_t border = RING_BORDER;
+  int16_t ring_thickness = RING_THICKNESS;
 
-    int16_t minute_inner = radial_distance_to_inset(bounds, inner_inset, minute_angle) - 2;
-    int16_t minute_outer = radial_distance_to_inset(bounds, outer_inset, minute_angle) + 3;
+  // Get current time
+  struct tm now = face_clock_now();
+  struct tm *t = &now;
 
-    int16_t hour_inner = radial_distance_to_inset(bounds, inner_inset, hour_angle) - 2;
-    int16_t hour_outer = radial_distance_to_inset(bounds, outer_inset, hour_angle) + 3;
+  // Without a display list (out of memory at load) the dial goes without
+  // the parts it records
+  if (!s_display) {
+    layer_mark_dirty(s_canvas_layer);
+    return;
+  }
 
-    // Clamp to sensible values
-    if (minute_inner < 0) minute_inner = 0;
-    if (hour_inner < 0) hour_inner = 0;
+  display_list_begin(s_display);
 
-    // Draw markers (mapped colors)
-    draw_marker(ctx, center, minute_angle, minute_inner, minute_outer, 10, map_color(PBL_IF_COLOR_ELSE(GColorDarkGray, GColorBlack)));
-    draw_marker_with_border(ctx, center, hour_angle, hour_inner, hour_outer, 12, map_color(PBL_IF_COLOR_ELSE(s_hand_color, GColorDarkGray)), map_color(GColorLightGray), 2);
+  if (is_rect_mode()) {
+    // For rectangular mode the markers span from the inner to the outer inset rectangle
+    int16_t outer_inset = border;
+    int16_t inner_inset = border + ring_thickness;
+    GColor minute_color = map_color(PBL_IF_COLOR_ELSE(GColorDarkGray, GColorBlack));
+    GColor hour_color = map_color(PBL_IF_COLOR_ELSE(s_hand_color, GColorDarkGray));
+    GColor hour_border_color = map_color(GColorLightGray);
+
+    MarkerTable *table = peek_is_animating() ? NULL : peek_get_amount() ? &s_peek_markers : &s_full_markers;
+    if (table && ensure_markers(table, bounds, outer_inset, inner_inset)) {
+      static const uint8_t marker_order[4] = { 0, 1, 2, 3 };
+      static const uint8_t border_order[4] = { 3, 2, 4, 5 };
+      int minute = t->tm_min;
+      int hour_index = (t->tm_hour % 12) * 60 + t->tm_min;
+      const MarkerCorners *minute_corners = &table->corners[minute % MARKER_MINUTES];
+      const MarkerCorners *hour_corners = &table->corners[MARKER_MINUTES + hour_index % MARKER_HOURS];
+      bool minute_mirror = minute >= MARKER_MINUTES;
+      bool hour_mirror = hour_index >= MARKER_HOURS;
+
+      // Minute marker behind the hour marker, whose border goes under its fill
+      fill_marker_corners(center, minute_corners, minute_mirror, marker_order, minute_color);
+      if (render_tier_draws(ElementHourBorder)) {
+        fill_marker_corners(center, hour_corners, hour_mirror, border_order, hour_border_color);
+      }
+      fill_marker_corners(center, hour_corners, hour_mirror, marker_order, hour_color);
+    } else {
+      // Calculate angles (0 = 12 o'clock, clockwise)
+      int32_t minute_angle = minute_marker_angle(t->tm_min);
+      int32_t hour_angle = hour_marker_angle(t->tm_hour, t->tm_min);
+
+      int16_t minute_inner = radial_distance_to_inset(bounds, inner_inset, minute_angle) - 2;
+      int16_t minute_outer = radial_distance_to_inset(bounds, outer_inset, minute_angle) + 3;
+
+      int16_t hour_inner = radial_distance_to_inset(bounds, inner_inset, hour_angle) - 2;
+      int16_t hour_outer = radial_distance_to_inset(bounds, outer_inset, hour_angle) + 3;
+
+      // Clamp to sensible values
+      if (minute_inner < 0) minute_inner = 0;
+      if (hour_inner < 0) hour_inner = 0;
+
+      // Draw markers (mapped colors)
+      draw_marker(&s_minute_marker, center, minute_angle, minute_inner, minute_outer, 10, minute_color);
+      if (render_tier_draws(ElementHourBorder)) {
+        draw_marker_with_border(&s_hour_marker, &s_hour_border, center, hour_angle, hour_inner, hour_outer, 12, hour_color, hour_border_color, 2);
+      } else {
+        draw_marker(&s_hour_marker, center, hour_angle, hour_inner, hour_outer, 12, hour_color);
+      }
+    }
 
     // Draw center square
     int16_t w_size = bounds.size.w - 2*(border + ring_thickness + border);
     int16_t h_size = bounds.size.h - 2*(border + ring_thickness + border);
     GRect center_square = GRect(center.x - w_size/2, center.y - h_size/2, w_size, h_size);
     uint16_t center_corner_radius = 8;
-    graphics_context_set_fill_color(ctx, map_color(GColorBlack));
-    graphics_fill_rect(ctx, center_square, center_corner_radius, GCornersAll);
+    int16_t edge = 2 * center_corner_radius;
+    if (!peek_is_animating() || w_size <= 2 * edge || h_size <= 2 * edge) {
+      display_list_fill_rect(s_display, center_square, center_corner_radius, GCornersAll, map_color(GColorBlack));
+    } else {
+      // The moved snapshot already has the middle black, and the markers
+      // don't reach past the rounded corners' depth, so only the edge that
+      // deep is covered, top and bottom with their corners
+      GColor black = map_color(GColorBlack);
+      GPoint o = center_square.origin;
+      display_list_fill_rect(s_display, GRect(o.x, o.y, w_size, edge), center_corner_radius, GCornersTop, black);
+      display_list_fill_rect(s_display, GRect(o.x, o.y + h_size - edge, w_size, edge), center_corner_radius,
+                             GCornersBottom, black);
+      display_list_fill_rect(s_display, GRect(o.x, o.y + edge, edge, h_size - 2 * edge), 0, GCornerNone, black);
+      display_list_fill_rect(s_display, GRect(o.x + w_size - edge, o.y + edge, edge, h_size - 2 * edge), 0,
+                             GCornerNone, black);
+    }
 
   } else {
     // Circular (default) behavior
-    // Calculate radii for each layer
     int16_t outer_radius = (center.x < center.y ? center.x : center.y) - 1;
-    int16_t r_outer_border = outer_radius;
     int16_t r_white_outer = outer_radius - border;
     int16_t r_white_inner = r_white_outer - ring_thickness;
-    int16_t r_inner_border = r_white_inner;
-    int16_t r_center = r_white_inner - border;
-
-    // Draw background
-    graphics_context_set_fill_color(ctx, map_color(GColorBlack));
-    graphics_fill_rect(ctx, bounds, 0, GCornerNone);
-
-    // Draw outer dark gray border
-    graphics_context_set_fill_color(ctx, map_color(GColorDarkGray));
-    graphics_fill_circle(ctx, center, r_outer_border);
-
-    // Draw white ring
-    graphics_context_set_fill_color(ctx, map_color(GColorWhite));
-    graphics_fill_circle(ctx, center, r_white_outer);
-
-    // Draw inner dark gray border
-    graphics_context_set_fill_color(ctx, map_color(GColorDarkGray));
-    graphics_fill_circle(ctx, center, r_inner_border);
-
-    // Draw black center
-    graphics_context_set_fill_color(ctx, map_color(GColorBlack));
-    graphics_fill_circle(ctx, center, r_center);
-
-    // Get current time
-    time_t now = time(NULL);
-    struct tm *t = localtime(&now);
 
     // Calculate angles (0 = 12 o'clock, clockwise)
     int32_t minute_angle = (TRIG_MAX_ANGLE * t->tm_min / 60) - (TRIG_MAX_ANGLE / 4);
@@ -280,15 +562,68 @@ static void canvas_update_proc(Layer *layer, GContext *ctx) {
     int16_t marker_outer = r_white_outer + 3;  // slightly into outer border
 
     // Draw minute marker first (behind hour)
-    draw_marker(ctx, center, minute_angle, marker_inner, marker_outer, 10, map_color(PBL_IF_COLOR_ELSE(GColorDarkGray, GColorBlack)));
+    draw_marker(&s_minute_marker, center, minute_angle, marker_inner, marker_outer, 10, map_color(PBL_IF_COLOR_ELSE(GColorDarkGray, GColorBlack)));
 
     // Draw hour marker on top - white with light gray border
-    draw_marker_with_border(ctx, center, hour_angle, marker_inner, marker_outer, 12, map_color(PBL_IF_COLOR_ELSE(s_hand_color, GColorDarkGray)), map_color(GColorLightGray), 2);
+    GColor hour_color = map_color(PBL_IF_COLOR_ELSE(s_hand_color, GColorDarkGray));
+    if (render_tier_draws(ElementHourBorder)) {
+      draw_marker_with_border(&s_hour_marker, &s_hour_border, center, hour_angle, marker_inner, marker_outer, 12, hour_color, map_color(GColorLightGray), 2);
+    } else {
+      draw_marker(&s_hour_marker, center, hour_angle, marker_inner, marker_outer, 12, hour_color);
+    }
   }
+
+  // The background and rings only change with the settings; without a
+  // snapshot of them everything is redrawn
+  display_list_end(s_display, full || !dial_cached());
+}
+
+// Restore the background and rings under the display list's regions. While
+// a peek animates the snapshot slides along with the center of the rings
+// instead, until the last frame draws them squeezed as they end up.
+static void canvas_update_proc(Layer *layer, GContext *ctx) {
+  instrument_stack_begin();
+  profile_frame_begin();
+
+  if (s_display && dial_cached()) {
+    for (uint8_t i = 0; i < display_list_get_num_regions(s_display); i++) {
+      dial_cache_restore_rect(&s_dial_cache, ctx, dial_key(), display_list_get_region(s_display, i));
+    }
+  } else if (!peek_is_animating() ||
+             !dial_cache_restore_moved(&s_dial_cache, ctx, dial_key(), (dial_bounds().size.h - s_dial_height) / 2)) {
+    draw_dial(ctx, layer_get_bounds(layer));
+  }
+
+  profile_frame_end();
+  instrument_frame(true);
+  instrument_heap(InstrumentPointUpdateProc);
+  instrument_stack_end();
+}
+
+static void peek_layout(GRect bounds, GRect obstructed) {
+  s_full_bounds = bounds;
+  s_peek_bounds = obstructed;
+}
+
+static void peek_frame(void) {
+  update_overlay(false);
+}
+
+// Redraws everything for the tier the battery charge calls for
+static void render_tier_handler(RenderTier tier) {
+  update_overlay(true);
+}
+
+// Catches up at once on a tap while the power policy held back redraws
+static void power_wake_handler(void) {
+  update_overlay(false);
 }
 
 static void tick_handler(struct tm *tick_time, TimeUnits units_changed) {
-  layer_mark_dirty(s_canvas_layer);
+  if (power_tick(tick_time, units_changed)) {
+    update_overlay(false);
+  }
+  instrument_report();
 }
 
 static void main_window_load(Window *window) {
@@ -298,19 +633,42 @@ static void main_window_load(Window *window) {
   s_canvas_layer = layer_create(bounds);
   layer_set_update_proc(s_canvas_layer, canvas_update_proc);
   layer_add_child(window_layer, s_canvas_layer);
+
+  marker_path_create(&s_minute_marker);
+  marker_path_create(&s_hour_marker);
+  marker_path_create(&s_hour_border);
+
+  s_display = display_list_create(s_canvas_layer, 8);
+  peek_init(s_canvas_layer, peek_layout, peek_frame);
+  update_overlay(true);
+
+  instrument_heap(InstrumentPointWindowLoad);
 }
 
 static void main_window_unload(Window *window) {
+  peek_deinit();
+  display_list_destroy(s_display);
   layer_destroy(s_canvas_layer);
+  dial_cache_destroy(&s_dial_cache);
+  destroy_markers(&s_full_markers);
+  destroy_markers(&s_peek_markers);
+  marker_path_destroy(&s_minute_marker);
+  marker_path_destroy(&s_hour_marker);
+  marker_path_destroy(&s_hour_border);
 }
 
 static void init() {
 
+  instrument_heap(InstrumentPointInit);
+
   // Load settings
   load_settings();
+  render_tier_init(s_tiers, render_tier_handler);
+  profile_init(&s_settings);
 
   s_main_window = window_create();
-  window_set_background_color(s_main_window, map_color(GColorBlack));
+  // The frame buffer keeps the last frame; only changed regions are redrawn
+  window_set_background_color(s_main_window, GColorClear);
   window_set_window_handlers(s_main_window, (WindowHandlers){
       .load = main_window_load,
       .unload = main_window_unload,
@@ -318,19 +676,26 @@ static void init() {
   window_stack_push(s_main_window, true);
 
   tick_timer_service_subscribe(MINUTE_UNIT, tick_handler);
+  power_init(power_wake_handler);
 
   // Register AppMessage handler for settings
-  app_message_register_inbox_received(inbox_received_handler);
-  app_message_open(128, 64);
+  face_open_messages(inbox_received_handler, settings_inbox_size(&s_settings), 64);
+  instrument_heap(InstrumentPointAppMessageOpen);
 }
 
 static void deinit(void) {
+  power_deinit();
+  render_tier_deinit();
   tick_timer_service_unsubscribe();
   window_destroy(s_main_window);
 }
 
+#ifdef FACE_COLLECTION
+const Face face_eclipse = { .name = "eclipse", .init = init, .deinit = deinit };
+#else
 int main(void) {
   init();
   app_event_loop();
   deinit();
 }
+#endif
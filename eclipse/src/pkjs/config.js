@@ -36,6 +36,46 @@ module.exports = [
       }
     ]
   },
+  {
+    "type": "section",
+    "items": [
+      {
+        "type": "heading",
+        "defaultValue": "Power Saving"
+      },
+      {
+        "type": "select",
+        "messageKey": "POWER_POLICY",
+        "label": "Slow Down",
+        "description": "Redraw less often while you sleep (with Pebble Health) or while the watch lies still. A tap brings it back at once.",
+        "defaultValue": "0",
+        "options": [
+          { "label": "Never", "value": "0" },
+          { "label": "While asleep", "value": "1" },
+          { "label": "While asleep or still", "value": "2" }
+        ]
+      },
+      {
+        "type": "slider",
+        "messageKey": "POWER_INTERVAL",
+        "label": "Minutes Between Redraws",
+        "defaultValue": 10,
+        "min": 2,
+        "max": 30,
+        "step": 1
+      },
+      {
+        "type": "slider",
+        "messageKey": "BATTERY_SAVER",
+        "label": "Simpler Drawing At Battery (%)",
+        "description": "Leave out some details while the battery is this low or lower; 0 never does.",
+        "defaultValue": 20,
+        "min": 0,
+        "max": 50,
+        "step": 10
+      }
+    ]
+  },
   {
     "type": "submit",
     "defaultValue": "Save Settings"
@@ -0,0 +1,27 @@
+# Per-platform geometry of Enough, written to layout.auto.h at build time by
+# common/tools/gen_layout.py. Lengths are in pixels of the 144 wide (or 180
+# round) design and scale with the display.
+
+
+def build(layout, p):
+    hour_inset = 28 if not p.round else 44
+    minute_inset = 8 if not p.round else 22
+
+    layout.constant('HUB_RADIUS', p.scaled(20), 'Disc behind the hands')
+    layout.constant('NUMBER_OFFSET', p.scaled(22), 'Numeral 6, below the center')
+    layout.constant('HUB_OUTER_RADIUS', p.scaled(4), 'Center circle')
+    layout.constant('HUB_INNER_RADIUS', p.scaled(3))
+
+    # Twelve radial lines, long enough to leave the display
+    radius = max(p.width, p.height)
+    layout.points('LINES', [layout.ray(layout.TRIG_MAX_ANGLE * i // 12, radius) for i in range(12)],
+                  'Radial lines, one per hour')
+    layout.points('ACCENTS', [layout.ray(layout.TRIG_MAX_ANGLE * hour // 12, p.scaled(45)) for hour in (0, 3, 9)],
+                  'Accent lines at 12, 3 and 9 o\'clock')
+
+    layout.rays('HOUR_TIP', layout.hour_angles(), p.width // 2 - p.scaled(hour_inset),
+                'Hour hand tip by LAYOUT_HOUR_INDEX')
+    layout.rays('HAND_TAIL', layout.hour_angles(), -p.scaled(16),
+                'Tail of either hand, by LAYOUT_HOUR_INDEX or tm_min * 12')
+    layout.rays('MINUTE_TIP', layout.minute_angles(), p.width // 2 - p.scaled(minute_inset),
+                'Minute hand tip by tm_min')
@@ -1,15 +1,78 @@
 #include <pebble.h>
 
+#include "dial_cache.h"
+#include "display_list.h"
+#include "face.h"
+#include "face_clock.h"
+#include "instrument.h"
+#include "layout.auto.h"
+#include "numeral_cache.h"
+#include "pdc_color.h"
+#include "peek.h"
+#include "power.h"
+#include "profile.h"
+#include "render_tier.h"
+#include "settings.h"
+
 static Window *s_main_window;
 static Layer *s_canvas_layer;
-static GDrawCommandImage *s_number_6_white;
-static GDrawCommandImage *s_number_6_black;
+// Recolored in place for the current colors when the dial is drawn
+static GDrawCommandImage *s_number_6;
+// Loads it after the first frame
+static AppTimer *s_load_timer;
+
+// Snapshot of everything but the hands
+static DialCache s_dial_cache;
+// Center of the dial in the snapshot; a peek moves it
+static int16_t s_dial_center_y;
+// The numeral as drawn, for when the snapshot doesn't fit
+static NumeralCache s_numeral_cache;
+// Hands and hub, redrawn only where they change
+static DisplayList *s_display;
+
+// Center of the dial with the screen clear and under a full Quick View peek
+static GPoint s_full_center;
+static GPoint s_peek_center;
 
 // Time tracking
 static struct tm s_last_time;
 
 // Settings
 static bool s_invert_colors = false;
+static Settings s_settings;
+
+// What each render tier draws beyond the accents, numeral and hands
+enum {
+  ElementRadialLines = 1 << 0,
+};
+
+static const uint32_t s_tiers[RenderTierCount] = {
+  [RenderTierFull] = ElementRadialLines,
+  [RenderTierSaver] = 0,
+};
+
+static void update_overlay(bool full);
+
+// The dial changes with the colors, the render tier, and the numeral once it
+// is loaded
+static uint32_t dial_key() {
+  return (s_invert_colors ? 1 : 0) | (render_tier_get() << 1) | ((s_load_timer ? 0 : 1) << 2);
+}
+
+// Everything on the dial is placed from its center
+static GPoint dial_center() {
+  return peek_lerp_point(s_full_center, s_peek_center);
+}
+
+// The numeral copied back as drawn, which a peek moves along with the center
+static uint32_t numeral_key() {
+  return dial_key() | ((uint32_t)(uint16_t)dial_center().y << 3);
+}
+
+// Whether the snapshot holds the dial where the peek leaves it
+static bool dial_cached() {
+  return dial_cache_has(&s_dial_cache, dial_key()) && s_dial_center_y == dial_center().y;
+}
 
 // Color helper functions
 static GColor get_background_color() {
@@ -39,185 +102,243 @@ static GColor get_hand_minute_color() {
   #endif
 }
 
-// Load settings
+// Load settings, from the blob or the keys older versions used
 static void load_settings() {
-  s_invert_colors = persist_exists(MESSAGE_KEY_INVERT_COLORS) ? 
-                    persist_read_bool(MESSAGE_KEY_INVERT_COLORS) : false;
-}
+  s_invert_colors = false;
 
-// Save settings
-static void save_settings() {
-  persist_write_bool(MESSAGE_KEY_INVERT_COLORS, s_invert_colors);
+  settings_init(&s_settings, 1);
+  settings_add_bool(&s_settings, MESSAGE_KEY_INVERT_COLORS, &s_invert_colors);
+  power_add_settings(&s_settings);
+  render_tier_add_settings(&s_settings);
+  settings_load(&s_settings);
 }
 
 // Inbox received callback
 static void inbox_received_callback(DictionaryIterator *iterator, void *context) {
-  Tuple *invert_tuple = dict_find(iterator, MESSAGE_KEY_INVERT_COLORS);
-  
-  if (invert_tuple) {
-    s_invert_colors = invert_tuple->value->int32 == 1;
-    save_settings();
-    layer_mark_dirty(s_canvas_layer);
+  profile_receive(iterator);
+  if (settings_apply(&s_settings, iterator)) {
+    power_settings_changed();
+    render_tier_settings_changed();
+    update_overlay(true);
   }
 }
 
 // Drawing the clock face
 static void canvas_update_proc(Layer *layer, GContext *ctx) {
-  GRect bounds = layer_get_bounds(layer);
-  GPoint center = grect_center_point(&bounds);
-  
-  // Set background
-  graphics_context_set_fill_color(ctx, get_background_color());
-  graphics_fill_rect(ctx, bounds, 0, GCornerNone);
-  
-  // Draw radial lines (12 segments)
-  graphics_context_set_stroke_color(ctx, get_line_color());
-  graphics_context_set_stroke_width(ctx, 1);
-  
-  // Use a large enough radius to ensure all lines reach edges
-  int radius = bounds.size.w > bounds.size.h ? bounds.size.w : bounds.size.h;
-  
-  for (int i = 0; i < 12; i++) {
-    int32_t angle = TRIG_MAX_ANGLE * i / 12;
-    GPoint outer = {
-      .x = (int16_t)(sin_lookup(angle) * radius / TRIG_MAX_RATIO) + center.x,
-      .y = (int16_t)(-cos_lookup(angle) * radius / TRIG_MAX_RATIO) + center.y,
-    };
-    graphics_draw_line(ctx, center, outer);
-  }
-  
-  // Draw thicker lines for 12, 3, and 9 o'clock (50px from center)
-  graphics_context_set_stroke_color(ctx, get_accent_color());
-  graphics_context_set_stroke_width(ctx, 2);
-  
-  // 12 o'clock (top)
-  int32_t angle_12 = 0;
-  GPoint line_12 = {
-    .x = center.x,
-    .y = (int16_t)(-cos_lookup(angle_12) * 45 / TRIG_MAX_RATIO) + center.y,
-  };
-  graphics_draw_line(ctx, center, line_12);
-  
-  // 3 o'clock (right)
-  int32_t angle_3 = TRIG_MAX_ANGLE / 4;
-  GPoint line_3 = {
-    .x = (int16_t)(sin_lookup(angle_3) * 45 / TRIG_MAX_RATIO) + center.x,
-    .y = center.y,
-  };
-  graphics_draw_line(ctx, center, line_3);
-  
-  // 9 o'clock (left)
-  int32_t angle_9 = TRIG_MAX_ANGLE * 3 / 4;
-  GPoint line_9 = {
-    .x = (int16_t)(sin_lookup(angle_9) * 45 / TRIG_MAX_RATIO) + center.x,
-    .y = center.y,
-  };
-  graphics_draw_line(ctx, center, line_9);
-  
-  // Draw white circle behind hands
-  graphics_context_set_fill_color(ctx, get_background_color());
-  graphics_fill_circle(ctx, center, 20);
+  instrument_stack_begin();
+  profile_frame_begin();
 
+  GRect bounds = layer_get_bounds(layer);
+  GPoint center = dial_center();
   
-  // Draw PDC number 6 at bottom
-  const int top_padding = 22;
-  if (s_number_6_black && s_number_6_white) {
-    GSize img_size = gdraw_command_image_get_bounds_size(s_invert_colors ? s_number_6_white : s_number_6_black);
+  // The dial only changes with its key; restore the last snapshot of it
+  // under the display list's regions when there is one. While a peek
+  // animates the snapshot slides along with the center instead, until the
+  // last frame draws the dial where it ends up.
+  if (s_display && dial_cached()) {
+    for (uint8_t i = 0; i < display_list_get_num_regions(s_display); i++) {
+      dial_cache_restore_rect(&s_dial_cache, ctx, dial_key(), display_list_get_region(s_display, i));
+    }
+  } else if (!peek_is_animating() ||
+             !dial_cache_restore_moved(&s_dial_cache, ctx, dial_key(), center.y - s_dial_center_y)) {
+    // Set background
+    graphics_context_set_fill_color(ctx, get_background_color());
+    graphics_fill_rect(ctx, bounds, 0, GCornerNone);
+    
+    // Draw radial lines (12 segments)
+    if (render_tier_draws(ElementRadialLines)) {
+      graphics_context_set_stroke_color(ctx, get_line_color());
+      graphics_context_set_stroke_width(ctx, 1);
 
-    // Draw background for number 6
+      // Lines run far enough to leave the screen
+      for (int i = 0; i < 12; i++) {
+        graphics_draw_line(ctx, center, LAYOUT_POINT(center, LAYOUT_LINES[i]));
+      }
+    }
+    
+    // Draw thicker lines for 12, 3, and 9 o'clock
+    graphics_context_set_stroke_color(ctx, get_accent_color());
+    graphics_context_set_stroke_width(ctx, 2);
+    for (int i = 0; i < 3; i++) {
+      graphics_draw_line(ctx, center, LAYOUT_POINT(center, LAYOUT_ACCENTS[i]));
+    }
+    
+    // Draw white circle behind hands
     graphics_context_set_fill_color(ctx, get_background_color());
-    graphics_fill_rect(ctx, GRect(center.x - (img_size.w - 4) / 2, (bounds.size.h / 2) + top_padding - 4, img_size.w - 4, img_size.h + 8), 2, GCornersAll);
+    graphics_fill_circle(ctx, center, LAYOUT_HUB_RADIUS);
+
     
-    GRect img_rect = GRect(center.x - img_size.w / 2, (bounds.size.h / 2) + top_padding, img_size.w, img_size.h);
-    gdraw_command_image_draw(ctx, s_invert_colors ? s_number_6_white : s_number_6_black, img_rect.origin);
+    // Draw PDC number 6 at bottom
+    const int top_padding = LAYOUT_NUMBER_OFFSET;
+    GRect numeral = GRectZero;
+    if (s_number_6 && !numeral_cache_draw(&s_numeral_cache, ctx, numeral_key())) {
+      GSize img_size = gdraw_command_image_get_bounds_size(s_number_6);
+
+      // Draw background for number 6
+      graphics_context_set_fill_color(ctx, get_background_color());
+      graphics_fill_rect(ctx, GRect(center.x - (img_size.w - 4) / 2, center.y + top_padding - 4, img_size.w - 4, img_size.h + 8), 2, GCornersAll);
+    
+      GRect img_rect = GRect(center.x - img_size.w / 2, center.y + top_padding, img_size.w, img_size.h);
+      pdc_color_set(s_number_6, get_accent_color());
+      gdraw_command_image_draw(ctx, s_number_6, img_rect.origin);
+
+      // The image with the taller background behind it
+      numeral = GRect(img_rect.origin.x, img_rect.origin.y - 4, img_size.w, img_size.h + 8);
+    }
+
+    // The frames of a peek animation each place the dial differently
+    if (!peek_is_animating()) {
+      dial_cache_store(&s_dial_cache, ctx, dial_key());
+      s_dial_center_y = center.y;
+    }
+    // Without a snapshot the dial is drawn every frame; copy the numeral
+    // back from then on instead of drawing it
+    if (dial_cache_has(&s_dial_cache, dial_key())) {
+      numeral_cache_destroy(&s_numeral_cache);
+    } else if (numeral.size.w) {
+      numeral_cache_store(&s_numeral_cache, ctx, numeral_key(), &numeral, 1);
+    }
   }
+
+  profile_frame_end();
+  instrument_frame(!s_load_timer);
+  instrument_heap(InstrumentPointUpdateProc);
+  instrument_stack_end();
+}
+
+// Records the hands and hub for s_last_time
+static void update_overlay(bool full) {
+  GPoint center = dial_center();
+
+  // Without a display list (out of memory at load) the dial goes without
+  // the parts it records
+  if (!s_display) {
+    layer_mark_dirty(s_canvas_layer);
+    return;
+  }
+
+  display_list_begin(s_display);
   
-  // Calculate time values
-  int hour = s_last_time.tm_hour % 12;
+  // Hand endpoints come from the tables in layout.auto.h: the hour hand has
+  // a position for every minute of 12 hours, the minute hand one per minute
+  int hour_index = LAYOUT_HOUR_INDEX(&s_last_time);
   int minute = s_last_time.tm_min;
   
-  // Calculate hand angles
-  int32_t minute_angle = TRIG_MAX_ANGLE * minute / 60;
-  int32_t hour_angle = (TRIG_MAX_ANGLE * ((hour * 60) + minute)) / (12 * 60);
-  
   // Draw hour hand (shorter, thicker, red)
-  graphics_context_set_stroke_width(ctx, 3);
-  graphics_context_set_stroke_color(ctx, get_hand_hour_color());
-  GPoint hour_hand = {
-    .x = (int16_t)(sin_lookup(hour_angle) * (bounds.size.w / 2 - PBL_IF_RECT_ELSE(28, 44)) / TRIG_MAX_RATIO) + center.x,
-    .y = (int16_t)(-cos_lookup(hour_angle) * (bounds.size.w / 2 - PBL_IF_RECT_ELSE(28, 44)) / TRIG_MAX_RATIO) + center.y,
-  };
-  GPoint hour_hand_tail = {
-    .x = (int16_t)(-sin_lookup(hour_angle) * 16 / TRIG_MAX_RATIO) + center.x,
-    .y = (int16_t)(cos_lookup(hour_angle) * 16 / TRIG_MAX_RATIO) + center.y,
-  };
+  GPoint hour_hand = LAYOUT_POINT(center, LAYOUT_HOUR_TIP[hour_index]);
+  GPoint hour_hand_tail = LAYOUT_POINT(center, LAYOUT_HAND_TAIL[hour_index]);
   // Draw from tail through center to tip
-  graphics_draw_line(ctx, hour_hand_tail, center);
-  graphics_draw_line(ctx, center, hour_hand);
+  display_list_draw_line(s_display, hour_hand_tail, center, 3, get_hand_hour_color());
+  display_list_draw_line(s_display, center, hour_hand, 3, get_hand_hour_color());
   
   // Draw minute hand (longer, medium thickness, red)
-  graphics_context_set_stroke_width(ctx, 3);
-  graphics_context_set_stroke_color(ctx, get_hand_minute_color());
-  GPoint minute_hand = {
-    .x = (int16_t)(sin_lookup(minute_angle) * (bounds.size.w / 2 - PBL_IF_RECT_ELSE(8, 22)) / TRIG_MAX_RATIO) + center.x,
-    .y = (int16_t)(-cos_lookup(minute_angle) * (bounds.size.w / 2 - PBL_IF_RECT_ELSE(8, 22)) / TRIG_MAX_RATIO) + center.y,
-  };
-  GPoint minute_hand_tail = {
-    .x = (int16_t)(-sin_lookup(minute_angle) * 16 / TRIG_MAX_RATIO) + center.x,
-    .y = (int16_t)(cos_lookup(minute_angle) * 16 / TRIG_MAX_RATIO) + center.y,
-  };
+  GPoint minute_hand = LAYOUT_POINT(center, LAYOUT_MINUTE_TIP[minute]);
+  GPoint minute_hand_tail = LAYOUT_POINT(center, LAYOUT_HAND_TAIL[minute * 12]);
   // Draw from tail through center to tip
-  graphics_draw_line(ctx, minute_hand_tail, center);
-  graphics_draw_line(ctx, center, minute_hand);
+  display_list_draw_line(s_display, minute_hand_tail, center, 3, get_hand_minute_color());
+  display_list_draw_line(s_display, center, minute_hand, 3, get_hand_minute_color());
   
   // Draw center circle with red border
-  graphics_context_set_stroke_color(ctx, GColorRed);
-  graphics_context_set_stroke_width(ctx, 2);
-  graphics_draw_circle(ctx, center, 4);
-  graphics_context_set_fill_color(ctx, GColorWhite);
-  graphics_fill_circle(ctx, center, 3);
+  display_list_draw_circle(s_display, center, LAYOUT_HUB_OUTER_RADIUS, 2, GColorRed);
+  display_list_fill_circle(s_display, center, LAYOUT_HUB_INNER_RADIUS, GColorWhite);
+
+  // Without a snapshot of the dial as it stands everything is redrawn
+  display_list_end(s_display, full || !dial_cached());
+}
+
+// The dial only moves with its center
+static void peek_layout(GRect bounds, GRect obstructed) {
+  s_full_center = grect_center_point(&bounds);
+  s_peek_center = grect_center_point(&obstructed);
+}
+
+static void peek_frame(void) {
+  update_overlay(false);
+}
+
+// Redraws everything for the tier the battery charge calls for
+static void render_tier_handler(RenderTier tier) {
+  update_overlay(true);
+}
+
+// Catches up at once on a tap while the power policy held back redraws
+static void power_wake_handler(void) {
+  s_last_time = face_clock_now();
+  update_overlay(false);
 }
 
 // Update time
 static void tick_handler(struct tm *tick_time, TimeUnits units_changed) {
   s_last_time = *tick_time;
-  layer_mark_dirty(s_canvas_layer);
+  if (power_tick(tick_time, units_changed)) {
+    update_overlay(false);
+  }
+  instrument_report();
+}
+
+// Loads the NUMBER_6 PDC resource once the first frame is out; the dial is
+// then drawn again with it
+static void load_numeral(void *data) {
+  s_load_timer = NULL;
+  s_number_6 = gdraw_command_image_create_with_resource(RESOURCE_ID_NUMBER_6);
+  update_overlay(true);
 }
 
 // Window load
 static void main_window_load(Window *window) {
   Layer *window_layer = window_get_root_layer(window);
   GRect bounds = layer_get_bounds(window_layer);
-  
-  // Load NUMBER_6 PDC resource
-  s_number_6_white = gdraw_command_image_create_with_resource(RESOURCE_ID_NUMBER_6_WHITE);
-  s_number_6_black = gdraw_command_image_create_with_resource(RESOURCE_ID_NUMBER_6_BLACK);
-  
+
   // Create canvas layer
   s_canvas_layer = layer_create(bounds);
   layer_set_update_proc(s_canvas_layer, canvas_update_proc);
   layer_add_child(window_layer, s_canvas_layer);
   
   // Get initial time
-  time_t temp = time(NULL);
-  s_last_time = *localtime(&temp);
+  s_last_time = face_clock_now();
+
+  s_display = display_list_create(s_canvas_layer, 8);
+  peek_init(s_canvas_layer, peek_layout, peek_frame);
+  update_overlay(true);
+
+  // The first frame has the lines and hands; parsing the numeral would only
+  // hold it back
+  s_number_6 = NULL;
+  s_load_timer = app_timer_register(0, load_numeral, NULL);
+  if (!s_load_timer) {
+    load_numeral(NULL);
+  }
+
+  instrument_heap(InstrumentPointWindowLoad);
 }
 
 // Window unload
 static void main_window_unload(Window *window) {
+  if (s_load_timer) {
+    app_timer_cancel(s_load_timer);
+    s_load_timer = NULL;
+  }
+  peek_deinit();
+  display_list_destroy(s_display);
   layer_destroy(s_canvas_layer);
-  gdraw_command_image_destroy(s_number_6_white);
-  gdraw_command_image_destroy(s_number_6_black);
+  dial_cache_destroy(&s_dial_cache);
+  numeral_cache_destroy(&s_numeral_cache);
+  gdraw_command_image_destroy(s_number_6);
 }
 
 // App initialization
 static void init() {
+  instrument_heap(InstrumentPointInit);
+
   // Load settings
   load_settings();
+  render_tier_init(s_tiers, render_tier_handler);
+  profile_init(&s_settings);
   
   // Create main window
   s_main_window = window_create();
-  window_set_background_color(s_main_window, get_background_color());
+  // The frame buffer keeps the last frame; only changed regions are redrawn
+  window_set_background_color(s_main_window, GColorClear);
   window_set_window_handlers(s_main_window, (WindowHandlers) {
     .load = main_window_load,
     .unload = main_window_unload,
@@ -226,20 +347,28 @@ static void init() {
   
   // Register with TickTimerService
   tick_timer_service_subscribe(MINUTE_UNIT, tick_handler);
+  power_init(power_wake_handler);
   
   // Register callbacks
-  app_message_register_inbox_received(inbox_received_callback);
-  app_message_open(128, 128);
+  face_open_messages(inbox_received_callback, settings_inbox_size(&s_settings), 128);
+  instrument_heap(InstrumentPointAppMessageOpen);
 }
 
 // App deinitialization
 static void deinit() {
+  power_deinit();
+  render_tier_deinit();
+  tick_timer_service_unsubscribe();
   window_destroy(s_main_window);
 }
 
 // Main
+#ifdef FACE_COLLECTION
+const Face face_enough = { .name = "enough", .init = init, .deinit = deinit };
+#else
 int main(void) {
   init();
   app_event_loop();
   deinit();
 }
+#endif
@@ -0,0 +1,31 @@
+# Per-platform geometry of Hollow, written to layout.auto.h at build time by
+# common/tools/gen_layout.py. Each hand runs from the border circle inward,
+# with lengths given as a percentage of its radius, so there is one set of
+# tables for the round dial and one for the larger rectangular one.
+
+HOVER_LENGTH = 20
+
+
+def _hand(layout, prefix, name, angles, radius, length):
+    length = radius * length // 100
+    hover = radius * HOVER_LENGTH // 100
+    layout.rays(prefix + name + '_START', angles, radius)
+    layout.rays(prefix + name + '_END', angles, length)
+    layout.rays(prefix + name + '_OVERLAY_END', angles, length + hover)
+
+
+def build(layout, p):
+    # The hour hand only moves in whole steps of a twelfth of the hour angle
+    step = layout.TRIG_MAX_ANGLE // 12
+    hour_angles = [step * (k // 60) + step * (k % 60) // 60 for k in range(720)]
+    minute_angles = layout.minute_angles()
+
+    modes = (
+        ('', (p.width - 2) // 2, 70, 40),
+        ('RECT_', p.height // 2 + 40, 40, 20),
+    )
+    for prefix, radius, hour_length, minute_length in modes:
+        layout.constant(prefix + 'RADIUS', radius, 'Border circle of the %s dial'
+                        % ('rectangular' if prefix else 'round'))
+        _hand(layout, prefix, 'HOUR', hour_angles, radius, hour_length)
+        _hand(layout, prefix, 'MINUTE', minute_angles, radius, minute_length)
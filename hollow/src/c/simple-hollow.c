@@ -1,106 +1,82 @@
 #include <pebble.h>
 
+#include "band_fill.h"
+#include "display_list.h"
+#include "face.h"
+#include "face_clock.h"
+#include "instrument.h"
+#include "layout.auto.h"
+#include "peek.h"
+#include "power.h"
+#include "profile.h"
+#include "render_tier.h"
+#include "settings.h"
+
 static Window *s_main_window;
 static Layer *s_canvas_layer;
+// Hands and border, redrawn only where they change
+static DisplayList *s_display;
 
 static GPoint s_center;
+// Bounds with the screen clear and under a full Quick View peek
+static GRect s_full_bounds;
+static GRect s_peek_bounds;
 static int s_radius;
-static int s_hour_hand_length = 70;
-static int s_minute_hand_length = 40;
-static int s_hover_hand_length = 20;
 static GColor s_background_color;
 static GColor s_hours_color;
 static GColor s_minutes_color;
 static GColor s_hours_overlay_color;
 static GColor s_minutes_overlay_color;
 static bool s_use_rect;
+static Settings s_settings;
 
-// Calculate the angle for hour hand (0 = 12 o'clock, clockwise)
-static int32_t get_hour_angle(struct tm *tick_time) {
-  // Convert to 24-hour based angle
-  // 0 hours = 0 degrees, 12 hours = 180 degrees, 24 hours = 360 degrees
-  int hour = tick_time->tm_hour;
-  if (hour >= 12) {
-    hour -= 12;
-  }
-  int minute = tick_time->tm_min;
-  
-  // Calculate precise angle including minutes
-  return TRIG_MAX_ANGLE / 12 * hour + (TRIG_MAX_ANGLE / 12) * minute / 60;
-}
+// What each render tier draws beyond the hands
+enum {
+  ElementHandOverlays = 1 << 0,
+  ElementBorder = 1 << 1,
+};
 
-// Calculate the angle for minute hand (0 = 12 o'clock, clockwise)
-static int32_t get_minute_angle(struct tm *tick_time) {
-  return TRIG_MAX_ANGLE * tick_time->tm_min / 60;
-}
+static const uint32_t s_tiers[RenderTierCount] = {
+  [RenderTierFull] = ElementHandOverlays | ElementBorder,
+  [RenderTierSaver] = 0,
+};
+
+static void update_overlay(bool full);
 
-// Load settings
+// Load settings, from the blob or the keys older versions used
 static void load_settings() {
-  s_use_rect = persist_exists(MESSAGE_KEY_USE_RECT) ? persist_read_bool(MESSAGE_KEY_USE_RECT) : false;
-  s_background_color = persist_exists(MESSAGE_KEY_BACKGROUND_COLOR) ? (GColor){ .argb = (uint8_t)persist_read_int(MESSAGE_KEY_BACKGROUND_COLOR) } : GColorWhite;
-  s_hours_color = persist_exists(MESSAGE_KEY_HOURS_COLOR) ? (GColor){ .argb = (uint8_t)persist_read_int(MESSAGE_KEY_HOURS_COLOR) } : GColorBlack;
-  s_minutes_color = persist_exists(MESSAGE_KEY_MINUTES_COLOR) ? (GColor){ .argb = (uint8_t)persist_read_int(MESSAGE_KEY_MINUTES_COLOR) } : GColorBlack;
-  s_hours_overlay_color = persist_exists(MESSAGE_KEY_HOURS_OVERLAY_COLOR) ? (GColor){ .argb = (uint8_t)persist_read_int(MESSAGE_KEY_HOURS_OVERLAY_COLOR) } : GColorMalachite;
-  s_minutes_overlay_color = persist_exists(MESSAGE_KEY_MINUTES_OVERLAY_COLOR) ? (GColor){ .argb = (uint8_t)persist_read_int(MESSAGE_KEY_MINUTES_OVERLAY_COLOR) } : GColorMalachite;
-}
+  s_use_rect = false;
+  s_background_color = GColorWhite;
+  s_hours_color = GColorBlack;
+  s_minutes_color = GColorBlack;
+  s_hours_overlay_color = GColorMalachite;
+  s_minutes_overlay_color = GColorMalachite;
 
-// Save settings
-static void save_settings() {
-  persist_write_bool(MESSAGE_KEY_USE_RECT, s_use_rect);
-  persist_write_int(MESSAGE_KEY_BACKGROUND_COLOR, s_background_color.argb);
-  persist_write_int(MESSAGE_KEY_HOURS_COLOR, s_hours_color.argb);
-  persist_write_int(MESSAGE_KEY_MINUTES_COLOR, s_minutes_color.argb);
-  persist_write_int(MESSAGE_KEY_HOURS_OVERLAY_COLOR, s_hours_overlay_color.argb);
-  persist_write_int(MESSAGE_KEY_MINUTES_OVERLAY_COLOR, s_minutes_overlay_color.argb);
+  settings_init(&s_settings, 1);
+  settings_add_bool(&s_settings, MESSAGE_KEY_USE_RECT, &s_use_rect);
+  settings_add_color(&s_settings, MESSAGE_KEY_BACKGROUND_COLOR, &s_background_color);
+  settings_add_color(&s_settings, MESSAGE_KEY_HOURS_COLOR, &s_hours_color);
+  settings_add_color(&s_settings, MESSAGE_KEY_MINUTES_COLOR, &s_minutes_color);
+  settings_add_color(&s_settings, MESSAGE_KEY_HOURS_OVERLAY_COLOR, &s_hours_overlay_color);
+  settings_add_color(&s_settings, MESSAGE_KEY_MINUTES_OVERLAY_COLOR, &s_minutes_overlay_color);
+  power_add_settings(&s_settings);
+  render_tier_add_settings(&s_settings);
+  settings_load(&s_settings);
 }
 
 // Inbox received callback
 static void inbox_received_callback(DictionaryIterator *iterator, void *context) {
-  Tuple *rect_tuple = dict_find(iterator, MESSAGE_KEY_USE_RECT);
-  bool changed = false;
-  
-  if (rect_tuple) {
-    s_use_rect = rect_tuple->value->int32 == 1;
-    changed = true;
-  }
-
-  Tuple *bgcolor_tuple = dict_find(iterator, MESSAGE_KEY_BACKGROUND_COLOR);
-  if (bgcolor_tuple) {
-    s_background_color = GColorFromHEX(bgcolor_tuple->value->int32);
-    changed = true;
-  }
-
-  Tuple *hourscolor_tuple = dict_find(iterator, MESSAGE_KEY_HOURS_COLOR);
-  if (hourscolor_tuple) {
-    s_hours_color = GColorFromHEX(hourscolor_tuple->value->int32);
-    changed = true;
-  }
-
-  Tuple *minutescolor_tuple = dict_find(iterator, MESSAGE_KEY_MINUTES_COLOR);
-  if (minutescolor_tuple) {
-    s_minutes_color = GColorFromHEX(minutescolor_tuple->value->int32);
-    changed = true;
-  }
-
-  Tuple *hoursoverlaycolor_tuple = dict_find(iterator, MESSAGE_KEY_HOURS_OVERLAY_COLOR);
-  if (hoursoverlaycolor_tuple) {
-    s_hours_overlay_color = GColorFromHEX(hoursoverlaycolor_tuple->value->int32);
-    changed = true;
-  }
-
-  Tuple *minutesoverlaycolor_tuple = dict_find(iterator, MESSAGE_KEY_MINUTES_OVERLAY_COLOR);
-  if (minutesoverlaycolor_tuple) {
-    s_minutes_overlay_color = GColorFromHEX(minutesoverlaycolor_tuple->value->int32);
-    changed = true;
-  } 
-
-  save_settings();
-
-  if (changed) {
-    layer_mark_dirty(s_canvas_layer);
+  profile_receive(iterator);
+  // The background may have changed too, so redraw everything
+  if (settings_apply(&s_settings, iterator)) {
+    power_settings_changed();
+    render_tier_settings_changed();
+    update_overlay(true);
   }
 }
 
+#ifdef PBL_BW
+// Only black and white displays draw the border in the reverse color
 static GColor reverse_color(GColor color) {
   // Simple inversion for black and white
   if (color.argb == GColorBlack.argb) {
@@ -109,115 +85,129 @@ static GColor reverse_color(GColor color) {
     return GColorBlack;
   }
 }
+#endif
 
-static void canvas_update_proc(Layer *layer, GContext *ctx) {
-  GRect bounds = layer_get_bounds(layer);
+// Point of a hand table for the current dial shape
+#define HAND_POINT(table, index) \
+  (s_use_rect ? LAYOUT_POINT(s_center, LAYOUT_RECT_##table[index]) : LAYOUT_POINT(s_center, LAYOUT_##table[index]))
+
+// Records the hands for the current time, and the border over their outer
+// ends
+static void update_overlay(bool full) {
+  // The part of the layer a peek leaves, shrinking with it
+  GRect bounds = s_full_bounds;
+  bounds.size.h = peek_lerp(s_full_bounds.size.h, s_peek_bounds.size.h);
   s_center = grect_center_point(&bounds);
 
-  if (s_use_rect) {
-    s_hour_hand_length = 40;
-    s_minute_hand_length = 20;
-  }
-  
-  // Calculate radius to fit in the display
-  s_radius = !s_use_rect ? ((bounds.size.w - 2) / 2) : ((bounds.size.h) / 2 + 40);
-  
-  time_t now = time(NULL);
-  struct tm *tick_time = localtime(&now);
-  
-  int32_t hour_angle = get_hour_angle(tick_time);
-  int32_t minute_angle = get_minute_angle(tick_time);
-  int hour = tick_time->tm_hour;
-  
-  // Fill the background white
-  graphics_context_set_fill_color(ctx, s_background_color);
-  graphics_fill_rect(ctx, bounds, 0, GCornerNone);
-  
-  // Draw hour hand (from border to center, starting at s_hour_hand_length from center)
-  graphics_context_set_stroke_color(ctx, s_hours_color);
-  graphics_context_set_stroke_width(ctx, 4);
-  
-  int32_t sin_hour_val = sin_lookup(hour_angle);
-  int32_t cos_hour_val = cos_lookup(hour_angle);
-  
-  // Calculate actual hand length as percentage of radius
-  int hour_hand_actual = s_radius * s_hour_hand_length / 100;
-  int hover_hand_actual = s_radius * s_hover_hand_length / 100;
-  
-  GPoint hour_start = (GPoint){
-    .x = s_center.x + (sin_hour_val * s_radius / TRIG_MAX_RATIO),
-    .y = s_center.y - (cos_hour_val * s_radius / TRIG_MAX_RATIO)
-  };
-  
-  GPoint hour_end = (GPoint){
-    .x = s_center.x + (sin_hour_val * hour_hand_actual / TRIG_MAX_RATIO),
-    .y = s_center.y - (cos_hour_val * hour_hand_actual / TRIG_MAX_RATIO)
-  };
-  
-  graphics_draw_line(ctx, hour_start, hour_end);
+  // Radius of the border circle; larger than the screen in rect mode
+  s_radius = !s_use_rect ? LAYOUT_RADIUS : LAYOUT_RECT_RADIUS;
   
-  // Draw white inner stroke for hour hand (from hour_end, 10px toward border)
-  graphics_context_set_stroke_color(ctx, s_hours_overlay_color);
-  graphics_context_set_stroke_width(ctx, 2);
+  struct tm now = face_clock_now();
+  struct tm *tick_time = &now;
   
-  GPoint hour_white_end = (GPoint){
-    .x = s_center.x + (sin_hour_val * (hour_hand_actual + hover_hand_actual) / TRIG_MAX_RATIO),
-    .y = s_center.y - (cos_hour_val * (hour_hand_actual + hover_hand_actual) / TRIG_MAX_RATIO)
-  };
-  
-  graphics_draw_line(ctx, hour_end, hour_white_end);
-  
-  // Draw minute hand (from border to center, starting at s_minute_hand_length from center)
-  graphics_context_set_stroke_color(ctx, s_minutes_color);
-  graphics_context_set_stroke_width(ctx, 4);
-  
-  int32_t sin_val = sin_lookup(minute_angle);
-  int32_t cos_val = cos_lookup(minute_angle);
-  
-  // Calculate actual hand length as percentage of radius
-  int minute_hand_actual = s_radius * s_minute_hand_length / 100;
-  
-  GPoint minute_start = (GPoint){
-    .x = s_center.x + (sin_val * s_radius / TRIG_MAX_RATIO),
-    .y = s_center.y - (cos_val * s_radius / TRIG_MAX_RATIO)
-  };
-  
-  GPoint minute_end = (GPoint){
-    .x = s_center.x + (sin_val * minute_hand_actual / TRIG_MAX_RATIO),
-    .y = s_center.y - (cos_val * minute_hand_actual / TRIG_MAX_RATIO)
-  };
+  // Hand points come from the tables in layout.auto.h, with an hour hand
+  // position for every minute of 12 hours
+  int hour_index = LAYOUT_HOUR_INDEX(tick_time);
+  int minute = tick_time->tm_min;
+
+  // Without a display list (out of memory at load) the dial goes without
+  // the parts it records
+  if (!s_display) {
+    layer_mark_dirty(s_canvas_layer);
+    return;
+  }
+
+  display_list_begin(s_display);
   
-  graphics_draw_line(ctx, minute_start, minute_end);
+  // Draw hour hand (from border to center, ending hour length from center)
+  GPoint hour_end = HAND_POINT(HOUR_END, hour_index);
+  display_list_draw_line(s_display, HAND_POINT(HOUR_START, hour_index), hour_end, 4, s_hours_color);
   
-  // Draw white inner stroke for minute hand (from minute_end, 10px toward border)
-  graphics_context_set_stroke_color(ctx, s_minutes_overlay_color);
-  graphics_context_set_stroke_width(ctx, 2);
+  // Draw white inner stroke for hour hand (from hour_end toward the border)
+  if (render_tier_draws(ElementHandOverlays)) {
+    display_list_draw_line(s_display, hour_end, HAND_POINT(HOUR_OVERLAY_END, hour_index), 2, s_hours_overlay_color);
+  }
   
-  GPoint minute_white_end = (GPoint){
-    .x = s_center.x + (sin_val * (minute_hand_actual + hover_hand_actual) / TRIG_MAX_RATIO),
-    .y = s_center.y - (cos_val * (minute_hand_actual + hover_hand_actual) / TRIG_MAX_RATIO)
-  };
+  // Draw minute hand (from border to center, ending minute length from center)
+  GPoint minute_end = HAND_POINT(MINUTE_END, minute);
+  display_list_draw_line(s_display, HAND_POINT(MINUTE_START, minute), minute_end, 4, s_minutes_color);
   
-  graphics_draw_line(ctx, minute_end, minute_white_end);
+  // Draw white inner stroke for minute hand (from minute_end toward the border)
+  if (render_tier_draws(ElementHandOverlays)) {
+    display_list_draw_line(s_display, minute_end, HAND_POINT(MINUTE_OVERLAY_END, minute), 2, s_minutes_overlay_color);
+  }
   
   // Draw border
-  graphics_context_set_stroke_color(ctx, PBL_IF_COLOR_ELSE(GColorLightGray, reverse_color(s_background_color)));
-  graphics_context_set_stroke_width(ctx, 2);
-  
-  if (!s_use_rect) {
+  GColor border_color = PBL_IF_COLOR_ELSE(GColorLightGray, reverse_color(s_background_color));
+  if (!render_tier_draws(ElementBorder)) {
+    // Left out at this tier
+  } else if (!s_use_rect) {
     // Round screen: draw circle border
-    graphics_draw_circle(ctx, s_center, s_radius);
+    display_list_draw_circle(s_display, s_center, s_radius, 2, border_color);
   } else {
-    // Rectangular screen: draw 2px border following screen edge
+    // Rectangular screen: draw 2px border following screen edge, or the
+    // peek's
     // Draw two rectangles to create a 2px border
-    graphics_draw_rect(ctx, GRect(0, 0, bounds.size.w, bounds.size.h));
-    graphics_draw_rect(ctx, GRect(1, 1, bounds.size.w - 2, bounds.size.h - 2));
+    display_list_draw_rect(s_display, GRect(0, 0, bounds.size.w, bounds.size.h), border_color);
+    display_list_draw_rect(s_display, GRect(1, 1, bounds.size.w - 2, bounds.size.h - 2), border_color);
   }
+
+  display_list_end(s_display, full);
+}
+
+// Only the background lies under the hands, so that is all there is to
+// restore before the display list redraws its regions. It goes straight
+// into the frame buffer, which a peek moving everything makes the whole
+// screen on every frame.
+static void canvas_update_proc(Layer *layer, GContext *ctx) {
+  instrument_stack_begin();
+  profile_frame_begin();
+
+  graphics_context_set_fill_color(ctx, s_background_color);
+  // Without a display list the background is all there is to draw
+  uint8_t num_regions = s_display ? display_list_get_num_regions(s_display) : 0;
+  if (!s_display) {
+    graphics_fill_rect(ctx, layer_get_bounds(layer), 0, GCornerNone);
+  }
+  for (uint8_t i = 0; i < num_regions; i++) {
+    GRect region = display_list_get_region(s_display, i);
+    BandShape background = { .type = BandShapeRect, .color = s_background_color, .rect = region };
+    if (!band_fill(ctx, &background, 1)) {
+      graphics_fill_rect(ctx, region, 0, GCornerNone);
+    }
+  }
+
+  profile_frame_end();
+  instrument_frame(true);
+  instrument_heap(InstrumentPointUpdateProc);
+  instrument_stack_end();
+}
+
+// The hands and border only move with the center and the bottom edge
+static void peek_layout(GRect bounds, GRect obstructed) {
+  s_full_bounds = bounds;
+  s_peek_bounds = obstructed;
+}
+
+static void peek_frame(void) {
+  update_overlay(false);
+}
+
+// Redraws everything for the tier the battery charge calls for
+static void render_tier_handler(RenderTier tier) {
+  update_overlay(true);
+}
+
+// Catches up at once on a tap while the power policy held back redraws
+static void power_wake_handler(void) {
+  update_overlay(false);
 }
 
 static void tick_handler(struct tm *tick_time, TimeUnits units_changed) {
-  // Redraw the canvas
-  layer_mark_dirty(s_canvas_layer);
+  if (power_tick(tick_time, units_changed)) {
+    update_overlay(false);
+  }
+  instrument_report();
 }
 
 static void main_window_load(Window *window) {
@@ -228,18 +218,32 @@ static void main_window_load(Window *window) {
   s_canvas_layer = layer_create(bounds);
   layer_set_update_proc(s_canvas_layer, canvas_update_proc);
   layer_add_child(window_layer, s_canvas_layer);
+
+  s_display = display_list_create(s_canvas_layer, 8);
+  peek_init(s_canvas_layer, peek_layout, peek_frame);
+  update_overlay(true);
+
+  instrument_heap(InstrumentPointWindowLoad);
 }
 
 static void main_window_unload(Window *window) {
+  peek_deinit();
+  display_list_destroy(s_display);
   layer_destroy(s_canvas_layer);
 }
 
 static void init() {
+  instrument_heap(InstrumentPointInit);
+
   // Load settings
   load_settings();
+  render_tier_init(s_tiers, render_tier_handler);
+  profile_init(&s_settings);
   
   // Create main window
   s_main_window = window_create();
+  // The frame buffer keeps the last frame; only changed regions are redrawn
+  window_set_background_color(s_main_window, GColorClear);
   window_set_window_handlers(s_main_window, (WindowHandlers) {
     .load = main_window_load,
     .unload = main_window_unload
@@ -248,18 +252,26 @@ static void init() {
   
   // Register with TickTimerService
   tick_timer_service_subscribe(MINUTE_UNIT, tick_handler);
+  power_init(power_wake_handler);
 
   // Register callbacks
-  app_message_register_inbox_received(inbox_received_callback);
-  app_message_open(128, 128);
+  face_open_messages(inbox_received_callback, settings_inbox_size(&s_settings), 128);
+  instrument_heap(InstrumentPointAppMessageOpen);
 }
 
 static void deinit(void) {
+  power_deinit();
+  render_tier_deinit();
+  tick_timer_service_unsubscribe();
   window_destroy(s_main_window);
 }
 
+#ifdef FACE_COLLECTION
+const Face face_hollow = { .name = "hollow", .init = init, .deinit = deinit };
+#else
 int main(void) {
   init();
   app_event_loop();
   deinit();
 }
+#endif
@@ -0,0 +1,42 @@
+#pragma once
+
+// Every face is compiled once per platform. The Makefile renames each
+// build's main() to host_main_<face>_<platform>, and the collection app's
+// to host_main_collection_<platform> for the platforms it targets. Eclipse
+// is built a second time as eclipse_trig, with MARKERS_PER_FRAME.
+
+#include "pebble_host.h"
+
+#define HOST_FACES(X) \
+  X(eclipse) \
+  X(trio) \
+  X(enough) \
+  X(binary) \
+  X(hollow)
+
+#define HOST_PLATFORMS(X, face) \
+  X(face, aplite) \
+  X(face, basalt) \
+  X(face, chalk) \
+  X(face, emery)
+
+#define HOST_DECLARE_MAIN(face, platform) int host_main_##face##_##platform(void);
+#define HOST_DECLARE_FACE(face) \
+  extern const HostFaceManifest host_manifest_##face; \
+  HOST_PLATFORMS(HOST_DECLARE_MAIN, face)
+
+HOST_FACES(HOST_DECLARE_FACE)
+HOST_PLATFORMS(HOST_DECLARE_MAIN, eclipse_trig)
+
+#define HOST_MAIN_ENTRY(face, platform) host_main_##face##_##platform,
+#define HOST_FACE_MAINS(face) { HOST_PLATFORMS(HOST_MAIN_ENTRY, face) }
+
+#define HOST_COLLECTION_PLATFORMS(X) \
+  X(basalt) \
+  X(chalk) \
+  X(emery)
+
+#define HOST_DECLARE_COLLECTION_MAIN(platform) int host_main_collection_##platform(void);
+
+extern const HostFaceManifest host_manifest_collection;
+HOST_COLLECTION_PLATFORMS(HOST_DECLARE_COLLECTION_MAIN)
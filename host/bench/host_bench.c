@@ -0,0 +1,1899 @@
+// Rendering benchmark for the watchfaces, run against the host shim.
+//
+// For every face, platform and setting combination the face is started from
+// scratch, configured through an inbox message like the Clay page would do,
+// and rendered at a fixed set of times. Each time is reached by a minute tick
+// from the minute before it, which is rendered first, so caches the face
+// keeps between frames are warm and only what that tick changed is redrawn,
+// as on every minute tick but the first. Reports wall time per frame on this
+// machine plus the primitive calls and pixels written per frame, which are
+// what the watch actually pays for, the face's peak heap use, the
+// allocations and heap growth of the measured frames, and the commands and
+// dirty area of the face's display list.
+//
+// With --sweep the face is instead ticked through every minute of a day and
+// a digest of all frames is printed, so two builds can be checked for
+// identical output.
+//
+// With --golden DIR each frame is compared pixel for pixel with the PNG of
+// the same name in DIR (host/golden in make check), as a frame reached by a
+// minute tick after the minute before it, which redraws only what changed.
+// A face fails on any pixel that differs or any frame that has no PNG.
+// With --update the frames are written to DIR instead, for a change that
+// means to alter them; the diff of the PNGs is then part of the review.
+//
+// With --ticks the face is ticked through every minute of a day as well, and
+// the pixels written per frame are reported separately for the ticks that
+// change the hour and for the ones that change only the minute, along with
+// how many times the screen's area is the latter.
+//
+// With --day the face is ticked through every minute of a day too, and each
+// minute's frame is timed, the least of DAY_REPEATS, and its pixels counted.
+// The day's total and the worst minute are reported, with the slowest
+// DAY_SLOWEST minutes and whether each changed the hour or put the minute
+// hand on a quadrant boundary, where the faces' code branches.
+//
+// With --power each face plays a day of its wearer with its default
+// settings, once per power policy (common/src/c/power.h), and the frames
+// and pixels drawn are reported along with the minutes the face says it
+// spent in each mode.
+//
+// With --peek the face plays a Timeline Quick View peek coming in and going
+// away again, PEEK_FRAMES frames each way, and the time and pixels of its
+// frames are reported. It fails a face that writes more than
+// PEEK_BUDGET_PERCENT of the pixels of its first frame, when it drew
+// everything, in a frame while the peek moves, or more than that first frame
+// (PEEK_SETTLE_SLACK aside) in the frame it settles on, allocates during the
+// animation, stays as it was under the peek, or doesn't end up where it
+// started, or where a face started under the peek is. The budget stands in
+// for the 33 ms a frame has at 30 fps on the watch, which host time says
+// little about: a face that moves what it already drew rather than drawing
+// it again holds 30 fps with room to spare, and solving the layout again
+// would show as time, not pixels.
+//
+// --tiers runs any of the above once per render tier
+// (common/src/c/render_tier.h), with the battery at full charge and then
+// below the faces' default saver threshold, and tags each label with the
+// tier.
+//
+// With --instrument the face is ticked through the same times and the heap,
+// stack and launch figures it sends are printed; this needs the faces built
+// with INSTRUMENTATION (make INSTRUMENT=1).
+//
+// With --profile the face is ticked through the same times and rendered as
+// for timing, then asked for its frame time statistics the way the phone
+// does; this needs the faces built with PROFILING (make PROFILE=1). Host
+// frames mostly take under the millisecond the watch's clock counts in, so
+// what this shows is that every frame drawn was counted.
+//
+// --numerals times each PDC numeral of the faces that have them drawn from
+// its draw commands against copied back from a NumeralCache, and checks that
+// both give the same pixels.
+//
+// --collection starts each face on its own and the collection app
+// (collection/) on that face, and switches the collection to it from the
+// face before it, with default settings. It reports the least time over
+// --iterations of each to the first frame, and the heap peak. It fails a
+// face whose frame in the collection differs from its own, or whose start or
+// switch in the collection takes longer than starting it on its own, but for
+// COLLECTION_SLACK: the collection does its own start on top of the face's,
+// and the least of host times still moves by a few percent from run to run.
+//
+// --launch starts each face at 10:08 with default settings and times its
+// launch, the least over --iterations: to the end of the first frame, drawn
+// with the face's app timers held as on the watch, and to the end of the
+// frame the timers then dirty, which has everything. It also reports the
+// pixels of both frames, and fails a face whose complete frame differs from
+// that of a launch that never held the timers.
+//
+// --lines draws a hand of each width the faces use at every minute, from
+// the center and from off screen in, with graphics_draw_line() and with
+// thick_line_draw() (common/src/c/thick_line.h) with round and flat caps and
+// antialiased. It reports the time per line and the pixels written, and
+// fails a hand whose round-capped pixels differ from the SDK's.
+//
+// --bands paints Eclipse's bezel, circles and rounded rects, at full height
+// and under a peek, through the SDK shape after shape and with band_fill()
+// (common/src/c/band_fill.h). It reports the time and the pixels written by
+// each, and fails a bezel whose pixels differ.
+//
+// --spans times span_fill() (common/src/c/span_fill.h) against the byte
+// at a time runs it replaced, on 8-bit and 1-bit rows, over runs of several
+// lengths at each of the four byte alignments. --check-spans checks it,
+// pixel for pixel, on every run of a row (host/bench/span_check.h).
+//
+// --check-settings configures every face once through an inbox message and
+// once through the per-key values older builds persisted, and checks that
+// both render the same, that the old keys are migrated away, and that a
+// message costs one persist write, or none if it changes nothing. It then
+// sends versioned messages as the configuration pages do, and checks which
+// the face applies, skips or refuses and the version it answers with.
+//
+// --check-markers ticks Eclipse in rect mode through twelve hours, which put
+// its minute marker at each of 60 angles and its hour marker at each of 720,
+// full screen and settled under a Quick View peek, in every render tier. It
+// runs the face as built and a build with MARKERS_PER_FRAME, which computes
+// every marker with the trig the tables replaced, and fails a minute whose
+// frames differ, or a face that didn't allocate its tables.
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include <pebble.h>
+
+#include "band_fill.h"
+#include "faces.h"
+#include "host_png.h"
+#include "instrument.h"
+#include "layout_check.h"
+#include "numeral_cache.h"
+#include "profile.h"
+#include "pebble_host.h"
+#include "power.h"
+#include "render_tier.h"
+#include "settings.h"
+#include "span_check.h"
+#include "span_fill.h"
+#include "thick_line.h"
+
+#define MAX_SETTINGS 4
+#define MAX_VALUES 4
+
+typedef struct {
+  const char *key;
+  const char *label;
+  int num_values;
+  int32_t values[MAX_VALUES];
+  bool hex;
+} BenchSetting;
+
+typedef struct {
+  const char *name;
+  const HostFaceManifest *manifest;
+  HostFaceMain mains[HostPlatformCount];
+  BenchSetting settings[MAX_SETTINGS];
+} BenchFace;
+
+static const BenchFace s_faces[] = {
+  {
+    .name = "eclipse",
+    .manifest = &host_manifest_eclipse,
+    .mains = HOST_FACE_MAINS(eclipse),
+    .settings = {
+      { .key = "INVERT_COLORS", .label = "invert", .num_values = 2, .values = { 0, 1 } },
+      { .key = "USE_SQUARE", .label = "square", .num_values = 2, .values = { 0, 1 } },
+      { .key = "HOURS_COLOR", .label = "hours", .num_values = 2, .values = { 0xFFFFFF, 0xFF5500 }, .hex = true },
+    },
+  },
+  {
+    .name = "trio",
+    .manifest = &host_manifest_trio,
+    .mains = HOST_FACE_MAINS(trio),
+    .settings = {
+      { .key = "INVERT_COLORS", .label = "invert", .num_values = 2, .values = { 0, 1 } },
+    },
+  },
+  {
+    .name = "enough",
+    .manifest = &host_manifest_enough,
+    .mains = HOST_FACE_MAINS(enough),
+    .settings = {
+      { .key = "INVERT_COLORS", .label = "invert", .num_values = 2, .values = { 0, 1 } },
+    },
+  },
+  {
+    .name = "binary",
+    .manifest = &host_manifest_binary,
+    .mains = HOST_FACE_MAINS(binary),
+    .settings = {
+      { .key = "USE_RECT", .label = "rect", .num_values = 2, .values = { 0, 1 } },
+      { .key = "BACKGROUND_COLOR", .label = "bg", .num_values = 2, .values = { 0xFFFFFF, 0x000000 }, .hex = true },
+    },
+  },
+  {
+    .name = "hollow",
+    .manifest = &host_manifest_hollow,
+    .mains = HOST_FACE_MAINS(hollow),
+    .settings = {
+      { .key = "USE_RECT", .label = "rect", .num_values = 2, .values = { 0, 1 } },
+      { .key = "BACKGROUND_COLOR", .label = "bg", .num_values = 2, .values = { 0xFFFFFF, 0x000000 }, .hex = true },
+    },
+  },
+};
+
+#define NUM_FACES (sizeof(s_faces) / sizeof(s_faces[0]))
+
+// Times rendered for each combination: both halves of the day, hands in
+// every quadrant
+static const int s_times[][2] = {
+  { 3, 0 },
+  { 10, 8 },
+  { 16, 42 },
+  { 21, 37 },
+};
+
+#define NUM_TIMES (sizeof(s_times) / sizeof(s_times[0]))
+
+// Battery charge that puts the faces' default settings at each tier
+static const uint8_t s_tier_charge[RenderTierCount] = {
+  [RenderTierFull] = 100,
+  [RenderTierSaver] = RENDER_TIER_DEFAULT_THRESHOLD / 2,
+};
+
+typedef struct {
+  const char *face_filter;
+  const char *platform_filter;
+  int iterations;
+  bool csv;
+  const char *dump_dir;
+  const char *golden_dir;
+  bool update;
+  bool sweep;
+  bool instrument;
+  bool profile;
+  bool ticks;
+  bool day;
+  bool power;
+  bool tiers;
+  bool peek;
+} BenchOptions;
+
+// Timed renders of each minute for --day, and how many of the slowest are
+// listed
+#define DAY_REPEATS 5
+#define DAY_SLOWEST 3
+
+typedef struct {
+  const BenchFace *face;
+  HostPlatform platform;
+  const int32_t *values;
+  const BenchOptions *options;
+  RenderTier tier;
+  char label[128];
+  // Results
+  uint64_t ns_per_frame;
+  HostFrameStats per_frame;
+  HostDisplayListStats display;
+  size_t heap_peak;
+  uint64_t digest;
+  // Pixels written per hour tick and per minute tick, for --ticks
+  uint64_t hour_pixels;
+  uint64_t minute_pixels;
+  // For --day: the time and pixels of the day's frames, the worst minute of
+  // each, and the slowest minutes, slowest first
+  uint64_t day_ns;
+  uint64_t day_pixels;
+  uint64_t day_worst_ns;
+  uint64_t day_worst_pixels;
+  uint16_t day_worst_pixels_minute;
+  uint16_t day_slowest[DAY_SLOWEST];
+  // For --power: the policy played, the frames and pixels drawn, and the
+  // face's last report
+  uint8_t power_policy;
+  uint32_t power_frames;
+  uint64_t power_pixels;
+  bool has_power_report;
+  PowerReport power_report;
+  bool has_summary;
+  InstrumentSummary summary;
+  // For --golden: the frames compared, and what the first one that failed
+  // got wrong
+  uint32_t golden_frames;
+  char golden_failure[64];
+  // For --profile: the frames rendered, and the face's statistics for its
+  // first slot
+  uint32_t profile_renders;
+  bool has_profile;
+  ProfileSlotStats profile;
+  // For --peek: the pixels of the first frame and the budget for the moving
+  // frames, the animation frames, their mean time, the most pixels in a
+  // moving frame and in a settling one, the most allocations in any, and
+  // the frames before, under and after the peek, and of a face started
+  // under it
+  uint64_t peek_first_pixels;
+  uint64_t peek_budget;
+  uint32_t peek_frames;
+  uint64_t peek_ns;
+  uint64_t peek_max_pixels;
+  uint64_t peek_settle_pixels;
+  uint32_t peek_allocations;
+  uint64_t peek_digests[3];
+  uint64_t peek_start_digest;
+} BenchJob;
+
+static uint64_t prv_now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static time_t prv_time_of_day(int hour, int minute) {
+  // 2026-01-01 00:00 UTC
+  return (time_t)1767225600 + hour * 3600 + minute * 60;
+}
+
+static void prv_send_settings(const BenchJob *job) {
+  uint32_t keys[MAX_SETTINGS];
+  int count = 0;
+  for (int i = 0; i < MAX_SETTINGS && job->face->settings[i].key; i++) {
+    keys[count] = host_manifest_message_key(job->face->manifest, job->face->settings[i].key);
+    count++;
+  }
+  host_send_message(keys, job->values, count);
+}
+
+// Where the frame of a job at one of s_times goes in dir
+static void prv_frame_path(const BenchJob *job, const char *dir, int time_index, char *path, size_t size) {
+  const HostPlatformInfo *info = host_platform_info(job->platform);
+  snprintf(path, size, "%s/%s-%s-%s-%02d%02d.png", dir, job->face->name, info->name, job->label,
+           s_times[time_index][0], s_times[time_index][1]);
+  for (char *c = path + strlen(dir) + 1; *c; c++) {
+    if (*c == ',' || *c == '=') {
+      *c = '_';
+    }
+  }
+}
+
+static void prv_dump_png(const BenchJob *job, int time_index) {
+  const HostPlatformInfo *info = host_platform_info(job->platform);
+  char path[512];
+  prv_frame_path(job, job->options->dump_dir, time_index, path, sizeof(path));
+  if (!host_png_write_framebuffer(path, info->width, info->height)) {
+    fprintf(stderr, "cannot write %s: %s\n", path, strerror(errno));
+  }
+}
+
+// Runs inside the face's app_event_loop()
+static void prv_bench_loop(void *context) {
+  BenchJob *job = context;
+  prv_send_settings(job);
+
+  HostFrameStats total = { 0 };
+  HostDisplayListStats display = { 0 };
+  uint64_t elapsed = 0;
+  for (size_t t = 0; t < NUM_TIMES; t++) {
+    time_t now = prv_time_of_day(s_times[t][0], s_times[t][1]);
+    host_set_time(now - 60);
+    host_tick(MINUTE_UNIT | HOUR_UNIT);
+    host_render(true);
+
+    host_set_time(now);
+    host_tick(s_times[t][1] ? MINUTE_UNIT : MINUTE_UNIT | HOUR_UNIT);
+    const HostDisplayListStats *list = host_display_list_stats();
+    display.commands += list->commands;
+    display.dirty_pixels += list->dirty_pixels;
+
+    // A forced render redraws the same regions as the tick's own frame
+    host_set_accounting(true);
+    host_stats_reset();
+    host_render(true);
+    host_set_accounting(false);
+    const HostFrameStats *stats = host_stats();
+    for (int p = 0; p < HostPrimCount; p++) {
+      total.prims[p] += stats->prims[p];
+    }
+    total.pixels += stats->pixels;
+    total.direct_pixels += stats->direct_pixels;
+    // Any allocation in a steady-state frame is a leak or churn; keep the worst
+    if (stats->allocations > total.allocations) {
+      total.allocations = stats->allocations;
+    }
+    if (stats->heap_high_water > total.heap_high_water) {
+      total.heap_high_water = stats->heap_high_water;
+    }
+    if (job->options->dump_dir) {
+      prv_dump_png(job, (int)t);
+    }
+
+    uint64_t start = prv_now_ns();
+    for (int i = 0; i < job->options->iterations; i++) {
+      host_render(true);
+    }
+    elapsed += prv_now_ns() - start;
+  }
+
+  job->ns_per_frame = elapsed / (NUM_TIMES * (uint64_t)job->options->iterations);
+  for (int p = 0; p < HostPrimCount; p++) {
+    job->per_frame.prims[p] = (total.prims[p] + NUM_TIMES / 2) / NUM_TIMES;
+  }
+  job->per_frame.pixels = (total.pixels + NUM_TIMES / 2) / NUM_TIMES;
+  job->per_frame.direct_pixels = (total.direct_pixels + NUM_TIMES / 2) / NUM_TIMES;
+  job->per_frame.allocations = total.allocations;
+  job->per_frame.heap_high_water = total.heap_high_water;
+  job->heap_peak = host_heap_peak();
+  job->display.commands = (display.commands + NUM_TIMES / 2) / NUM_TIMES;
+  job->display.dirty_pixels = (display.dirty_pixels + NUM_TIMES / 2) / NUM_TIMES;
+}
+
+// Runs inside the face's app_event_loop() for --sweep
+static void prv_sweep_loop(void *context) {
+  BenchJob *job = context;
+  prv_send_settings(job);
+
+  uint64_t digest = 0;
+  for (int minute = 0; minute < 24 * 60; minute++) {
+    host_set_time(prv_time_of_day(minute / 60, minute % 60));
+    host_tick(minute % 60 ? MINUTE_UNIT : MINUTE_UNIT | HOUR_UNIT);
+    host_render(false);
+    digest = digest * 31 + host_framebuffer_digest();
+  }
+  job->digest = digest;
+}
+
+// Runs inside the face's app_event_loop() for --ticks
+static void prv_ticks_loop(void *context) {
+  BenchJob *job = context;
+  prv_send_settings(job);
+  host_set_time(prv_time_of_day(23, 59));
+  host_tick(MINUTE_UNIT | HOUR_UNIT);
+  host_render(false);
+
+  uint64_t pixels[2] = { 0 };
+  host_set_accounting(true);
+  for (int minute = 0; minute < 24 * 60; minute++) {
+    bool hour = minute % 60 == 0;
+    host_set_time(prv_time_of_day(minute / 60, minute % 60));
+    host_tick(hour ? MINUTE_UNIT | HOUR_UNIT : MINUTE_UNIT);
+    host_stats_reset();
+    host_render(false);
+    pixels[hour] += host_stats()->pixels + host_stats()->direct_pixels;
+  }
+  host_set_accounting(false);
+  job->minute_pixels = (pixels[0] + 24 * 59 / 2) / (24 * 59);
+  job->hour_pixels = (pixels[1] + 12) / 24;
+}
+
+// Runs inside the face's app_event_loop() for --day
+static void prv_day_loop(void *context) {
+  BenchJob *job = context;
+  prv_send_settings(job);
+  host_set_time(prv_time_of_day(23, 59));
+  host_tick(MINUTE_UNIT | HOUR_UNIT);
+  host_render(false);
+
+  static uint64_t minute_ns[24 * 60];
+  for (int minute = 0; minute < 24 * 60; minute++) {
+    host_set_time(prv_time_of_day(minute / 60, minute % 60));
+    host_tick(minute % 60 ? MINUTE_UNIT : MINUTE_UNIT | HOUR_UNIT);
+    host_set_accounting(true);
+    host_stats_reset();
+    host_render(false);
+    host_set_accounting(false);
+    uint64_t pixels = host_stats()->pixels + host_stats()->direct_pixels;
+    job->day_pixels += pixels;
+    if (pixels > job->day_worst_pixels) {
+      job->day_worst_pixels = pixels;
+      job->day_worst_pixels_minute = minute;
+    }
+
+    // A forced render redraws the same regions as the tick's own frame
+    uint64_t least = UINT64_MAX;
+    for (int i = 0; i < DAY_REPEATS; i++) {
+      uint64_t start = prv_now_ns();
+      host_render(true);
+      uint64_t ns = prv_now_ns() - start;
+      if (ns < least) {
+        least = ns;
+      }
+    }
+    minute_ns[minute] = least;
+    job->day_ns += least;
+  }
+
+  for (int k = 0; k < DAY_SLOWEST; k++) {
+    int slowest = -1;
+    for (int minute = 0; minute < 24 * 60; minute++) {
+      bool listed = false;
+      for (int j = 0; j < k; j++) {
+        listed = listed || job->day_slowest[j] == minute;
+      }
+      if (!listed && (slowest < 0 || minute_ns[minute] > minute_ns[slowest])) {
+        slowest = minute;
+      }
+    }
+    job->day_slowest[k] = slowest;
+  }
+  job->day_worst_ns = minute_ns[job->day_slowest[0]];
+}
+
+// Renders whatever the last event marked dirty, for --power
+static void prv_power_render(BenchJob *job) {
+  host_stats_reset();
+  if (host_render(false)) {
+    job->power_frames++;
+    job->power_pixels += host_stats()->pixels + host_stats()->direct_pixels;
+  }
+}
+
+// Runs inside the face's app_event_loop() for --power. The wearer sleeps
+// until 7:00 and from 23:00, leaves the watch on a desk from 12:00 to 14:00,
+// and taps it to see the time at 3:12 and 12:40.
+static void prv_power_loop(void *context) {
+  BenchJob *job = context;
+  prv_send_settings(job);
+  uint32_t keys[2] = {
+    host_manifest_message_key(job->face->manifest, "POWER_POLICY"),
+    host_manifest_message_key(job->face->manifest, "POWER_INTERVAL"),
+  };
+  int32_t values[2] = { job->power_policy, POWER_DEFAULT_INTERVAL };
+  host_send_message(keys, values, 2);
+  host_render(false);
+
+  host_set_accounting(true);
+  for (int minute = 0; minute < 24 * 60; minute++) {
+    int hour = minute / 60;
+    bool asleep = hour < 7 || hour >= 23;
+    bool on_desk = hour >= 12 && hour < 14;
+    host_set_activities(asleep ? HealthActivitySleep : HealthActivityNone);
+    if (asleep) {
+      // Lying still on the wrist, bar sensor noise
+      host_set_accel(minute % 3 * 8, 0, -1000);
+    } else if (!on_desk) {
+      host_set_accel(minute * 37 % 400 - 200, minute * 53 % 600 - 300, -800);
+    }
+    host_set_time(prv_time_of_day(hour, minute % 60));
+    host_tick(minute % 60 ? MINUTE_UNIT : MINUTE_UNIT | HOUR_UNIT);
+    prv_power_render(job);
+    if (minute == 3 * 60 + 12 || minute == 12 * 60 + 40) {
+      host_tap();
+      prv_power_render(job);
+    }
+  }
+  host_set_accounting(false);
+
+  // A last tap sends the minutes of the day if the face is idle
+  host_tap();
+  uint16_t length;
+  const uint8_t *data = host_sent_data(host_manifest_message_key(job->face->manifest, "POWER_REPORT"), &length);
+  if (data && length == sizeof(job->power_report)) {
+    memcpy(&job->power_report, data, sizeof(job->power_report));
+    job->has_power_report = true;
+  }
+}
+
+// Animation frames of a peek coming in or going away, at 30 fps
+#define PEEK_FRAMES 8
+// Percent of the first frame a frame may write while the peek moves
+#define PEEK_BUDGET_PERCENT 50
+// Percent over the first frame the frame the peek settles on may write, when
+// the face draws its layout for good; hands drawn at a center between two
+// pixels cover a few more of them
+#define PEEK_SETTLE_SLACK 1
+
+enum {
+  PeekBefore,
+  PeekCovered,
+  PeekAfter,
+};
+
+// Plays one peek animation towards covering rows. With accounting on the
+// pixels and allocations of its frames are kept, otherwise their time.
+static void prv_peek_animate(BenchJob *job, uint16_t rows, bool accounting) {
+  host_set_accounting(accounting);
+  host_peek_begin(rows);
+  for (int frame = 0; frame <= PEEK_FRAMES; frame++) {
+    if (frame < PEEK_FRAMES) {
+      host_peek_step(ANIMATION_NORMALIZED_MAX * (frame + 1) / PEEK_FRAMES);
+    } else {
+      host_peek_end();
+    }
+    host_stats_reset();
+    uint64_t start = prv_now_ns();
+    if (!host_render(false)) {
+      continue;
+    }
+    if (!accounting) {
+      job->peek_ns += prv_now_ns() - start;
+      job->peek_frames++;
+      continue;
+    }
+    const HostFrameStats *stats = host_stats();
+    uint64_t *max_pixels = frame < PEEK_FRAMES ? &job->peek_max_pixels : &job->peek_settle_pixels;
+    if (stats->pixels + stats->direct_pixels > *max_pixels) {
+      *max_pixels = stats->pixels + stats->direct_pixels;
+    }
+    if (stats->allocations > job->peek_allocations) {
+      job->peek_allocations = stats->allocations;
+    }
+  }
+  host_set_accounting(false);
+}
+
+// Runs inside the face's app_event_loop() for --peek
+static void prv_peek_loop(void *context) {
+  BenchJob *job = context;
+  uint16_t rows = host_platform_info(job->platform)->peek_height;
+  host_set_time(prv_time_of_day(10, 8));
+  host_tick(MINUTE_UNIT | HOUR_UNIT);
+  prv_send_settings(job);
+  host_set_accounting(true);
+  host_stats_reset();
+  host_render(false);
+  host_set_accounting(false);
+  job->peek_first_pixels = host_stats()->pixels + host_stats()->direct_pixels;
+  job->peek_budget = job->peek_first_pixels * PEEK_BUDGET_PERCENT / 100;
+  job->peek_digests[PeekBefore] = host_framebuffer_digest();
+
+  prv_peek_animate(job, rows, true);
+  job->peek_digests[PeekCovered] = host_framebuffer_digest();
+  prv_peek_animate(job, 0, true);
+  job->peek_digests[PeekAfter] = host_framebuffer_digest();
+
+  // Again for the time, now that any caches are warm
+  prv_peek_animate(job, rows, false);
+  prv_peek_animate(job, 0, false);
+  if (job->peek_frames) {
+    job->peek_ns /= job->peek_frames;
+  }
+}
+
+// Runs inside the face's app_event_loop() for --peek, with the face started
+// under the peek
+static void prv_peek_start_loop(void *context) {
+  BenchJob *job = context;
+  host_set_time(prv_time_of_day(10, 8));
+  host_tick(MINUTE_UNIT | HOUR_UNIT);
+  prv_send_settings(job);
+  host_render(false);
+  job->peek_start_digest = host_framebuffer_digest();
+}
+
+// What --peek finds wrong with a job, or NULL
+static const char *prv_peek_failure(const BenchJob *job) {
+  if (job->peek_max_pixels > job->peek_budget) {
+    return "over budget";
+  }
+  if (job->peek_settle_pixels > job->peek_first_pixels + job->peek_first_pixels * PEEK_SETTLE_SLACK / 100) {
+    return "settles over the first frame";
+  }
+  if (job->peek_allocations) {
+    return "allocates";
+  }
+  if (job->peek_digests[PeekCovered] == job->peek_digests[PeekBefore]) {
+    return "ignores the peek";
+  }
+  if (job->peek_digests[PeekAfter] != job->peek_digests[PeekBefore]) {
+    return "not restored";
+  }
+  if (job->peek_digests[PeekCovered] != job->peek_start_digest) {
+    return "differs from a start under the peek";
+  }
+  return NULL;
+}
+
+// Runs inside the face's app_event_loop() for --instrument
+static void prv_instrument_loop(void *context) {
+  BenchJob *job = context;
+  prv_send_settings(job);
+  for (size_t t = 0; t < NUM_TIMES; t++) {
+    host_set_time(prv_time_of_day(s_times[t][0], s_times[t][1]));
+    host_tick(MINUTE_UNIT | HOUR_UNIT);
+    host_render(false);
+  }
+  // Faces report from the tick handler, after the frame before it
+  host_tick(MINUTE_UNIT);
+
+  uint16_t length;
+  const uint8_t *data = host_sent_data(host_manifest_message_key(job->face->manifest, "INSTRUMENTATION"), &length);
+  if (data && length == sizeof(job->summary)) {
+    memcpy(&job->summary, data, sizeof(job->summary));
+    job->has_summary = true;
+  }
+}
+
+// Runs inside the face's app_event_loop() for --golden
+static void prv_golden_loop(void *context) {
+  BenchJob *job = context;
+  const HostPlatformInfo *info = host_platform_info(job->platform);
+  prv_send_settings(job);
+  for (size_t t = 0; t < NUM_TIMES; t++) {
+    time_t now = prv_time_of_day(s_times[t][0], s_times[t][1]);
+    host_set_time(now - 60);
+    host_tick(MINUTE_UNIT | HOUR_UNIT);
+    host_render(false);
+    host_set_time(now);
+    host_tick(s_times[t][1] ? MINUTE_UNIT : MINUTE_UNIT | HOUR_UNIT);
+    host_render(false);
+    if (job->options->dump_dir) {
+      prv_dump_png(job, (int)t);
+    }
+
+    char path[512];
+    prv_frame_path(job, job->options->golden_dir, (int)t, path, sizeof(path));
+    if (job->options->update) {
+      if (!host_png_write_framebuffer(path, info->width, info->height)) {
+        fprintf(stderr, "cannot write %s: %s\n", path, strerror(errno));
+      }
+      job->golden_frames++;
+      continue;
+    }
+    int x, y;
+    int diff = host_png_diff_framebuffer(path, info->width, info->height, &x, &y);
+    job->golden_frames++;
+    if (diff && !job->golden_failure[0]) {
+      if (diff < 0) {
+        snprintf(job->golden_failure, sizeof(job->golden_failure), "%02d:%02d has no golden image",
+                 s_times[t][0], s_times[t][1]);
+      } else {
+        snprintf(job->golden_failure, sizeof(job->golden_failure), "%02d:%02d differs in %d pixels from (%d,%d)",
+                 s_times[t][0], s_times[t][1], diff, x, y);
+      }
+    }
+  }
+}
+
+// Runs inside the face's app_event_loop() for --profile
+static void prv_profile_loop(void *context) {
+  BenchJob *job = context;
+  prv_send_settings(job);
+  for (size_t t = 0; t < NUM_TIMES; t++) {
+    host_set_time(prv_time_of_day(s_times[t][0], s_times[t][1]));
+    host_tick(MINUTE_UNIT | HOUR_UNIT);
+    job->profile_renders += host_render(false) ? 1 : 0;
+    for (int i = 0; i < job->options->iterations; i++) {
+      job->profile_renders += host_render(true) ? 1 : 0;
+    }
+  }
+
+  uint32_t key = host_manifest_message_key(job->face->manifest, "PROFILE_REQUEST");
+  int32_t index = 0;
+  host_send_message(&key, &index, 1);
+  uint16_t length;
+  const uint8_t *data = host_sent_data(host_manifest_message_key(job->face->manifest, "PROFILE_STATS"), &length);
+  if (data && length == sizeof(job->profile)) {
+    memcpy(&job->profile, data, sizeof(job->profile));
+    job->has_profile = true;
+  }
+}
+
+// The versioned messages --check-settings sends after the plain ones, as the
+// configuration pages would: every key, the same again, changes on top of a
+// version the face doesn't have, then on top of the one it has
+typedef struct {
+  const char *name;
+  int32_t version;
+  // 0 for none
+  int32_t base;
+  bool all_keys;
+  // What the face should answer and write for it
+  int32_t ack;
+  uint32_t writes;
+} VersionedMessage;
+
+static const VersionedMessage s_versioned[] = {
+  { "every key", 1000, 0, true, 1000, 1 },
+  { "the same again", 1000, 0, true, 1000, 0 },
+  { "a stale delta", 1001, 999, false, 1000, 0 },
+  { "a delta", 1001, 1000, false, 1001, 1 },
+};
+
+#define NUM_VERSIONED (sizeof(s_versioned) / sizeof(s_versioned[0]))
+
+typedef struct {
+  BenchJob job;
+  bool send;
+  // Persist writes for the settings message, and for the same one again
+  uint32_t writes[2];
+  // Persist writes for each of s_versioned and the version it was answered
+  // with, or -1
+  uint32_t versioned_writes[NUM_VERSIONED];
+  int32_t acks[NUM_VERSIONED];
+  uint64_t digest;
+} SettingsCheck;
+
+// Sends s_versioned[index]: every setting the job has, or only the first,
+// set to its default as the change
+static void prv_send_versioned(SettingsCheck *check, size_t index) {
+  const VersionedMessage *message = &s_versioned[index];
+  const BenchFace *face = check->job.face;
+  uint32_t keys[MAX_SETTINGS + 2];
+  int32_t values[MAX_SETTINGS + 2];
+  int count = 0;
+  for (int i = 0; i < MAX_SETTINGS && face->settings[i].key && (message->all_keys || !i); i++) {
+    keys[count] = host_manifest_message_key(face->manifest, face->settings[i].key);
+    values[count] = message->all_keys ? check->job.values[i] : face->settings[i].values[0];
+    count++;
+  }
+  keys[count] = host_manifest_message_key(face->manifest, "SETTINGS_VERSION");
+  values[count++] = message->version;
+  if (message->base) {
+    keys[count] = host_manifest_message_key(face->manifest, "SETTINGS_BASE");
+    values[count++] = message->base;
+  }
+  uint32_t before = host_persist_writes();
+  host_send_message(keys, values, count);
+  check->versioned_writes[index] = host_persist_writes() - before;
+  uint16_t length;
+  const uint8_t *ack = host_sent_data(keys[count - (message->base ? 2 : 1)], &length);
+  check->acks[index] = -1;
+  if (ack && length == sizeof(int32_t)) {
+    memcpy(&check->acks[index], ack, sizeof(int32_t));
+  }
+}
+
+// Runs inside the face's app_event_loop() for --check-settings
+static void prv_settings_check_loop(void *context) {
+  SettingsCheck *check = context;
+  host_set_time(prv_time_of_day(10, 8));
+  if (check->send) {
+    for (int i = 0; i < 2; i++) {
+      uint32_t before = host_persist_writes();
+      prv_send_settings(&check->job);
+      check->writes[i] = host_persist_writes() - before;
+    }
+  }
+  host_render(true);
+  check->digest = host_framebuffer_digest();
+  if (check->send) {
+    for (size_t i = 0; i < NUM_VERSIONED; i++) {
+      prv_send_versioned(check, i);
+    }
+  }
+}
+
+// Persists values under their message keys, as builds before the settings
+// blob did
+static void prv_write_legacy_settings(const BenchFace *face, const int32_t *values) {
+  for (int i = 0; i < MAX_SETTINGS && face->settings[i].key; i++) {
+    uint32_t key = host_manifest_message_key(face->manifest, face->settings[i].key);
+    if (face->settings[i].hex) {
+      persist_write_int(key, GColorFromHEX(values[i]).argb);
+    } else {
+      persist_write_bool(key, values[i] != 0);
+    }
+  }
+}
+
+static int prv_check_settings(void) {
+  int runs = 0;
+  int failures = 0;
+  for (size_t f = 0; f < NUM_FACES; f++) {
+    const BenchFace *face = &s_faces[f];
+    // The last value of every setting, none of which is a default
+    int32_t values[MAX_SETTINGS];
+    for (int i = 0; i < MAX_SETTINGS && face->settings[i].key; i++) {
+      values[i] = face->settings[i].values[face->settings[i].num_values - 1];
+    }
+
+    for (int p = 0; p < HostPlatformCount; p++) {
+      const char *platform = host_platform_info(p)->name;
+      SettingsCheck sent = { .job = { .face = face, .platform = p, .values = values }, .send = true };
+      host_reset(p, face->manifest);
+      host_run(face->mains[p], prv_settings_check_loop, &sent);
+
+      SettingsCheck migrated = { .job = sent.job };
+      host_reset(p, face->manifest);
+      prv_write_legacy_settings(face, values);
+      host_run(face->mains[p], prv_settings_check_loop, &migrated);
+      runs++;
+
+      bool ok = true;
+      if (sent.writes[0] != 1 || sent.writes[1] != 0) {
+        printf("%s %s: %u persist writes for a message, %u for the same again\n", face->name, platform,
+               sent.writes[0], sent.writes[1]);
+        ok = false;
+      }
+      for (size_t i = 0; i < NUM_VERSIONED; i++) {
+        const VersionedMessage *message = &s_versioned[i];
+        if (sent.versioned_writes[i] != message->writes || sent.acks[i] != message->ack) {
+          printf("%s %s: %u persist writes for %s, answered %d, where %u and %d were due\n", face->name,
+                 platform, sent.versioned_writes[i], message->name, sent.acks[i], message->writes, message->ack);
+          ok = false;
+        }
+      }
+      if (migrated.digest != sent.digest) {
+        printf("%s %s: migrated settings render differently\n", face->name, platform);
+        ok = false;
+      }
+      if (!persist_exists(SETTINGS_PERSIST_KEY)) {
+        printf("%s %s: no settings blob after migration\n", face->name, platform);
+        ok = false;
+      }
+      for (int i = 0; i < MAX_SETTINGS && face->settings[i].key; i++) {
+        if (persist_exists(host_manifest_message_key(face->manifest, face->settings[i].key))) {
+          printf("%s %s: %s left behind by migration\n", face->name, platform, face->settings[i].key);
+          ok = false;
+        }
+      }
+      failures += ok ? 0 : 1;
+    }
+  }
+  printf("settings check: %d runs, %d failures\n", runs, failures);
+  return failures;
+}
+
+// Eclipse built with MARKERS_PER_FRAME, for --check-markers
+static const HostFaceMain s_eclipse_trig_mains[HostPlatformCount] = HOST_FACE_MAINS(eclipse_trig);
+
+#define MARKER_CHECK_MINUTES (12 * 60)
+
+typedef struct {
+  BenchJob job;
+  // Results
+  uint64_t digests[MARKER_CHECK_MINUTES];
+  size_t heap_peak;
+} MarkerCheck;
+
+// Runs inside Eclipse's app_event_loop() for --check-markers
+static void prv_marker_check_loop(void *context) {
+  MarkerCheck *check = context;
+  prv_send_settings(&check->job);
+  for (int minute = 0; minute < MARKER_CHECK_MINUTES; minute++) {
+    host_set_time(prv_time_of_day(minute / 60, minute % 60));
+    host_tick(minute % 60 ? MINUTE_UNIT : MINUTE_UNIT | HOUR_UNIT);
+    host_render(false);
+    check->digests[minute] = host_framebuffer_digest();
+  }
+}
+
+static void prv_marker_check_run(MarkerCheck *check, HostFaceMain main, uint16_t peek_rows) {
+  host_reset(check->job.platform, check->job.face->manifest);
+  host_set_time(prv_time_of_day(11, 59));
+  host_set_battery(s_tier_charge[check->job.tier], false);
+  host_set_obstruction(peek_rows);
+  host_run(main, prv_marker_check_loop, check);
+  check->heap_peak = host_heap_peak();
+}
+
+static int prv_check_markers(void) {
+  const BenchFace *face = &s_faces[0];
+  // Rect mode, with an hour color of its own apart from the border's
+  static const int32_t values[] = { 0, 1, 0xFF5500 };
+  static const char *const tier_names[RenderTierCount] = { "full", "saver" };
+  static MarkerCheck tables, trig;
+  int runs = 0;
+  int failures = 0;
+  for (int p = 0; p < HostPlatformCount; p++) {
+    const HostPlatformInfo *info = host_platform_info(p);
+    // Round displays have no rect mode
+    if (info->round) {
+      continue;
+    }
+    for (int peek = 0; peek < (info->peek_height ? 2 : 1); peek++) {
+      for (int tier = 0; tier < RenderTierCount; tier++) {
+        uint16_t rows = peek ? info->peek_height : 0;
+        tables.job = trig.job = (BenchJob) { .face = face, .platform = p, .values = values, .tier = tier };
+        prv_marker_check_run(&tables, face->mains[p], rows);
+        prv_marker_check_run(&trig, s_eclipse_trig_mains[p], rows);
+        runs++;
+
+        int differ = 0;
+        int first = -1;
+        for (int minute = 0; minute < MARKER_CHECK_MINUTES; minute++) {
+          if (tables.digests[minute] != trig.digests[minute]) {
+            differ++;
+            first = first < 0 ? minute : first;
+          }
+        }
+        const char *where = peek ? "peek" : "full";
+        if (differ) {
+          printf("%s %s %s tier=%s: %d minutes differ from the per-frame markers, the first %d:%02d\n",
+                 face->name, info->name, where, tier_names[tier], differ, first / 60, first % 60);
+        } else if (tables.heap_peak <= trig.heap_peak) {
+          printf("%s %s %s tier=%s: no marker tables allocated\n", face->name, info->name, where, tier_names[tier]);
+        }
+        failures += differ || tables.heap_peak <= trig.heap_peak ? 1 : 0;
+      }
+    }
+  }
+  printf("marker check: %d runs, %d failures\n", runs, failures);
+  return failures;
+}
+
+// Bytes a NumeralCache piece of rect takes on this platform
+static size_t prv_patch_bytes(HostPlatform platform, GRect rect) {
+  if (!host_platform_info(platform)->color) {
+    return (size_t)((rect.origin.x + rect.size.w - 1) / 8 - rect.origin.x / 8 + 1) * rect.size.h;
+  }
+  return (size_t)rect.size.w * rect.size.h;
+}
+
+static int prv_bench_numeral(const BenchFace *face, HostPlatform platform, const HostNamedId *resource,
+                             const BenchOptions *options) {
+  host_reset(platform, face->manifest);
+  GContext *ctx = host_screen_context();
+  GDrawCommandImage *image = gdraw_command_image_create_with_resource(resource->id);
+  if (!image) {
+    fprintf(stderr, "%s: cannot load %s\n", face->name, resource->name);
+    return 1;
+  }
+  const HostPlatformInfo *info = host_platform_info(platform);
+  GSize size = gdraw_command_image_get_bounds_size(image);
+  GRect rect = GRect((info->width - size.w) / 2, (info->height - size.h) / 2, size.w, size.h);
+
+  // As the faces draw it: a background, then the image
+  host_stats_reset();
+  uint64_t start = prv_now_ns();
+  for (int i = 0; i < options->iterations; i++) {
+    graphics_context_set_fill_color(ctx, GColorWhite);
+    graphics_fill_rect(ctx, rect, 2, GCornersAll);
+    gdraw_command_image_draw(ctx, image, rect.origin);
+  }
+  uint64_t vector_ns = (prv_now_ns() - start) / options->iterations;
+  uint64_t vector_pixels = host_stats()->pixels / options->iterations;
+  uint64_t drawn = host_framebuffer_digest();
+
+  NumeralCache cache = { 0 };
+  numeral_cache_store(&cache, ctx, 0, &rect, 1);
+  graphics_context_set_fill_color(ctx, GColorBlack);
+  graphics_fill_rect(ctx, rect, 0, GCornerNone);
+  host_set_accounting(true);
+  host_stats_reset();
+  bool hit = numeral_cache_draw(&cache, ctx, 0);
+  host_set_accounting(false);
+  uint64_t copy_pixels = host_stats()->direct_pixels;
+  bool same = hit && host_framebuffer_digest() == drawn;
+
+  start = prv_now_ns();
+  for (int i = 0; i < options->iterations; i++) {
+    numeral_cache_draw(&cache, ctx, 0);
+  }
+  uint64_t copy_ns = (prv_now_ns() - start) / options->iterations;
+
+  printf("%-8s %-7s %-10s %5dx%-3d %9llu %8llu %9llu %8llu %6zu  %s\n", face->name, info->name, resource->name,
+         size.w, size.h, (unsigned long long)vector_ns, (unsigned long long)vector_pixels,
+         (unsigned long long)copy_ns, (unsigned long long)copy_pixels, prv_patch_bytes(platform, rect),
+         same ? "ok" : "DIFFERENT");
+  numeral_cache_destroy(&cache);
+  gdraw_command_image_destroy(image);
+  return same ? 0 : 1;
+}
+
+static int prv_bench_numerals(const BenchOptions *options) {
+  printf("%-8s %-7s %-10s %9s %9s %8s %9s %8s %6s  %s\n", "face", "platform", "numeral", "size", "vector_ns",
+         "pixels", "copy_ns", "pixels", "bytes", "check");
+  int failures = 0;
+  for (size_t f = 0; f < NUM_FACES; f++) {
+    const BenchFace *face = &s_faces[f];
+    if (options->face_filter && strcmp(options->face_filter, face->name) != 0) {
+      continue;
+    }
+    for (int p = 0; p < HostPlatformCount; p++) {
+      if (options->platform_filter && strcmp(options->platform_filter, host_platform_info(p)->name) != 0) {
+        continue;
+      }
+      for (const HostNamedId *resource = face->manifest->resources; resource->name; resource++) {
+        if (strncmp(resource->name, "NUMBER_", 7) == 0) {
+          failures += prv_bench_numeral(face, (HostPlatform)p, resource, options);
+        }
+      }
+    }
+  }
+  return failures;
+}
+
+// A hand for --lines: from inner to outer pixels out from the center
+typedef struct {
+  const char *name;
+  int16_t inner;
+  int16_t outer;
+} LineShape;
+
+// Offsets from half the screen's height: Trio's and Enough's hands from the
+// hub, and Hollow's from its rect mode border, which lies off screen
+static const LineShape s_line_shapes[] = {
+  { "hand", 0, -20 },
+  { "border", 40, -30 },
+};
+
+static const uint8_t s_line_widths[] = { 2, 3, 4 };
+
+#define LINE_MINUTES 60
+
+static void prv_line_ends(HostPlatform platform, const LineShape *shape, int minute, GPoint *p0, GPoint *p1) {
+  const HostPlatformInfo *info = host_platform_info(platform);
+  GPoint center = GPoint(info->width / 2, info->height / 2);
+  int32_t angle = TRIG_MAX_ANGLE * minute / LINE_MINUTES;
+  int16_t inner = shape->inner ? info->height / 2 + shape->inner : 0;
+  int16_t outer = info->height / 2 + shape->outer;
+  *p0 = GPoint(center.x + sin_lookup(angle) * inner / TRIG_MAX_RATIO,
+               center.y - cos_lookup(angle) * inner / TRIG_MAX_RATIO);
+  *p1 = GPoint(center.x + sin_lookup(angle) * outer / TRIG_MAX_RATIO,
+               center.y - cos_lookup(angle) * outer / TRIG_MAX_RATIO);
+}
+
+// Draws the hand at every minute, through the SDK with cap -1, and returns
+// the time per line
+static uint64_t prv_draw_lines(HostPlatform platform, const LineShape *shape, uint8_t width, int cap,
+                               bool antialiased, int iterations) {
+  GContext *ctx = host_screen_context();
+  const HostPlatformInfo *info = host_platform_info(platform);
+  GRect clip = GRect(0, 0, info->width, info->height);
+  graphics_context_set_stroke_color(ctx, GColorWhite);
+  graphics_context_set_stroke_width(ctx, width);
+  uint64_t start = prv_now_ns();
+  for (int i = 0; i < iterations; i++) {
+    for (int minute = 0; minute < LINE_MINUTES; minute++) {
+      GPoint p0, p1;
+      prv_line_ends(platform, shape, minute, &p0, &p1);
+      if (cap < 0) {
+        graphics_draw_line(ctx, p0, p1);
+      } else {
+        thick_line_draw(ctx, clip, p0, p1, width, (ThickLineCap)cap, antialiased, GColorWhite);
+      }
+    }
+  }
+  return (prv_now_ns() - start) / ((uint64_t)iterations * LINE_MINUTES);
+}
+
+// The first minute whose hand thick_line_draw() draws with other pixels
+// than graphics_draw_line(), or -1, and the pixels of both over the minutes
+static int prv_compare_lines(HostPlatform platform, const LineShape *shape, uint8_t width, uint64_t *sdk_pixels,
+                             uint64_t *pixels) {
+  GContext *ctx = host_screen_context();
+  const HostPlatformInfo *info = host_platform_info(platform);
+  GRect screen = GRect(0, 0, info->width, info->height);
+  int different = -1;
+  *sdk_pixels = 0;
+  *pixels = 0;
+  for (int minute = 0; minute < LINE_MINUTES; minute++) {
+    GPoint p0, p1;
+    prv_line_ends(platform, shape, minute, &p0, &p1);
+    uint64_t digests[2];
+    for (int direct = 0; direct < 2; direct++) {
+      graphics_context_set_fill_color(ctx, GColorBlack);
+      graphics_fill_rect(ctx, screen, 0, GCornerNone);
+      host_set_accounting(true);
+      host_stats_reset();
+      if (direct) {
+        thick_line_draw(ctx, screen, p0, p1, width, ThickLineCapRound, false, GColorWhite);
+        *pixels += host_stats()->direct_pixels;
+      } else {
+        graphics_context_set_stroke_color(ctx, GColorWhite);
+        graphics_context_set_stroke_width(ctx, width);
+        graphics_draw_line(ctx, p0, p1);
+        *sdk_pixels += host_stats()->pixels;
+      }
+      host_set_accounting(false);
+      digests[direct] = host_framebuffer_digest();
+    }
+    if (digests[0] != digests[1] && different < 0) {
+      different = minute;
+    }
+  }
+  return different;
+}
+
+static int prv_bench_lines(const BenchOptions *options) {
+  printf("%-7s %-6s %5s %8s %8s %8s %8s %8s %8s  %s\n", "platform", "shape", "width", "sdk_ns", "round_ns",
+         "flat_ns", "aa_ns", "sdk_px", "px", "check");
+  int failures = 0;
+  for (int p = 0; p < HostPlatformCount; p++) {
+    if (options->platform_filter && strcmp(options->platform_filter, host_platform_info(p)->name) != 0) {
+      continue;
+    }
+    for (size_t s = 0; s < sizeof(s_line_shapes) / sizeof(s_line_shapes[0]); s++) {
+      for (size_t w = 0; w < sizeof(s_line_widths); w++) {
+        const LineShape *shape = &s_line_shapes[s];
+        uint8_t width = s_line_widths[w];
+        host_reset((HostPlatform)p, s_faces[0].manifest);
+        uint64_t sdk_pixels, pixels;
+        int different = prv_compare_lines((HostPlatform)p, shape, width, &sdk_pixels, &pixels);
+        uint64_t sdk_ns = prv_draw_lines((HostPlatform)p, shape, width, -1, false, options->iterations);
+        uint64_t round_ns = prv_draw_lines((HostPlatform)p, shape, width, ThickLineCapRound, false,
+                                           options->iterations);
+        uint64_t flat_ns = prv_draw_lines((HostPlatform)p, shape, width, ThickLineCapFlat, false,
+                                          options->iterations);
+        uint64_t aa_ns = prv_draw_lines((HostPlatform)p, shape, width, ThickLineCapRound, true, options->iterations);
+        char check[32];
+        if (different < 0) {
+          snprintf(check, sizeof(check), "ok");
+        } else {
+          snprintf(check, sizeof(check), "DIFFERENT at :%02d", different);
+        }
+        printf("%-8s %-6s %5d %8llu %8llu %8llu %8llu %8llu %8llu  %s\n", host_platform_info(p)->name,
+               shape->name, width, (unsigned long long)sdk_ns, (unsigned long long)round_ns,
+               (unsigned long long)flat_ns, (unsigned long long)aa_ns, (unsigned long long)sdk_pixels / LINE_MINUTES,
+               (unsigned long long)pixels / LINE_MINUTES, check);
+        failures += different < 0 ? 0 : 1;
+      }
+    }
+  }
+  return failures;
+}
+
+// Eclipse's bezel for --bands: a background, then from the outside in a
+// border, the ring, another border and the center
+#define BEZEL_BORDER 2
+#define BEZEL_RING 20
+#define BEZEL_CORNER_RADIUS 8
+
+static uint8_t prv_bezel(HostPlatform platform, bool rect, bool peek, BandShape *shapes) {
+  const HostPlatformInfo *info = host_platform_info(platform);
+  GRect screen = GRect(0, 0, info->width, info->height);
+  GRect bounds = GRect(0, 0, info->width, info->height - (peek ? info->peek_height : 0));
+  static const int16_t insets[4] = { 0, BEZEL_BORDER, BEZEL_BORDER + BEZEL_RING, 2 * BEZEL_BORDER + BEZEL_RING };
+  const GColor colors[4] = { GColorDarkGray, GColorWhite, GColorDarkGray, GColorBlack };
+  shapes[0] = (BandShape) { .type = BandShapeRect, .color = GColorBlack, .rect = screen };
+  GPoint center = GPoint(bounds.size.w / 2, bounds.size.h / 2);
+  int16_t radius = (center.x < center.y ? center.x : center.y) - 1;
+  for (int i = 0; i < 4; i++) {
+    GColor color = colors[i];
+    if (rect) {
+      GRect inset = GRect(insets[i], insets[i], bounds.size.w - 2 * insets[i], bounds.size.h - 2 * insets[i]);
+      shapes[1 + i] = (BandShape) { .type = BandShapeRect, .color = color, .rect = inset,
+                                    .corner_radius = BEZEL_CORNER_RADIUS };
+    } else {
+      shapes[1 + i] = (BandShape) { .type = BandShapeCircle, .color = color, .center = center,
+                                    .radius = radius - insets[i] };
+    }
+  }
+  return 5;
+}
+
+// Paints the bezel through the SDK, shape after shape, or with band_fill()
+static void prv_draw_bezel(const BandShape *shapes, uint8_t count, bool bands) {
+  GContext *ctx = host_screen_context();
+  if (bands) {
+    band_fill(ctx, shapes, count);
+    return;
+  }
+  for (uint8_t i = 0; i < count; i++) {
+    graphics_context_set_fill_color(ctx, shapes[i].color);
+    if (shapes[i].type == BandShapeCircle) {
+      graphics_fill_circle(ctx, shapes[i].center, shapes[i].radius);
+    } else {
+      graphics_fill_rect(ctx, shapes[i].rect, shapes[i].corner_radius,
+                         shapes[i].corner_radius ? GCornersAll : GCornerNone);
+    }
+  }
+}
+
+// Pixels band_fill() writes: on 8-bit frame buffers those that no longer
+// hold red, which the bezel has none of; on 1-bit ones those that change
+// from a black frame plus those that change from a white one, as each is
+// written once
+static uint64_t prv_bezel_writes(HostPlatform platform, const BandShape *shapes, uint8_t count) {
+  GContext *ctx = host_screen_context();
+  const HostPlatformInfo *info = host_platform_info(platform);
+  GColor fills[2] = { info->color ? GColorRed : GColorBlack, GColorWhite };
+  uint64_t writes = 0;
+  for (int pass = 0; pass < (info->color ? 1 : 2); pass++) {
+    graphics_context_set_fill_color(ctx, fills[pass]);
+    graphics_fill_rect(ctx, GRect(0, 0, info->width, info->height), 0, GCornerNone);
+    host_set_accounting(true);
+    host_stats_reset();
+    prv_draw_bezel(shapes, count, true);
+    host_set_accounting(false);
+    writes += host_stats()->direct_pixels;
+  }
+  return writes;
+}
+
+static int prv_bench_bands(const BenchOptions *options) {
+  printf("%-8s %-6s %-4s %8s %8s %8s %8s  %s\n", "platform", "shape", "peek", "sdk_ns", "band_ns", "sdk_px",
+         "band_px", "check");
+  int failures = 0;
+  for (int p = 0; p < HostPlatformCount; p++) {
+    if (options->platform_filter && strcmp(options->platform_filter, host_platform_info(p)->name) != 0) {
+      continue;
+    }
+    for (int rect = 0; rect < 2; rect++) {
+      for (int peek = 0; peek < (host_platform_info(p)->peek_height ? 2 : 1); peek++) {
+        BandShape shapes[BAND_FILL_MAX_SHAPES];
+        uint8_t count = prv_bezel((HostPlatform)p, rect, peek, shapes);
+        host_reset((HostPlatform)p, s_faces[0].manifest);
+
+        host_stats_reset();
+        prv_draw_bezel(shapes, count, false);
+        uint64_t sdk_pixels = host_stats()->pixels;
+        uint64_t sdk_digest = host_framebuffer_digest();
+        uint64_t band_pixels = prv_bezel_writes((HostPlatform)p, shapes, count);
+        bool same = host_framebuffer_digest() == sdk_digest;
+
+        uint64_t ns[2];
+        for (int bands = 0; bands < 2; bands++) {
+          uint64_t start = prv_now_ns();
+          for (int i = 0; i < options->iterations; i++) {
+            prv_draw_bezel(shapes, count, bands);
+          }
+          ns[bands] = (prv_now_ns() - start) / options->iterations;
+        }
+        printf("%-8s %-6s %-4s %8llu %8llu %8llu %8llu  %s\n", host_platform_info(p)->name,
+               rect ? "rect" : "circle", peek ? "yes" : "no", (unsigned long long)ns[0], (unsigned long long)ns[1],
+               (unsigned long long)sdk_pixels, (unsigned long long)band_pixels, same ? "ok" : "DIFFERENT");
+        failures += same ? 0 : 1;
+      }
+    }
+  }
+  return failures;
+}
+
+// Runs for --spans, as long as emery's rows at most, with room past them
+// for every alignment
+#define SPAN_ROW_WIDTH 232
+
+static const int16_t s_span_lengths[] = { 1, 7, 32, 72, 144, 200 };
+
+#define NUM_SPAN_LENGTHS (sizeof(s_span_lengths) / sizeof(s_span_lengths[0]))
+
+// The runs span_fill() replaced: memset on 8-bit rows, the bytes between
+// the masked ends on 1-bit ones
+static void prv_span_bytes(const GBitmapDataRowInfo *info, bool bw, int16_t x0, int16_t x1, GColor color) {
+  if (!bw) {
+    memset(info->data + x0, color.argb, x1 - x0 + 1);
+    return;
+  }
+  uint8_t fill = color.r + color.g + color.b >= 5 ? 0xff : 0x00;
+  uint8_t *first = info->data + x0 / 8;
+  uint8_t *last = info->data + x1 / 8;
+  uint8_t first_mask = (uint8_t)(0xff << (x0 % 8));
+  uint8_t last_mask = (uint8_t)(0xff >> (7 - x1 % 8));
+  if (first == last) {
+    first_mask &= last_mask;
+    *first = (*first & ~first_mask) | (fill & first_mask);
+    return;
+  }
+  *first = (*first & ~first_mask) | (fill & first_mask);
+  memset(first + 1, fill, last - first - 1);
+  *last = (*last & ~last_mask) | (fill & last_mask);
+}
+
+static int prv_bench_spans(const BenchOptions *options) {
+  static uint32_t row_words[SPAN_ROW_WIDTH / 4 + 2];
+  printf("%-6s %6s %5s %8s %8s\n", "format", "length", "align", "byte_ns", "span_ns");
+  // Enough runs per timing for the host's clock to see
+  int runs = 1000 * options->iterations;
+  for (int bw = 0; bw < 2; bw++) {
+    for (size_t l = 0; l < NUM_SPAN_LENGTHS; l++) {
+      for (int16_t align = 0; align < 4; align++) {
+        // On 1-bit rows the alignment is of the run's first pixel in its byte
+        int16_t x0 = bw ? align * 3 : align;
+        int16_t x1 = x0 + s_span_lengths[l] - 1;
+        GBitmapDataRowInfo info = { .data = (uint8_t *)row_words, .min_x = 0, .max_x = SPAN_ROW_WIDTH - 1 };
+        uint64_t ns[2];
+        for (int span = 0; span < 2; span++) {
+          uint64_t start = prv_now_ns();
+          for (int i = 0; i < runs; i++) {
+            GColor color = (i & 1) ? GColorWhite : GColorBlack;
+            if (span) {
+              span_fill(&info, bw, 0, x0, x1, color);
+            } else {
+              prv_span_bytes(&info, bw, x0, x1, color);
+            }
+          }
+          ns[span] = (prv_now_ns() - start) * 1000 / runs;
+        }
+        printf("%-6s %6d %5d %8.1f %8.1f\n", bw ? "1-bit" : "8-bit", s_span_lengths[l], bw ? x0 % 8 : x0,
+               ns[0] / 1000.0, ns[1] / 1000.0);
+      }
+    }
+  }
+  return 0;
+}
+
+typedef struct {
+  bool hold;
+  uint64_t start_ns;
+  // Results
+  uint64_t first_frame_ns;
+  uint64_t complete_ns;
+  uint64_t first_pixels;
+  uint64_t follow_up_pixels;
+  uint64_t digest;
+} LaunchRun;
+
+static uint64_t prv_frame_pixels(void) {
+  return host_stats()->pixels + host_stats()->direct_pixels;
+}
+
+// Runs inside the face's app_event_loop() for --launch
+static void prv_launch_loop(void *context) {
+  LaunchRun *run = context;
+  host_hold_timers(run->hold);
+  host_stats_reset();
+  host_render(false);
+  run->first_frame_ns = prv_now_ns() - run->start_ns;
+  run->first_pixels = prv_frame_pixels();
+
+  host_hold_timers(false);
+  host_stats_reset();
+  if (host_render(false)) {
+    run->follow_up_pixels = prv_frame_pixels();
+  }
+  run->complete_ns = prv_now_ns() - run->start_ns;
+  run->digest = host_framebuffer_digest();
+}
+
+static void prv_launch(const BenchFace *face, HostPlatform platform, LaunchRun *run, bool accounting) {
+  host_reset(platform, face->manifest);
+  host_set_time(prv_time_of_day(10, 8));
+  host_set_accounting(accounting);
+  run->start_ns = prv_now_ns();
+  host_run(face->mains[platform], prv_launch_loop, run);
+  host_set_accounting(false);
+}
+
+static int prv_bench_launch(const BenchOptions *options) {
+  printf("%-8s %-7s %10s %11s %9s %9s  %s\n", "face", "platform", "first_ns", "complete_ns", "first_px", "later_px",
+         "check");
+  int failures = 0;
+  for (size_t f = 0; f < NUM_FACES; f++) {
+    const BenchFace *face = &s_faces[f];
+    if (options->face_filter && strcmp(options->face_filter, face->name) != 0) {
+      continue;
+    }
+    for (int p = 0; p < HostPlatformCount; p++) {
+      if (options->platform_filter && strcmp(options->platform_filter, host_platform_info(p)->name) != 0) {
+        continue;
+      }
+      // Pixels first, then the time without the accounting's frame copies
+      LaunchRun unheld = { .hold = false };
+      LaunchRun held = { .hold = true };
+      prv_launch(face, p, &unheld, false);
+      prv_launch(face, p, &held, true);
+      uint64_t first_ns = 0, complete_ns = 0;
+      for (int i = 0; i < options->iterations; i++) {
+        LaunchRun run = { .hold = true };
+        prv_launch(face, p, &run, false);
+        if (!i || run.first_frame_ns < first_ns) {
+          first_ns = run.first_frame_ns;
+        }
+        if (!i || run.complete_ns < complete_ns) {
+          complete_ns = run.complete_ns;
+        }
+      }
+      bool same = held.digest == unheld.digest;
+      printf("%-8s %-7s %10llu %11llu %9llu %9llu  %s\n", face->name, host_platform_info(p)->name,
+             (unsigned long long)first_ns, (unsigned long long)complete_ns, (unsigned long long)held.first_pixels,
+             (unsigned long long)held.follow_up_pixels, same ? "ok" : "DIFFERENT");
+      failures += same ? 0 : 1;
+    }
+  }
+  return failures;
+}
+
+// The collection's builds, for the platforms it targets
+static const HostFaceMain s_collection_mains[HostPlatformCount] = {
+  [HostPlatformBasalt] = host_main_collection_basalt,
+  [HostPlatformChalk] = host_main_collection_chalk,
+  [HostPlatformEmery] = host_main_collection_emery,
+};
+
+// As collection/src/c/collection.c keeps the face that runs
+#define COLLECTION_FACE_PERSIST_KEY 1
+
+// Percent a start or switch in the collection may take over the face's own
+// start
+#define COLLECTION_SLACK 10
+
+typedef struct {
+  // FACE to send once the first frame is drawn, or -1
+  int32_t switch_to;
+  uint64_t start_ns;
+  // Results
+  uint64_t first_frame_ns;
+  uint64_t switch_ns;
+  uint64_t digest;
+} CollectionRun;
+
+// Runs inside the app's app_event_loop() for --collection
+static void prv_collection_loop(void *context) {
+  CollectionRun *run = context;
+  host_render(false);
+  run->first_frame_ns = prv_now_ns() - run->start_ns;
+  if (run->switch_to >= 0) {
+    uint32_t key = host_manifest_message_key(&host_manifest_collection, "FACE");
+    uint64_t start = prv_now_ns();
+    host_send_message(&key, &run->switch_to, 1);
+    host_render(false);
+    run->switch_ns = prv_now_ns() - start;
+  }
+  run->digest = host_framebuffer_digest();
+}
+
+// Starts main, as the collection on face start_on if that isn't negative,
+// and keeps the least times of this and earlier runs in best. Returns the
+// heap peak.
+static size_t prv_collection_start(HostPlatform platform, const HostFaceManifest *manifest, HostFaceMain main,
+                                   int32_t start_on, CollectionRun *best) {
+  host_reset(platform, manifest);
+  host_set_time(prv_time_of_day(10, 8));
+  if (start_on >= 0) {
+    persist_write_int(COLLECTION_FACE_PERSIST_KEY, start_on);
+  }
+  CollectionRun run = { .switch_to = best->switch_to };
+  run.start_ns = prv_now_ns();
+  host_run(main, prv_collection_loop, &run);
+  if (!best->first_frame_ns || run.first_frame_ns < best->first_frame_ns) {
+    best->first_frame_ns = run.first_frame_ns;
+  }
+  if (!best->switch_ns || run.switch_ns < best->switch_ns) {
+    best->switch_ns = run.switch_ns;
+  }
+  best->digest = run.digest;
+  return host_heap_peak();
+}
+
+static int prv_bench_collection(const BenchOptions *options) {
+  printf("%-8s %-7s %10s %6s %10s %6s %10s %6s  %s\n", "face", "platform", "single_ns", "heap", "start_ns", "heap",
+         "switch_ns", "heap", "check");
+  int failures = 0;
+  for (size_t f = 0; f < NUM_FACES; f++) {
+    const BenchFace *face = &s_faces[f];
+    if (options->face_filter && strcmp(options->face_filter, face->name) != 0) {
+      continue;
+    }
+    for (int p = 0; p < HostPlatformCount; p++) {
+      if (!s_collection_mains[p] ||
+          (options->platform_filter && strcmp(options->platform_filter, host_platform_info(p)->name) != 0)) {
+        continue;
+      }
+      CollectionRun single = { .switch_to = -1 };
+      CollectionRun start = { .switch_to = -1 };
+      CollectionRun switched = { .switch_to = (int32_t)f };
+      size_t single_heap = 0, start_heap = 0, switch_heap = 0;
+      // Taken in turns, so the machine getting busier or quieter tells on
+      // all three alike
+      for (int i = 0; i < options->iterations; i++) {
+        single_heap = prv_collection_start(p, face->manifest, face->mains[p], -1, &single);
+        start_heap = prv_collection_start(p, &host_manifest_collection, s_collection_mains[p], (int32_t)f, &start);
+        switch_heap = prv_collection_start(p, &host_manifest_collection, s_collection_mains[p],
+                                           (int32_t)((f + NUM_FACES - 1) % NUM_FACES), &switched);
+      }
+
+      uint64_t budget = single.first_frame_ns * (100 + COLLECTION_SLACK) / 100;
+      const char *failure = start.digest != single.digest || switched.digest != single.digest ? "DIFFERENT"
+                            : start.first_frame_ns > budget                                      ? "SLOWER START"
+                            : switched.switch_ns > budget                                        ? "SLOWER SWITCH"
+                                                                                                 : NULL;
+      printf("%-8s %-7s %10llu %6zu %10llu %6zu %10llu %6zu  %s\n", face->name, host_platform_info(p)->name,
+             (unsigned long long)single.first_frame_ns, single_heap, (unsigned long long)start.first_frame_ns,
+             start_heap, (unsigned long long)switched.switch_ns, switch_heap, failure ? failure : "ok");
+      failures += failure ? 1 : 0;
+    }
+  }
+  return failures;
+}
+
+static void prv_format_label(BenchJob *job) {
+  char *out = job->label;
+  size_t left = sizeof(job->label);
+  out[0] = '\0';
+  for (int i = 0; i < MAX_SETTINGS && job->face->settings[i].key; i++) {
+    const BenchSetting *setting = &job->face->settings[i];
+    int n = snprintf(out, left, setting->hex ? "%s%s=%06x" : "%s%s=%d", i ? "," : "", setting->label,
+                     job->values[i]);
+    out += n;
+    left -= n;
+  }
+  if (job->options->tiers) {
+    static const char *const tier_names[RenderTierCount] = { "full", "saver" };
+    snprintf(out, left, ",tier=%s", tier_names[job->tier]);
+  }
+}
+
+static void prv_print_header(const BenchOptions *options) {
+  if (options->sweep) {
+    printf("%-8s %-7s %-34s %s\n", "face", "platform", "settings", "digest");
+  } else if (options->power) {
+    printf("%-8s %-7s %-34s %6s %6s %9s %6s %6s %7s\n", "face", "platform", "settings", "policy", "frames", "pixels",
+           "active", "idle", "skipped");
+  } else if (options->ticks) {
+    printf("%-8s %-7s %-34s %8s %8s %6s\n", "face", "platform", "settings", "hour", "minute", "screen");
+  } else if (options->day) {
+    printf("%-8s %-7s %-34s %8s %8s %8s %9s %8s %8s  %s\n", "face", "platform", "settings", "total_ms", "mean_ns",
+           "worst_ns", "pixels", "worst_px", "worst_at", "slowest");
+  } else if (options->peek) {
+    printf("%-8s %-7s %-34s %6s %8s %8s %8s %8s %6s  %s\n", "face", "platform", "settings", "frames", "ns/frame",
+           "pixels", "budget", "settle", "allocs", "check");
+  } else if (options->golden_dir) {
+    printf("%-8s %-7s %-34s %6s  %s\n", "face", "platform", "settings", "frames", "check");
+  } else if (options->profile) {
+    printf("%-8s %-7s %-34s %5s %6s %6s %6s %6s %6s  %s\n", "face", "platform", "settings", "slots", "frames", "min",
+           "mean", "p95", "max", "check");
+  } else if (options->instrument) {
+    printf("%-8s %-7s %-34s %7s %7s %7s %7s %7s %6s %6s %6s\n", "face", "platform", "settings", "init", "load",
+           "msgopen", "frame", "free", "stack", "1st_ms", "all_ms");
+  } else if (options->csv) {
+    printf("face,platform,settings,ns_per_frame,pixels,direct_pixels,heap_peak,frame_allocations,frame_heap,display_commands,"
+           "dirty_pixels");
+    for (int p = 0; p < HostPrimCount; p++) {
+      printf(",%s", host_prim_name(p));
+    }
+    printf("\n");
+  } else {
+    printf("%-8s %-7s %-34s %10s %7s %8s %8s %6s %6s %6s %4s %6s  %s\n", "face", "platform", "settings",
+           "ns/frame", "prims", "pixels", "direct", "heap", "allocs", "fheap", "cmds", "dirty", "primitives");
+  }
+}
+
+static void prv_print_job(const BenchJob *job) {
+  const HostPlatformInfo *info = host_platform_info(job->platform);
+  if (job->options->golden_dir) {
+    printf("%-8s %-7s %-34s %6u  %s\n", job->face->name, info->name, job->label, job->golden_frames,
+           job->options->update ? "written" : job->golden_failure[0] ? job->golden_failure : "ok");
+    return;
+  }
+  if (job->options->profile) {
+    if (!job->has_profile) {
+      printf("%-8s %-7s %-34s no statistics; build with make PROFILE=1\n", job->face->name, info->name, job->label);
+      return;
+    }
+    // One tier and one set of settings per run, so all in one slot
+    const ProfileSlotStats *stats = &job->profile;
+    bool ok = stats->count == 1 && stats->tier == job->tier && stats->frames == job->profile_renders;
+    printf("%-8s %-7s %-34s %5u %6u %6u %6u %6u %6u  %s\n", job->face->name, info->name, job->label, stats->count,
+           stats->frames, stats->min, stats->mean, stats->p95, stats->max, ok ? "ok" : "miscounted");
+    return;
+  }
+  if (job->options->instrument) {
+    if (!job->has_summary) {
+      printf("%-8s %-7s %-34s no summary; build with make INSTRUMENT=1\n", job->face->name, info->name, job->label);
+      return;
+    }
+    const InstrumentSummary *summary = &job->summary;
+    printf("%-8s %-7s %-34s %7u %7u %7u %7u %7u %6u %6u %6u\n", job->face->name, info->name, job->label,
+           summary->heap[InstrumentPointInit].used, summary->heap[InstrumentPointWindowLoad].used,
+           summary->heap[InstrumentPointAppMessageOpen].used, summary->heap[InstrumentPointUpdateProc].used,
+           summary->heap[InstrumentPointUpdateProc].free, summary->stack_peak, summary->launch_first_frame,
+           summary->launch_complete);
+    return;
+  }
+  if (job->options->sweep) {
+    printf("%-8s %-7s %-34s %016llx\n", job->face->name, info->name, job->label,
+           (unsigned long long)job->digest);
+    return;
+  }
+  if (job->options->power) {
+    printf("%-8s %-7s %-34s %6u %6u %9llu", job->face->name, info->name, job->label, job->power_policy,
+           job->power_frames, (unsigned long long)job->power_pixels);
+    if (job->has_power_report) {
+      printf(" %6u %6u %7u\n", job->power_report.minutes[PowerModeActive], job->power_report.minutes[PowerModeIdle],
+             job->power_report.skipped);
+    } else {
+      printf(" %6s %6s %7s\n", "-", "-", "-");
+    }
+    return;
+  }
+  if (job->options->peek) {
+    const char *failure = prv_peek_failure(job);
+    printf("%-8s %-7s %-34s %6u %8llu %8llu %8llu %8llu %6u  %s\n", job->face->name, info->name, job->label,
+           job->peek_frames / 2, (unsigned long long)job->peek_ns, (unsigned long long)job->peek_max_pixels,
+           (unsigned long long)job->peek_budget, (unsigned long long)job->peek_settle_pixels, job->peek_allocations,
+           failure ? failure : "ok");
+    return;
+  }
+  if (job->options->ticks) {
+    uint32_t screen = (uint32_t)info->width * info->height;
+    printf("%-8s %-7s %-34s %8llu %8llu %5.0fx\n", job->face->name, info->name, job->label,
+           (unsigned long long)job->hour_pixels, (unsigned long long)job->minute_pixels,
+           job->minute_pixels ? (double)screen / job->minute_pixels : 0.0);
+    return;
+  }
+  if (job->options->day) {
+    char slowest[DAY_SLOWEST * 12] = "";
+    size_t used = 0;
+    for (int k = 0; k < DAY_SLOWEST; k++) {
+      int minute = job->day_slowest[k];
+      used += snprintf(slowest + used, sizeof(slowest) - used, "%s%02d:%02d%s%s", k ? " " : "", minute / 60,
+                       minute % 60, minute % 60 ? "" : "h", minute % 15 ? "" : "q");
+    }
+    char worst_at[8];
+    snprintf(worst_at, sizeof(worst_at), "%02d:%02d", job->day_worst_pixels_minute / 60,
+             job->day_worst_pixels_minute % 60);
+    printf("%-8s %-7s %-34s %8.2f %8llu %8llu %9llu %8llu %8s  %s\n", job->face->name, info->name, job->label,
+           job->day_ns / 1e6, (unsigned long long)(job->day_ns / (24 * 60)), (unsigned long long)job->day_worst_ns,
+           (unsigned long long)job->day_pixels, (unsigned long long)job->day_worst_pixels, worst_at, slowest);
+    return;
+  }
+  if (job->options->csv) {
+    printf("%s,%s,\"%s\",%llu,%llu,%llu,%zu,%u,%zu,%u,%u", job->face->name, info->name, job->label,
+           (unsigned long long)job->ns_per_frame, (unsigned long long)job->per_frame.pixels,
+           (unsigned long long)job->per_frame.direct_pixels, job->heap_peak, job->per_frame.allocations,
+           job->per_frame.heap_high_water, job->display.commands, job->display.dirty_pixels);
+    for (int p = 0; p < HostPrimCount; p++) {
+      printf(",%u", job->per_frame.prims[p]);
+    }
+    printf("\n");
+    return;
+  }
+
+  uint32_t prims = 0;
+  char breakdown[256] = "";
+  size_t used = 0;
+  for (int p = 0; p < HostPrimCount; p++) {
+    prims += job->per_frame.prims[p];
+    if (job->per_frame.prims[p]) {
+      used += snprintf(breakdown + used, sizeof(breakdown) - used, "%s%s=%u", used ? " " : "", host_prim_name(p),
+                       job->per_frame.prims[p]);
+    }
+  }
+  printf("%-8s %-7s %-34s %10llu %7u %8llu %8llu %6zu %6u %6zu %4u %6u  %s\n", job->face->name, info->name,
+         job->label, (unsigned long long)job->ns_per_frame, prims, (unsigned long long)job->per_frame.pixels,
+         (unsigned long long)job->per_frame.direct_pixels, job->heap_peak, job->per_frame.allocations,
+         job->per_frame.heap_high_water, job->display.commands, job->display.dirty_pixels, breakdown);
+}
+
+// Returns the jobs that failed a check
+static int prv_run_face(const BenchFace *face, HostPlatform platform, const BenchOptions *options) {
+  int failures = 0;
+  int num_settings = 0;
+  int radix[MAX_SETTINGS];
+  int combos = 1;
+  for (int i = 0; i < MAX_SETTINGS && face->settings[i].key; i++) {
+    radix[i] = face->settings[i].num_values;
+    combos *= radix[i];
+    num_settings++;
+  }
+
+  // Platforms without Quick View have no peek to play
+  if (options->peek && !host_platform_info(platform)->peek_height) {
+    return 0;
+  }
+
+  // --power plays the default settings once per policy instead
+  int runs = options->power ? PowerPolicyCount : combos;
+  for (int run = 0; run < runs; run++) {
+    int32_t values[MAX_SETTINGS];
+    int rest = options->power ? 0 : run;
+    for (int i = num_settings - 1; i >= 0; i--) {
+      values[i] = face->settings[i].values[rest % radix[i]];
+      rest /= radix[i];
+    }
+
+    int tiers = options->tiers ? RenderTierCount : 1;
+    for (int tier = 0; tier < tiers; tier++) {
+      BenchJob job = { .face = face, .platform = platform, .values = values, .options = options, .tier = tier,
+                       .power_policy = options->power ? run : PowerPolicyOff };
+      prv_format_label(&job);
+      host_reset(platform, face->manifest);
+      // The clock the face launches at; --instrument draws its first frames
+      // at the first of s_times, and so times the launch by the host's clock
+      host_set_time(prv_time_of_day(s_times[0][0], s_times[0][1]));
+      host_set_battery(s_tier_charge[tier], false);
+      HostEventLoop loop = options->sweep        ? prv_sweep_loop
+                           : options->ticks      ? prv_ticks_loop
+                           : options->day        ? prv_day_loop
+                           : options->power      ? prv_power_loop
+                           : options->peek       ? prv_peek_loop
+                           : options->golden_dir ? prv_golden_loop
+                           : options->instrument ? prv_instrument_loop
+                           : options->profile    ? prv_profile_loop
+                                                 : prv_bench_loop;
+      host_run(face->mains[platform], loop, &job);
+      if (options->peek) {
+        host_reset(platform, face->manifest);
+        host_set_battery(s_tier_charge[tier], false);
+        host_set_obstruction(host_platform_info(platform)->peek_height);
+        host_run(face->mains[platform], prv_peek_start_loop, &job);
+        failures += prv_peek_failure(&job) ? 1 : 0;
+      }
+      failures += job.golden_failure[0] ? 1 : 0;
+      prv_print_job(&job);
+    }
+  }
+  return failures;
+}
+
+static void prv_usage(const char *argv0) {
+  fprintf(stderr,
+          "usage: %s [--face NAME] [--platform NAME] [--iterations N] [--csv] [--dump DIR] [--tiers]\n"
+          "          [--sweep | --ticks | --day | --power | --peek | --golden DIR [--update] | --instrument\n"
+          "           | --profile]\n"
+          "       %s --numerals [--face NAME] [--platform NAME] [--iterations N]\n"
+          "       %s --launch [--face NAME] [--platform NAME] [--iterations N]\n"
+          "       %s --collection [--face NAME] [--platform NAME] [--iterations N]\n"
+          "       %s --lines [--platform NAME] [--iterations N]\n"
+          "       %s --bands [--platform NAME] [--iterations N]\n"
+          "       %s --spans [--iterations N]\n"
+          "       %s --check-layout\n"
+          "       %s --check-spans\n"
+          "       %s --check-settings\n"
+          "       %s --check-markers\n"
+          "  faces: eclipse trio enough binary hollow\n"
+          "  platforms: aplite basalt chalk emery\n",
+          argv0, argv0, argv0, argv0, argv0, argv0, argv0, argv0, argv0, argv0, argv0);
+}
+
+int main(int argc, char **argv) {
+  BenchOptions options = { .iterations = 200 };
+  bool numerals = false;
+  bool collection = false;
+  bool launch = false;
+  bool lines = false;
+  bool bands = false;
+  bool spans = false;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--face") == 0 && i + 1 < argc) {
+      options.face_filter = argv[++i];
+    } else if (strcmp(argv[i], "--platform") == 0 && i + 1 < argc) {
+      options.platform_filter = argv[++i];
+    } else if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+      options.iterations = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--csv") == 0) {
+      options.csv = true;
+    } else if (strcmp(argv[i], "--check-layout") == 0) {
+      return layout_check_run() ? 1 : 0;
+    } else if (strcmp(argv[i], "--check-spans") == 0) {
+      return span_check_run() ? 1 : 0;
+    } else if (strcmp(argv[i], "--check-settings") == 0) {
+      return prv_check_settings() ? 1 : 0;
+    } else if (strcmp(argv[i], "--check-markers") == 0) {
+      return prv_check_markers() ? 1 : 0;
+    } else if (strcmp(argv[i], "--sweep") == 0) {
+      options.sweep = true;
+    } else if (strcmp(argv[i], "--power") == 0) {
+      options.power = true;
+    } else if (strcmp(argv[i], "--peek") == 0) {
+      options.peek = true;
+    } else if (strcmp(argv[i], "--tiers") == 0) {
+      options.tiers = true;
+    } else if (strcmp(argv[i], "--ticks") == 0) {
+      options.ticks = true;
+    } else if (strcmp(argv[i], "--day") == 0) {
+      options.day = true;
+    } else if (strcmp(argv[i], "--numerals") == 0) {
+      numerals = true;
+    } else if (strcmp(argv[i], "--collection") == 0) {
+      collection = true;
+    } else if (strcmp(argv[i], "--launch") == 0) {
+      launch = true;
+    } else if (strcmp(argv[i], "--lines") == 0) {
+      lines = true;
+    } else if (strcmp(argv[i], "--bands") == 0) {
+      bands = true;
+    } else if (strcmp(argv[i], "--spans") == 0) {
+      spans = true;
+    } else if (strcmp(argv[i], "--instrument") == 0) {
+      options.instrument = true;
+    } else if (strcmp(argv[i], "--profile") == 0) {
+      options.profile = true;
+    } else if (strcmp(argv[i], "--golden") == 0 && i + 1 < argc) {
+      options.golden_dir = argv[++i];
+    } else if (strcmp(argv[i], "--update") == 0) {
+      options.update = true;
+    } else if (strcmp(argv[i], "--dump") == 0 && i + 1 < argc) {
+      options.dump_dir = argv[++i];
+    } else {
+      prv_usage(argv[0]);
+      return 2;
+    }
+  }
+  if (options.iterations < 1) {
+    options.iterations = 1;
+  }
+  if (numerals) {
+    return prv_bench_numerals(&options) ? 1 : 0;
+  }
+  if (collection) {
+    return prv_bench_collection(&options) ? 1 : 0;
+  }
+  if (launch) {
+    return prv_bench_launch(&options) ? 1 : 0;
+  }
+  if (lines) {
+    return prv_bench_lines(&options) ? 1 : 0;
+  }
+  if (bands) {
+    return prv_bench_bands(&options) ? 1 : 0;
+  }
+  if (spans) {
+    return prv_bench_spans(&options) ? 1 : 0;
+  }
+  if (options.dump_dir) {
+    mkdir(options.dump_dir, 0755);
+  }
+  if (options.golden_dir && options.update) {
+    mkdir(options.golden_dir, 0755);
+  }
+
+  prv_print_header(&options);
+  int failures = 0;
+  for (size_t f = 0; f < NUM_FACES; f++) {
+    if (options.face_filter && strcmp(options.face_filter, s_faces[f].name) != 0) {
+      continue;
+    }
+    for (int p = 0; p < HostPlatformCount; p++) {
+      if (options.platform_filter && strcmp(options.platform_filter, host_platform_info(p)->name) != 0) {
+        continue;
+      }
+      failures += prv_run_face(&s_faces[f], (HostPlatform)p, &options);
+    }
+  }
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,429 @@
+// Minimal dependency-free PNG writer and reader: 8-bit palette images,
+// deflated with the fixed Huffman codes. The compressor only looks for
+// repeats of the previous pixel and of the row above, which is most of a
+// watchface; the reader inflates stored and fixed Huffman blocks, so it
+// reads what the writer writes but not every PNG.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_png.h"
+#include "pebble_host.h"
+
+#define MAX_MATCH 258
+
+static uint32_t s_crc_table[256];
+
+static const uint16_t s_length_base[29] = {
+  3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258,
+};
+static const uint8_t s_length_extra[29] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0,
+};
+static const uint16_t s_distance_base[30] = {
+  1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097,
+  6145, 8193, 12289, 16385, 24577,
+};
+static const uint8_t s_distance_extra[30] = {
+  0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13,
+};
+
+static void prv_init_crc(void) {
+  if (s_crc_table[1]) {
+    return;
+  }
+  for (uint32_t n = 0; n < 256; n++) {
+    uint32_t c = n;
+    for (int k = 0; k < 8; k++) {
+      c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+    }
+    s_crc_table[n] = c;
+  }
+}
+
+static uint32_t prv_crc(uint32_t crc, const uint8_t *data, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    crc = s_crc_table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+  }
+  return crc;
+}
+
+static uint32_t prv_adler(const uint8_t *data, size_t len) {
+  uint32_t a = 1, b = 0;
+  for (size_t i = 0; i < len; i++) {
+    a = (a + data[i]) % 65521;
+    b = (b + a) % 65521;
+  }
+  return (b << 16) | a;
+}
+
+static void prv_put_u32(uint8_t *p, uint32_t v) {
+  p[0] = (uint8_t)(v >> 24);
+  p[1] = (uint8_t)(v >> 16);
+  p[2] = (uint8_t)(v >> 8);
+  p[3] = (uint8_t)v;
+}
+
+static uint32_t prv_get_u32(const uint8_t *p) {
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static void prv_write_chunk(FILE *file, const char *type, const uint8_t *data, uint32_t len) {
+  uint8_t header[8];
+  prv_put_u32(header, len);
+  memcpy(header + 4, type, 4);
+  fwrite(header, 1, 8, file);
+  if (len) {
+    fwrite(data, 1, len, file);
+  }
+  uint32_t crc = prv_crc(0xFFFFFFFFu, (const uint8_t *)type, 4);
+  crc = prv_crc(crc, data, len) ^ 0xFFFFFFFFu;
+  uint8_t trailer[4];
+  prv_put_u32(trailer, crc);
+  fwrite(trailer, 1, 4, file);
+}
+
+// Deflate output, packed from the least significant bit as the format wants
+typedef struct {
+  uint8_t *data;
+  size_t len;
+  uint32_t bits;
+  int count;
+} BitWriter;
+
+static void prv_put_bits(BitWriter *w, uint32_t value, int n) {
+  w->bits |= value << w->count;
+  w->count += n;
+  while (w->count >= 8) {
+    w->data[w->len++] = (uint8_t)w->bits;
+    w->bits >>= 8;
+    w->count -= 8;
+  }
+}
+
+// Huffman codes go most significant bit first
+static void prv_put_code(BitWriter *w, uint32_t code, int n) {
+  uint32_t reversed = 0;
+  for (int i = 0; i < n; i++) {
+    reversed = (reversed << 1) | ((code >> i) & 1);
+  }
+  prv_put_bits(w, reversed, n);
+}
+
+static void prv_put_literal(BitWriter *w, int symbol) {
+  if (symbol < 144) {
+    prv_put_code(w, 0x30 + symbol, 8);
+  } else if (symbol < 256) {
+    prv_put_code(w, 0x190 + symbol - 144, 9);
+  } else if (symbol < 280) {
+    prv_put_code(w, symbol - 256, 7);
+  } else {
+    prv_put_code(w, 0xC0 + symbol - 280, 8);
+  }
+}
+
+static void prv_put_match(BitWriter *w, int length, int distance) {
+  int l = 28;
+  while (s_length_base[l] > length) {
+    l--;
+  }
+  prv_put_literal(w, 257 + l);
+  prv_put_bits(w, length - s_length_base[l], s_length_extra[l]);
+  int d = 29;
+  while (s_distance_base[d] > distance) {
+    d--;
+  }
+  prv_put_code(w, d, 5);
+  prv_put_bits(w, distance - s_distance_base[d], s_distance_extra[d]);
+}
+
+static size_t prv_match_length(const uint8_t *raw, size_t len, size_t pos, size_t distance) {
+  if (distance > pos) {
+    return 0;
+  }
+  size_t n = 0;
+  while (n < MAX_MATCH && pos + n < len && raw[pos + n] == raw[pos + n - distance]) {
+    n++;
+  }
+  return n;
+}
+
+// zlib stream of one fixed Huffman block; stride is the length of a row
+static uint8_t *prv_deflate(const uint8_t *raw, size_t len, size_t stride, size_t *out_len) {
+  // A literal is at most 9 bits
+  BitWriter w = { .data = malloc(2 + len * 9 / 8 + 16 + 4) };
+  w.data[w.len++] = 0x78;
+  w.data[w.len++] = 0x01;
+  prv_put_bits(&w, 1, 1);  // final block
+  prv_put_bits(&w, 1, 2);  // fixed Huffman codes
+  for (size_t pos = 0; pos < len;) {
+    size_t run = prv_match_length(raw, len, pos, 1);
+    size_t above = prv_match_length(raw, len, pos, stride);
+    size_t length = run > above ? run : above;
+    if (length >= 3) {
+      prv_put_match(&w, (int)length, run > above ? 1 : (int)stride);
+      pos += length;
+    } else {
+      prv_put_literal(&w, raw[pos++]);
+    }
+  }
+  prv_put_literal(&w, 256);
+  if (w.count) {
+    prv_put_bits(&w, 0, 8 - w.count);
+  }
+  prv_put_u32(w.data + w.len, prv_adler(raw, len));
+  *out_len = w.len + 4;
+  return w.data;
+}
+
+bool host_png_write_framebuffer(const char *path, int width, int height) {
+  prv_init_crc();
+
+  // Rows of palette indices, each behind its filter byte (none)
+  uint32_t palette[256];
+  int colors = 0;
+  size_t stride = 1 + (size_t)width;
+  size_t raw_len = (size_t)height * stride;
+  uint8_t *raw = malloc(raw_len);
+  uint8_t *p = raw;
+  for (int y = 0; y < height; y++) {
+    *p++ = 0;
+    for (int x = 0; x < width; x++) {
+      uint32_t rgb = host_framebuffer_visible(x, y) ? host_framebuffer_pixel(x, y) : 0;
+      int i = 0;
+      while (i < colors && palette[i] != rgb) {
+        i++;
+      }
+      if (i == colors) {
+        if (colors == 256) {
+          free(raw);
+          return false;
+        }
+        palette[colors++] = rgb;
+      }
+      *p++ = (uint8_t)i;
+    }
+  }
+
+  uint8_t plte[256 * 3];
+  for (int i = 0; i < colors; i++) {
+    plte[i * 3] = (uint8_t)(palette[i] >> 16);
+    plte[i * 3 + 1] = (uint8_t)(palette[i] >> 8);
+    plte[i * 3 + 2] = (uint8_t)palette[i];
+  }
+  size_t z_len;
+  uint8_t *z = prv_deflate(raw, raw_len, stride, &z_len);
+
+  bool ok = false;
+  FILE *file = fopen(path, "wb");
+  if (file) {
+    static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    fwrite(signature, 1, 8, file);
+    uint8_t ihdr[13];
+    prv_put_u32(ihdr, (uint32_t)width);
+    prv_put_u32(ihdr + 4, (uint32_t)height);
+    ihdr[8] = 8;   // bit depth
+    ihdr[9] = 3;   // color type: palette
+    ihdr[10] = 0;  // compression
+    ihdr[11] = 0;  // filter
+    ihdr[12] = 0;  // interlace
+    prv_write_chunk(file, "IHDR", ihdr, sizeof(ihdr));
+    prv_write_chunk(file, "PLTE", plte, (uint32_t)colors * 3);
+    prv_write_chunk(file, "IDAT", z, (uint32_t)z_len);
+    prv_write_chunk(file, "IEND", NULL, 0);
+    ok = fclose(file) == 0;
+  }
+  free(z);
+  free(raw);
+  return ok;
+}
+
+typedef struct {
+  const uint8_t *data;
+  size_t len;
+  size_t pos;
+  uint32_t bits;
+  int count;
+  bool overrun;
+} BitReader;
+
+static uint32_t prv_get_bits(BitReader *r, int n) {
+  while (r->count < n) {
+    if (r->pos == r->len) {
+      r->overrun = true;
+      return 0;
+    }
+    r->bits |= (uint32_t)r->data[r->pos++] << r->count;
+    r->count += 8;
+  }
+  uint32_t value = r->bits & ((1u << n) - 1);
+  r->bits >>= n;
+  r->count -= n;
+  return value;
+}
+
+static uint32_t prv_get_code(BitReader *r, int n) {
+  uint32_t code = 0;
+  for (int i = 0; i < n; i++) {
+    code = (code << 1) | prv_get_bits(r, 1);
+  }
+  return code;
+}
+
+static int prv_get_literal(BitReader *r) {
+  uint32_t code = prv_get_code(r, 7);
+  if (code <= 0x17) {
+    return 256 + code;
+  }
+  code = (code << 1) | prv_get_bits(r, 1);
+  if (code >= 0x30 && code <= 0xBF) {
+    return code - 0x30;
+  }
+  if (code >= 0xC0 && code <= 0xC7) {
+    return 280 + code - 0xC0;
+  }
+  code = (code << 1) | prv_get_bits(r, 1);
+  return 144 + code - 0x190;
+}
+
+// Inflates a zlib stream of stored and fixed Huffman blocks into exactly
+// out_len bytes
+static bool prv_inflate(const uint8_t *z, size_t z_len, uint8_t *out, size_t out_len) {
+  if (z_len < 6 || (z[0] & 0x0f) != 8) {
+    return false;
+  }
+  BitReader r = { .data = z + 2, .len = z_len - 2 };
+  size_t pos = 0;
+  bool last = false;
+  while (!last && !r.overrun) {
+    last = prv_get_bits(&r, 1);
+    int type = prv_get_bits(&r, 2);
+    if (type == 0) {
+      r.bits = 0;
+      r.count = 0;
+      if (r.pos + 4 > r.len) {
+        return false;
+      }
+      size_t n = r.data[r.pos] | (r.data[r.pos + 1] << 8);
+      r.pos += 4;
+      if (r.pos + n > r.len || pos + n > out_len) {
+        return false;
+      }
+      memcpy(out + pos, r.data + r.pos, n);
+      r.pos += n;
+      pos += n;
+    } else if (type == 1) {
+      for (;;) {
+        int symbol = prv_get_literal(&r);
+        if (r.overrun || symbol > 285) {
+          return false;
+        }
+        if (symbol < 256) {
+          if (pos == out_len) {
+            return false;
+          }
+          out[pos++] = (uint8_t)symbol;
+          continue;
+        }
+        if (symbol == 256) {
+          break;
+        }
+        size_t length = s_length_base[symbol - 257] + prv_get_bits(&r, s_length_extra[symbol - 257]);
+        int d = prv_get_code(&r, 5);
+        if (d > 29) {
+          return false;
+        }
+        size_t distance = s_distance_base[d] + prv_get_bits(&r, s_distance_extra[d]);
+        if (distance > pos || pos + length > out_len) {
+          return false;
+        }
+        for (size_t i = 0; i < length; i++, pos++) {
+          out[pos] = out[pos - distance];
+        }
+      }
+    } else {
+      // Dynamic Huffman codes; the writer never makes them
+      return false;
+    }
+  }
+  return !r.overrun && pos == out_len;
+}
+
+int host_png_diff_framebuffer(const char *path, int width, int height, int *first_x, int *first_y) {
+  FILE *file = fopen(path, "rb");
+  if (!file) {
+    return -1;
+  }
+  fseek(file, 0, SEEK_END);
+  long size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  uint8_t *png = malloc(size > 0 ? size : 1);
+  bool read = size > 8 && fread(png, 1, size, file) == (size_t)size;
+  fclose(file);
+
+  static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+  const uint8_t *ihdr = NULL;
+  const uint8_t *plte = NULL;
+  uint32_t colors = 0;
+  uint8_t *z = malloc(size > 0 ? size : 1);
+  size_t z_len = 0;
+  for (long pos = 8; read && pos + 12 <= size;) {
+    uint32_t len = prv_get_u32(png + pos);
+    const uint8_t *type = png + pos + 4;
+    const uint8_t *data = png + pos + 8;
+    if (len > (uint32_t)(size - pos - 12)) {
+      read = false;
+      break;
+    }
+    if (memcmp(type, "IHDR", 4) == 0 && len == 13) {
+      ihdr = data;
+    } else if (memcmp(type, "PLTE", 4) == 0) {
+      plte = data;
+      colors = len / 3;
+    } else if (memcmp(type, "IDAT", 4) == 0) {
+      memcpy(z + z_len, data, len);
+      z_len += len;
+    } else if (memcmp(type, "IEND", 4) == 0) {
+      break;
+    }
+    pos += 12 + len;
+  }
+
+  int diff = -1;
+  size_t stride = 1 + (size_t)width;
+  uint8_t *raw = malloc((size_t)height * stride);
+  if (read && memcmp(png, signature, 8) == 0 && ihdr && plte && prv_get_u32(ihdr) == (uint32_t)width &&
+      prv_get_u32(ihdr + 4) == (uint32_t)height && ihdr[8] == 8 && ihdr[9] == 3 && ihdr[12] == 0 &&
+      prv_inflate(z, z_len, raw, (size_t)height * stride)) {
+    diff = 0;
+    for (int y = 0; y < height && diff >= 0; y++) {
+      const uint8_t *row = raw + y * stride;
+      if (row[0] != 0) {
+        // Filtered rows; the writer never filters
+        diff = -1;
+        break;
+      }
+      for (int x = 0; x < width; x++) {
+        if (row[1 + x] >= colors) {
+          diff = -1;
+          break;
+        }
+        const uint8_t *c = plte + row[1 + x] * 3;
+        uint32_t expected = ((uint32_t)c[0] << 16) | ((uint32_t)c[1] << 8) | c[2];
+        uint32_t actual = host_framebuffer_visible(x, y) ? host_framebuffer_pixel(x, y) : 0;
+        if (actual != expected) {
+          if (!diff) {
+            *first_x = x;
+            *first_y = y;
+          }
+          diff++;
+        }
+      }
+    }
+  }
+  free(raw);
+  free(z);
+  free(png);
+  return diff;
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Writes the current host framebuffer as a palette PNG. Pixels outside the
+// visible display area (chalk's corners) are written black.
+bool host_png_write_framebuffer(const char *path, int width, int height);
+
+// Compares the current host framebuffer with a PNG host_png_write_framebuffer()
+// wrote. Returns the number of pixels that differ, the first of them in
+// *first_x, *first_y, or -1 if the file can't be read or is another size.
+int host_png_diff_framebuffer(const char *path, int width, int height, int *first_x, int *first_y);
@@ -0,0 +1,145 @@
+#include "layout_check.h"
+
+#include <pebble.h>
+#include <stdio.h>
+
+#include "ray_box.h"
+
+// Display sizes of the rect platforms, and chalk's
+static const GSize s_rect_sizes[] = { { 144, 168 }, { 200, 228 } };
+static const GSize s_round_sizes[] = { { 180, 180 } };
+
+#define NUM_RECT_SIZES (sizeof(s_rect_sizes) / sizeof(s_rect_sizes[0]))
+#define NUM_ROUND_SIZES (sizeof(s_round_sizes) / sizeof(s_round_sizes[0]))
+
+// Ranges wide enough to cover every face's insets and numeral images
+#define MAX_INSET 32
+#define MAX_IMAGE 48
+
+// Trio's rect dot placement before ray_box_exit()
+static GPoint prv_float_dot(GRect bounds, int32_t angle, int inset) {
+  GPoint center = grect_center_point(&bounds);
+  float sin_a = sin_lookup(angle) / (float)TRIG_MAX_RATIO;
+  float cos_a = -cos_lookup(angle) / (float)TRIG_MAX_RATIO;
+  float dist_to_edge;
+  if (sin_a > 0.01) {
+    float dist_right = (bounds.size.w - center.x - inset) / sin_a;
+    if (cos_a > 0.01 || cos_a < -0.01) {
+      float dist_vert = (cos_a > 0) ? (bounds.size.h - center.y - inset) / cos_a : (center.y - inset) / -cos_a;
+      dist_to_edge = (dist_right < dist_vert) ? dist_right : dist_vert;
+    } else {
+      dist_to_edge = dist_right;
+    }
+  } else if (sin_a < -0.01) {
+    float dist_left = (center.x - inset) / -sin_a;
+    if (cos_a > 0.01 || cos_a < -0.01) {
+      float dist_vert = (cos_a > 0) ? (bounds.size.h - center.y - inset) / cos_a : (center.y - inset) / -cos_a;
+      dist_to_edge = (dist_left < dist_vert) ? dist_left : dist_vert;
+    } else {
+      dist_to_edge = dist_left;
+    }
+  } else {
+    dist_to_edge = (cos_a > 0) ? (bounds.size.h - center.y - inset) : (center.y - inset);
+  }
+  return GPoint((int16_t)(sin_a * dist_to_edge) + center.x, (int16_t)(cos_a * dist_to_edge) + center.y);
+}
+
+// Trio's rect placement of the numeral at 10 (left) or 2 (right) o'clock
+static GPoint prv_float_number(GRect bounds, bool left, int inset, GSize size) {
+  GPoint center = grect_center_point(&bounds);
+  int32_t angle = TRIG_MAX_ANGLE * (left ? 10 : 2) / 12;
+  float sin_a = sin_lookup(angle) / (float)TRIG_MAX_RATIO;
+  float cos_a = -cos_lookup(angle) / (float)TRIG_MAX_RATIO;
+  float dist_to_side = left ? (inset + size.w / 2 - center.x) / sin_a
+                            : (bounds.size.w - inset - size.w / 2 - center.x) / sin_a;
+  float dist_to_top = (inset + size.h / 2 - center.y) / cos_a;
+  float dist = (dist_to_side < dist_to_top) ? dist_to_side : dist_to_top;
+  return GPoint((int16_t)(sin_a * dist) + center.x - size.w / 2, (int16_t)(cos_a * dist) + center.y - size.h / 2);
+}
+
+// Round placement of numerals at a radius
+static GPoint prv_float_radius(GPoint center, int32_t angle, int radius) {
+  float sin_a = sin_lookup(angle) / (float)TRIG_MAX_RATIO;
+  float cos_a = -cos_lookup(angle) / (float)TRIG_MAX_RATIO;
+  return GPoint((int16_t)(sin_a * radius) + center.x, (int16_t)(cos_a * radius) + center.y);
+}
+
+typedef struct {
+  int checks;
+  int off_by_one;
+  int failures;
+} CheckCounts;
+
+// The float code lands a pixel short of the edge whenever the product that
+// should give the edge coordinate rounds to just under it, so results one
+// pixel apart are expected; anything further is a failure.
+static void prv_compare(CheckCounts *counts, const char *what, GSize size, int32_t angle, int distance, int image,
+                        GPoint expected, GPoint actual) {
+  counts->checks++;
+  int dx = expected.x - actual.x;
+  int dy = expected.y - actual.y;
+  if (dx == 0 && dy == 0) {
+    return;
+  }
+  if (dx >= -1 && dx <= 1 && dy >= -1 && dy <= 1) {
+    counts->off_by_one++;
+    return;
+  }
+  counts->failures++;
+  printf("%s %dx%d angle=%ld distance=%d image=%d: float (%d, %d) integer (%d, %d)\n", what, size.w, size.h,
+         (long)angle, distance, image, expected.x, expected.y, actual.x, actual.y);
+}
+
+int layout_check_run(void) {
+  CheckCounts counts = { 0 };
+
+  for (size_t s = 0; s < NUM_RECT_SIZES; s++) {
+    GRect bounds = { GPointZero, s_rect_sizes[s] };
+    GPoint center = grect_center_point(&bounds);
+
+    // Dots, at every hour hand position
+    for (int inset = 0; inset <= MAX_INSET; inset++) {
+      RayBox box = { center.x - inset, center.y - inset, bounds.size.w - center.x - inset,
+                     bounds.size.h - center.y - inset };
+      for (int i = 0; i < 720; i++) {
+        int32_t angle = TRIG_MAX_ANGLE * i / 720;
+        GPoint exit = ray_box_exit(angle, box);
+        prv_compare(&counts, "dot", bounds.size, angle, inset, 0, prv_float_dot(bounds, angle, inset),
+                    GPoint(exit.x + center.x, exit.y + center.y));
+      }
+    }
+
+    // Numerals at 10 and 2 o'clock
+    for (int inset = 0; inset <= MAX_INSET; inset++) {
+      for (int side = 8; side <= MAX_IMAGE; side++) {
+        GSize image = GSize(side, side);
+        for (int left = 0; left <= 1; left++) {
+          RayBox box = { center.x - inset - image.w / 2, center.y - inset - image.h / 2,
+                         bounds.size.w - inset - image.w / 2 - center.x, 0 };
+          int32_t angle = TRIG_MAX_ANGLE * (left ? 10 : 2) / 12;
+          GPoint exit = ray_box_exit(angle, box);
+          GPoint origin = GPoint(exit.x + center.x - image.w / 2, exit.y + center.y - image.h / 2);
+          prv_compare(&counts, "number", bounds.size, angle, inset, side, prv_float_number(bounds, left, inset, image),
+                      origin);
+        }
+      }
+    }
+  }
+
+  for (size_t s = 0; s < NUM_ROUND_SIZES; s++) {
+    GRect bounds = { GPointZero, s_round_sizes[s] };
+    GPoint center = grect_center_point(&bounds);
+    for (int radius = 0; radius <= bounds.size.w / 2; radius++) {
+      for (int i = 0; i < 720; i++) {
+        int32_t angle = TRIG_MAX_ANGLE * i / 720;
+        GPoint point = ray_point(angle, radius);
+        prv_compare(&counts, "radius", bounds.size, angle, radius, 0, prv_float_radius(center, angle, radius),
+                    GPoint(point.x + center.x, point.y + center.y));
+      }
+    }
+  }
+
+  printf("layout check: %d placements, %d one pixel off the float result, %d failures\n", counts.checks,
+         counts.off_by_one, counts.failures);
+  return counts.failures;
+}
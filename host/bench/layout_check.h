@@ -0,0 +1,6 @@
+#pragma once
+
+// Checks the shared integer layout solvers in common/src/c against the float
+// code they replaced, for every display size. Prints each placement more
+// than a pixel off and returns how many there were.
+int layout_check_run(void);
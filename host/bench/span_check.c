@@ -0,0 +1,117 @@
+#include "span_check.h"
+
+#include <pebble.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "span_fill.h"
+
+// As wide as emery's rows, with runs starting and ending past either side
+#define ROW_WIDTH 200
+#define OVERHANG 2
+// Bytes around the row that a fill must leave alone
+#define GUARD 8
+#define BUFFER_SIZE (GUARD + ROW_WIDTH + 3 + GUARD)
+#define MAX_REPORTS 8
+
+typedef struct {
+  int16_t min_x;
+  int16_t max_x;
+} VisibleRange;
+
+// The whole row, and ranges like those of chalk's rows
+static const VisibleRange s_ranges[] = {
+  { 0, ROW_WIDTH - 1 },
+  { 3, ROW_WIDTH - 4 },
+  { 13, ROW_WIDTH - 14 },
+  { 90, 109 },
+};
+
+#define NUM_RANGES (sizeof(s_ranges) / sizeof(s_ranges[0]))
+
+static const GColor8 s_colors[] = {
+  { .argb = 0xc0 },  // black
+  { .argb = 0xff },  // white
+  { .argb = 0xea },  // light gray
+  { .argb = 0xd5 },  // dark gray
+  { .argb = 0xf4 },  // red
+  { .argb = 0xfe },  // a light color
+};
+
+#define NUM_COLORS (sizeof(s_colors) / sizeof(s_colors[0]))
+
+static void prv_fill_pattern(uint8_t *buffer) {
+  uint32_t seed = 0x2545f491u;
+  for (int i = 0; i < BUFFER_SIZE; i++) {
+    seed = seed * 1103515245u + 12345u;
+    buffer[i] = (uint8_t)(seed >> 16);
+  }
+}
+
+// The SDK's 1-bit mapping, pixel by pixel
+static bool prv_bw_bit(GColor color, int x, int y) {
+  if (color.r == color.g && color.g == color.b && (color.r == 1 || color.r == 2)) {
+    return ((x + y) & 1) != 0;
+  }
+  return color.r + color.g + color.b >= 5;
+}
+
+static void prv_reference(uint8_t *row, bool bw, int16_t y, int x0, int x1, VisibleRange range, GColor color) {
+  if (x0 < range.min_x) x0 = range.min_x;
+  if (x1 > range.max_x) x1 = range.max_x;
+  for (int x = x0; x <= x1; x++) {
+    if (!bw) {
+      row[x] = color.argb;
+    } else if (prv_bw_bit(color, x, y)) {
+      row[x / 8] |= (uint8_t)(1 << (x % 8));
+    } else {
+      row[x / 8] &= (uint8_t)~(1 << (x % 8));
+    }
+  }
+}
+
+int span_check_run(void) {
+  // Word aligned, so offset 0 is an aligned row
+  static uint32_t expected_words[(BUFFER_SIZE + 3) / 4];
+  static uint32_t actual_words[(BUFFER_SIZE + 3) / 4];
+  uint8_t *expected = (uint8_t *)expected_words;
+  uint8_t *actual = (uint8_t *)actual_words;
+  uint32_t fills = 0;
+  int failures = 0;
+
+  for (int bw = 0; bw < 2; bw++) {
+    // 1-bit rows are word aligned on the watch; the others are checked too
+    for (int offset = 0; offset < 4; offset++) {
+      for (size_t r = 0; r < NUM_RANGES; r++) {
+        for (int16_t y = 0; y < 2; y++) {
+          for (size_t c = 0; c < NUM_COLORS; c++) {
+            for (int x0 = -OVERHANG; x0 < ROW_WIDTH + OVERHANG; x0++) {
+              for (int x1 = x0 - 1; x1 < ROW_WIDTH + OVERHANG; x1++) {
+                prv_fill_pattern(expected);
+                prv_fill_pattern(actual);
+                uint8_t *row = expected + GUARD + offset;
+                prv_reference(row, bw, y, x0, x1, s_ranges[r], s_colors[c]);
+                GBitmapDataRowInfo info = {
+                  .data = actual + GUARD + offset,
+                  .min_x = s_ranges[r].min_x,
+                  .max_x = s_ranges[r].max_x,
+                };
+                span_fill(&info, bw, y, x0, x1, s_colors[c]);
+                fills++;
+                if (memcmp(expected, actual, BUFFER_SIZE) != 0) {
+                  if (failures < MAX_REPORTS) {
+                    printf("span %s offset %d range %d-%d row %d color %02x: %d-%d differs\n", bw ? "1-bit" : "8-bit",
+                           offset, s_ranges[r].min_x, s_ranges[r].max_x, y, s_colors[c].argb, x0, x1);
+                  }
+                  failures++;
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+  printf("span check: %u fills, %d failures\n", fills, failures);
+  return failures;
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+// Checks span_fill() (common/src/c/span_fill.h) against a fill that sets
+// one pixel at a time, for every run of a row as wide as any display's, at
+// every alignment of the row, on 8-bit and 1-bit rows, within several
+// visible ranges. Prints the first runs that differ and returns how many
+// there were.
+int span_check_run(void);
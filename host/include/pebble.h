@@ -0,0 +1,624 @@
+#pragma once
+
+// Host-side stand-in for the Pebble SDK header.
+//
+// Only the slice of the SDK surface used by the faces in this collection is
+// provided. Each face translation unit is compiled once per platform with one
+// of PBL_PLATFORM_APLITE / BASALT / CHALK / EMERY defined, exactly like the
+// real SDK build, so PBL_IF_* and #ifdef PBL_* branches resolve the same way.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// The shim itself is built once for all platforms (HOST_SHIM) and has no
+// face-specific generated headers
+#ifndef HOST_SHIM
+#include "message_keys.auto.h"
+#include "resource_ids.auto.h"
+#endif
+
+// Platform
+
+#if defined(PBL_PLATFORM_APLITE) || defined(PBL_PLATFORM_DIORITE)
+#define PBL_BW 1
+#define PBL_RECT 1
+#define PBL_DISPLAY_WIDTH 144
+#define PBL_DISPLAY_HEIGHT 168
+#elif defined(PBL_PLATFORM_BASALT)
+#define PBL_COLOR 1
+#define PBL_HEALTH 1
+#define PBL_RECT 1
+#define PBL_DISPLAY_WIDTH 144
+#define PBL_DISPLAY_HEIGHT 168
+#elif defined(PBL_PLATFORM_CHALK)
+#define PBL_COLOR 1
+#define PBL_HEALTH 1
+#define PBL_ROUND 1
+#define PBL_DISPLAY_WIDTH 180
+#define PBL_DISPLAY_HEIGHT 180
+#elif defined(PBL_PLATFORM_EMERY)
+#define PBL_COLOR 1
+#define PBL_HEALTH 1
+#define PBL_RECT 1
+#define PBL_DISPLAY_WIDTH 200
+#define PBL_DISPLAY_HEIGHT 228
+#elif !defined(HOST_SHIM)
+#error "Define one of PBL_PLATFORM_APLITE, PBL_PLATFORM_BASALT, PBL_PLATFORM_CHALK or PBL_PLATFORM_EMERY"
+#endif
+
+#define PBL_SDK_3 1
+
+// PBL_API_EXISTS(name) is true for the SDK calls the platform has, of those
+// that some platforms lack. Aplite has no Timeline Quick View.
+#define PBL_API_EXISTS(api) PBL_API_EXISTS_##api
+#ifndef PBL_PLATFORM_APLITE
+#define PBL_API_EXISTS_layer_get_unobstructed_bounds 1
+#define PBL_API_EXISTS_unobstructed_area_service_subscribe 1
+#define PBL_API_EXISTS_unobstructed_area_service_unsubscribe 1
+#endif
+
+#ifdef PBL_RECT
+#define PBL_IF_RECT_ELSE(if_true, if_false) (if_true)
+#define PBL_IF_ROUND_ELSE(if_true, if_false) (if_false)
+#else
+#define PBL_IF_RECT_ELSE(if_true, if_false) (if_false)
+#define PBL_IF_ROUND_ELSE(if_true, if_false) (if_true)
+#endif
+
+#ifdef PBL_COLOR
+#define PBL_IF_COLOR_ELSE(if_true, if_false) (if_true)
+#define PBL_IF_BW_ELSE(if_true, if_false) (if_false)
+#else
+#define PBL_IF_COLOR_ELSE(if_true, if_false) (if_false)
+#define PBL_IF_BW_ELSE(if_true, if_false) (if_true)
+#endif
+
+// Logging
+
+typedef enum {
+  APP_LOG_LEVEL_ERROR = 1,
+  APP_LOG_LEVEL_WARNING = 50,
+  APP_LOG_LEVEL_INFO = 100,
+  APP_LOG_LEVEL_DEBUG = 200,
+  APP_LOG_LEVEL_DEBUG_VERBOSE = 255,
+} AppLogLevel;
+
+void app_log(uint8_t log_level, const char *src_filename, int src_line_number, const char *fmt, ...)
+    __attribute__((format(printf, 4, 5)));
+
+#define APP_LOG(level, fmt, ...) app_log(level, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
+
+// Trigonometry
+
+#define TRIG_MAX_RATIO 0xffff
+#define TRIG_MAX_ANGLE 0x10000
+#define DEG_TO_TRIGANGLE(angle) (((angle) * TRIG_MAX_ANGLE) / 360)
+#define TRIGANGLE_TO_DEG(trig_angle) (((trig_angle) * 360) / TRIG_MAX_ANGLE)
+
+int32_t sin_lookup(int32_t angle);
+int32_t cos_lookup(int32_t angle);
+int32_t atan2_lookup(int16_t y, int16_t x);
+
+// Geometry
+
+typedef struct GPoint {
+  int16_t x;
+  int16_t y;
+} GPoint;
+
+#define GPoint(x, y) ((GPoint){(x), (y)})
+#define GPointZero GPoint(0, 0)
+
+typedef struct GSize {
+  int16_t w;
+  int16_t h;
+} GSize;
+
+#define GSize(w, h) ((GSize){(w), (h)})
+#define GSizeZero GSize(0, 0)
+
+typedef struct GRect {
+  GPoint origin;
+  GSize size;
+} GRect;
+
+#define GRect(x, y, w, h) ((GRect){{(x), (y)}, {(w), (h)}})
+#define GRectZero GRect(0, 0, 0, 0)
+
+GPoint grect_center_point(const GRect *rect);
+bool gpoint_equal(const GPoint *const point_a, const GPoint *const point_b);
+bool grect_equal(const GRect *const rect_a, const GRect *const rect_b);
+
+// Colors
+
+typedef union GColor8 {
+  uint8_t argb;
+  struct {
+    uint8_t b : 2;
+    uint8_t g : 2;
+    uint8_t r : 2;
+    uint8_t a : 2;
+  };
+} GColor8;
+
+typedef GColor8 GColor;
+
+#define GColorFromRGBA(red, green, blue, alpha) \
+  ((GColor8){ .a = (uint8_t)(alpha) >> 6, .r = (uint8_t)(red) >> 6, .g = (uint8_t)(green) >> 6, .b = (uint8_t)(blue) >> 6 })
+#define GColorFromRGB(red, green, blue) GColorFromRGBA(red, green, blue, 255)
+#define GColorFromHEX(v) GColorFromRGB(((v) >> 16) & 0xff, ((v) >> 8) & 0xff, ((v) & 0xff))
+
+#define GColorClear ((GColor8){ .argb = 0x00 })
+#define GColorBlack GColorFromHEX(0x000000)
+#define GColorOxfordBlue GColorFromHEX(0x000055)
+#define GColorDukeBlue GColorFromHEX(0x0000AA)
+#define GColorBlue GColorFromHEX(0x0000FF)
+#define GColorDarkGreen GColorFromHEX(0x005500)
+#define GColorMidnightGreen GColorFromHEX(0x005555)
+#define GColorCobaltBlue GColorFromHEX(0x0055AA)
+#define GColorBlueMoon GColorFromHEX(0x0055FF)
+#define GColorIslamicGreen GColorFromHEX(0x00AA00)
+#define GColorJaegerGreen GColorFromHEX(0x00AA55)
+#define GColorTiffanyBlue GColorFromHEX(0x00AAAA)
+#define GColorVividCerulean GColorFromHEX(0x00AAFF)
+#define GColorGreen GColorFromHEX(0x00FF00)
+#define GColorMalachite GColorFromHEX(0x00FF55)
+#define GColorMediumSpringGreen GColorFromHEX(0x00FFAA)
+#define GColorCyan GColorFromHEX(0x00FFFF)
+#define GColorBulgarianRose GColorFromHEX(0x550000)
+#define GColorImperialPurple GColorFromHEX(0x550055)
+#define GColorIndigo GColorFromHEX(0x5500AA)
+#define GColorElectricUltramarine GColorFromHEX(0x5500FF)
+#define GColorArmyGreen GColorFromHEX(0x555500)
+#define GColorDarkGray GColorFromHEX(0x555555)
+#define GColorLiberty GColorFromHEX(0x5555AA)
+#define GColorVeryLightBlue GColorFromHEX(0x5555FF)
+#define GColorKellyGreen GColorFromHEX(0x55AA00)
+#define GColorMayGreen GColorFromHEX(0x55AA55)
+#define GColorCadetBlue GColorFromHEX(0x55AAAA)
+#define GColorPictonBlue GColorFromHEX(0x55AAFF)
+#define GColorBrightGreen GColorFromHEX(0x55FF00)
+#define GColorScreaminGreen GColorFromHEX(0x55FF55)
+#define GColorMediumAquamarine GColorFromHEX(0x55FFAA)
+#define GColorElectricBlue GColorFromHEX(0x55FFFF)
+#define GColorDarkCandyAppleRed GColorFromHEX(0xAA0000)
+#define GColorJazzberryJam GColorFromHEX(0xAA0055)
+#define GColorPurple GColorFromHEX(0xAA00AA)
+#define GColorVividViolet GColorFromHEX(0xAA00FF)
+#define GColorWindsorTan GColorFromHEX(0xAA5500)
+#define GColorRoseVale GColorFromHEX(0xAA5555)
+#define GColorPurpureus GColorFromHEX(0xAA55AA)
+#define GColorLavenderIndigo GColorFromHEX(0xAA55FF)
+#define GColorLimerick GColorFromHEX(0xAAAA00)
+#define GColorBrass GColorFromHEX(0xAAAA55)
+#define GColorLightGray GColorFromHEX(0xAAAAAA)
+#define GColorBabyBlueEyes GColorFromHEX(0xAAAAFF)
+#define GColorSpringBud GColorFromHEX(0xAAFF00)
+#define GColorInchworm GColorFromHEX(0xAAFF55)
+#define GColorMintGreen GColorFromHEX(0xAAFFAA)
+#define GColorCeleste GColorFromHEX(0xAAFFFF)
+#define GColorRed GColorFromHEX(0xFF0000)
+#define GColorFolly GColorFromHEX(0xFF0055)
+#define GColorFashionMagenta GColorFromHEX(0xFF00AA)
+#define GColorMagenta GColorFromHEX(0xFF00FF)
+#define GColorOrange GColorFromHEX(0xFF5500)
+#define GColorSunsetOrange GColorFromHEX(0xFF5555)
+#define GColorBrilliantRose GColorFromHEX(0xFF55AA)
+#define GColorShockingPink GColorFromHEX(0xFF55FF)
+#define GColorChromeYellow GColorFromHEX(0xFFAA00)
+#define GColorRajah GColorFromHEX(0xFFAA55)
+#define GColorMelon GColorFromHEX(0xFFAAAA)
+#define GColorRichBrilliantLavender GColorFromHEX(0xFFAAFF)
+#define GColorYellow GColorFromHEX(0xFFFF00)
+#define GColorIcterine GColorFromHEX(0xFFFF55)
+#define GColorPastelYellow GColorFromHEX(0xFFFFAA)
+#define GColorWhite GColorFromHEX(0xFFFFFF)
+
+bool gcolor_equal(GColor8 x, GColor8 y);
+
+// Graphics
+
+typedef struct GContext GContext;
+
+typedef enum {
+  GCornerNone = 0,
+  GCornerTopLeft = 1 << 0,
+  GCornerTopRight = 1 << 1,
+  GCornerBottomLeft = 1 << 2,
+  GCornerBottomRight = 1 << 3,
+  GCornersAll = GCornerTopLeft | GCornerTopRight | GCornerBottomLeft | GCornerBottomRight,
+  GCornersTop = GCornerTopLeft | GCornerTopRight,
+  GCornersBottom = GCornerBottomLeft | GCornerBottomRight,
+  GCornersLeft = GCornerTopLeft | GCornerBottomLeft,
+  GCornersRight = GCornerTopRight | GCornerBottomRight,
+} GCornerMask;
+
+typedef enum {
+  GOvalScaleModeFitCircle,
+  GOvalScaleModeFillCircle,
+} GOvalScaleMode;
+
+void graphics_context_set_stroke_color(GContext *ctx, GColor color);
+void graphics_context_set_fill_color(GContext *ctx, GColor color);
+void graphics_context_set_stroke_width(GContext *ctx, uint8_t stroke_width);
+void graphics_context_set_antialiased(GContext *ctx, bool enable);
+
+void graphics_draw_pixel(GContext *ctx, GPoint point);
+void graphics_draw_line(GContext *ctx, GPoint p0, GPoint p1);
+void graphics_draw_rect(GContext *ctx, GRect rect);
+void graphics_fill_rect(GContext *ctx, GRect rect, uint16_t corner_radius, GCornerMask corner_mask);
+void graphics_draw_circle(GContext *ctx, GPoint p, uint16_t radius);
+void graphics_fill_circle(GContext *ctx, GPoint p, uint16_t radius);
+void graphics_fill_radial(GContext *ctx, GRect rect, GOvalScaleMode scale_mode, uint16_t inset,
+                          int32_t angle_start, int32_t angle_end);
+
+// Bitmaps and direct frame buffer access
+
+typedef struct GBitmap GBitmap;
+
+typedef enum {
+  GBitmapFormat1Bit = 0,
+  GBitmapFormat8Bit,
+  GBitmapFormat1BitPalette,
+  GBitmapFormat2BitPalette,
+  GBitmapFormat4BitPalette,
+  GBitmapFormat8BitCircular,
+} GBitmapFormat;
+
+typedef struct GBitmapDataRowInfo {
+  uint8_t *data;
+  int16_t min_x;
+  int16_t max_x;
+} GBitmapDataRowInfo;
+
+GBitmap *graphics_capture_frame_buffer(GContext *ctx);
+bool graphics_release_frame_buffer(GContext *ctx, GBitmap *buffer);
+uint8_t *gbitmap_get_data(const GBitmap *bitmap);
+uint16_t gbitmap_get_bytes_per_row(const GBitmap *bitmap);
+GBitmapFormat gbitmap_get_format(const GBitmap *bitmap);
+GRect gbitmap_get_bounds(const GBitmap *bitmap);
+GBitmapDataRowInfo gbitmap_get_data_row_info(const GBitmap *bitmap, uint16_t y);
+
+// Paths
+
+typedef struct GPathInfo {
+  uint32_t num_points;
+  GPoint *points;
+} GPathInfo;
+
+typedef struct GPath {
+  uint32_t num_points;
+  GPoint *points;
+  int32_t rotation;
+  GPoint offset;
+} GPath;
+
+GPath *gpath_create(const GPathInfo *init);
+void gpath_destroy(GPath *gpath);
+void gpath_draw_filled(GContext *ctx, GPath *path);
+void gpath_draw_outline(GContext *ctx, GPath *path);
+void gpath_rotate_to(GPath *path, int32_t angle);
+void gpath_move_to(GPath *path, GPoint point);
+
+// Draw commands (PDC)
+
+typedef struct GDrawCommand GDrawCommand;
+typedef struct GDrawCommandList GDrawCommandList;
+typedef struct GDrawCommandImage GDrawCommandImage;
+
+typedef enum {
+  GDrawCommandTypeInvalid = 0,
+  GDrawCommandTypePath,
+  GDrawCommandTypeCircle,
+  GDrawCommandTypePrecisePath,
+} GDrawCommandType;
+
+typedef bool (*GDrawCommandListIteratorCb)(GDrawCommand *command, uint32_t index, void *context);
+
+GDrawCommandImage *gdraw_command_image_create_with_resource(uint32_t resource_id);
+void gdraw_command_image_destroy(GDrawCommandImage *image);
+void gdraw_command_image_draw(GContext *ctx, GDrawCommandImage *image, GPoint offset);
+GSize gdraw_command_image_get_bounds_size(GDrawCommandImage *image);
+GDrawCommandList *gdraw_command_image_get_command_list(GDrawCommandImage *image);
+
+void gdraw_command_list_iterate(GDrawCommandList *command_list, GDrawCommandListIteratorCb handle_command,
+                                void *callback_context);
+uint32_t gdraw_command_list_get_num_commands(GDrawCommandList *command_list);
+GDrawCommand *gdraw_command_list_get_command(GDrawCommandList *command_list, uint16_t command_idx);
+
+GDrawCommandType gdraw_command_get_type(GDrawCommand *command);
+GColor gdraw_command_get_fill_color(GDrawCommand *command);
+void gdraw_command_set_fill_color(GDrawCommand *command, GColor fill_color);
+GColor gdraw_command_get_stroke_color(GDrawCommand *command);
+void gdraw_command_set_stroke_color(GDrawCommand *command, GColor stroke_color);
+uint8_t gdraw_command_get_stroke_width(GDrawCommand *command);
+void gdraw_command_set_stroke_width(GDrawCommand *command, uint8_t stroke_width);
+bool gdraw_command_get_hidden(GDrawCommand *command);
+void gdraw_command_set_hidden(GDrawCommand *command, bool hidden);
+
+// Layers and windows
+
+typedef struct Layer Layer;
+typedef struct Window Window;
+
+typedef void (*LayerUpdateProc)(Layer *layer, GContext *ctx);
+
+Layer *layer_create(GRect frame);
+Layer *layer_create_with_data(GRect frame, size_t data_size);
+void layer_destroy(Layer *layer);
+void *layer_get_data(const Layer *layer);
+void layer_mark_dirty(Layer *layer);
+void layer_set_update_proc(Layer *layer, LayerUpdateProc update_proc);
+void layer_add_child(Layer *parent, Layer *child);
+void layer_remove_from_parent(Layer *child);
+GRect layer_get_frame(const Layer *layer);
+void layer_set_frame(Layer *layer, GRect frame);
+GRect layer_get_bounds(const Layer *layer);
+#ifndef PBL_PLATFORM_APLITE
+// The part of the bounds no Timeline Quick View peek covers
+GRect layer_get_unobstructed_bounds(const Layer *layer);
+#endif
+void layer_set_bounds(Layer *layer, GRect bounds);
+void layer_set_hidden(Layer *layer, bool hidden);
+
+typedef void (*WindowHandler)(Window *window);
+
+typedef struct WindowHandlers {
+  WindowHandler load;
+  WindowHandler appear;
+  WindowHandler disappear;
+  WindowHandler unload;
+} WindowHandlers;
+
+Window *window_create(void);
+void window_destroy(Window *window);
+void window_set_window_handlers(Window *window, WindowHandlers handlers);
+void window_set_background_color(Window *window, GColor background_color);
+Layer *window_get_root_layer(const Window *window);
+void window_stack_push(Window *window, bool animated);
+
+// Tick timer
+
+typedef enum {
+  SECOND_UNIT = 1 << 0,
+  MINUTE_UNIT = 1 << 1,
+  HOUR_UNIT = 1 << 2,
+  DAY_UNIT = 1 << 3,
+  MONTH_UNIT = 1 << 4,
+  YEAR_UNIT = 1 << 5,
+} TimeUnits;
+
+typedef void (*TickHandler)(struct tm *tick_time, TimeUnits units_changed);
+
+void tick_timer_service_subscribe(TimeUnits tick_units, TickHandler handler);
+void tick_timer_service_unsubscribe(void);
+
+// App timers. They fire at the harness's next host_render(), ahead of the
+// frame, however long their timeout; the harness can hold them back.
+
+typedef struct AppTimer AppTimer;
+typedef void (*AppTimerCallback)(void *data);
+
+AppTimer *app_timer_register(uint32_t timeout_ms, AppTimerCallback callback, void *callback_data);
+void app_timer_cancel(AppTimer *timer_handle);
+
+// App focus
+
+typedef void (*AppFocusHandler)(bool in_focus);
+
+typedef struct AppFocusHandlers {
+  AppFocusHandler will_focus;
+  AppFocusHandler did_focus;
+} AppFocusHandlers;
+
+void app_focus_service_subscribe_handlers(AppFocusHandlers handlers);
+void app_focus_service_unsubscribe(void);
+
+// Unobstructed area. Timeline Quick View peeks are played by the harness.
+// Left out for aplite, as in its SDK.
+
+typedef int32_t AnimationProgress;
+
+#define ANIMATION_NORMALIZED_MIN 0
+#define ANIMATION_NORMALIZED_MAX 65535
+
+#ifndef PBL_PLATFORM_APLITE
+
+typedef void (*UnobstructedAreaWillChangeHandler)(GRect final_unobstructed_screen_area, void *context);
+typedef void (*UnobstructedAreaChangeHandler)(AnimationProgress progress, void *context);
+typedef void (*UnobstructedAreaDidChangeHandler)(void *context);
+
+typedef struct UnobstructedAreaHandlers {
+  UnobstructedAreaWillChangeHandler will_change;
+  UnobstructedAreaChangeHandler change;
+  UnobstructedAreaDidChangeHandler did_change;
+} UnobstructedAreaHandlers;
+
+void unobstructed_area_service_subscribe(UnobstructedAreaHandlers handlers, void *context);
+void unobstructed_area_service_unsubscribe(void);
+
+#endif
+
+// Battery. The charge is set by the harness.
+
+typedef struct {
+  uint8_t charge_percent;
+  bool is_charging;
+  bool is_plugged;
+} BatteryChargeState;
+
+typedef void (*BatteryStateHandler)(BatteryChargeState charge);
+
+BatteryChargeState battery_state_service_peek(void);
+void battery_state_service_subscribe(BatteryStateHandler handler);
+void battery_state_service_unsubscribe(void);
+
+// Health. The current activities are set by the harness.
+
+typedef enum {
+  HealthActivityNone = 0,
+  HealthActivitySleep = 1 << 0,
+  HealthActivityRestfulSleep = 1 << 1,
+  HealthActivityWalk = 1 << 2,
+  HealthActivityRun = 1 << 3,
+  HealthActivityOpenWorkout = 1 << 4,
+} HealthActivity;
+
+typedef uint32_t HealthActivityMask;
+
+HealthActivityMask health_service_peek_current_activities(void);
+
+// Accelerometer. Readings and taps come from the harness.
+
+typedef struct {
+  int16_t x;
+  int16_t y;
+  int16_t z;
+  bool did_vibrate;
+  uint64_t timestamp;
+} AccelData;
+
+typedef enum {
+  ACCEL_AXIS_X = 0,
+  ACCEL_AXIS_Y = 1,
+  ACCEL_AXIS_Z = 2,
+} AccelAxisType;
+
+typedef void (*AccelTapHandler)(AccelAxisType axis, int32_t direction);
+typedef void (*AccelDataHandler)(AccelData *data, uint32_t num_samples);
+
+typedef enum {
+  ACCEL_SAMPLING_10HZ = 10,
+  ACCEL_SAMPLING_25HZ = 25,
+  ACCEL_SAMPLING_50HZ = 50,
+  ACCEL_SAMPLING_100HZ = 100,
+} AccelSamplingRate;
+
+// As on the watch, peeking fails unless accel data is subscribed to
+int accel_service_peek(AccelData *data);
+int accel_service_set_sampling_rate(AccelSamplingRate rate);
+void accel_data_service_subscribe(uint32_t samples_per_update, AccelDataHandler handler);
+void accel_data_service_unsubscribe(void);
+void accel_tap_service_subscribe(AccelTapHandler handler);
+void accel_tap_service_unsubscribe(void);
+
+// Wall time. The host clock is driven by the harness, not the OS.
+
+time_t host_time(time_t *tloc);
+struct tm *host_localtime(const time_t *timep);
+// Runs on from the harness's time at the OS clock's pace, so durations
+// measured with it are real
+uint16_t time_ms(time_t *tloc, uint16_t *out_ms);
+
+#define time(tloc) host_time(tloc)
+#define localtime(timep) host_localtime(timep)
+
+// Dictionary and AppMessage
+
+typedef enum {
+  TUPLE_BYTE_ARRAY = 0,
+  TUPLE_CSTRING = 1,
+  TUPLE_UINT = 2,
+  TUPLE_INT = 3,
+} TupleType;
+
+typedef struct __attribute__((__packed__)) Tuple {
+  uint32_t key;
+  TupleType type : 8;
+  uint16_t length;
+  union {
+    uint8_t data[0];
+    char cstring[0];
+    uint8_t uint8;
+    uint16_t uint16;
+    uint32_t uint32;
+    int8_t int8;
+    int16_t int16;
+    int32_t int32;
+  } value[];
+} Tuple;
+
+typedef struct DictionaryIterator {
+  const uint8_t *dictionary;
+  const void *end;
+  Tuple *cursor;
+} DictionaryIterator;
+
+typedef enum {
+  DICT_OK = 0,
+  DICT_NOT_ENOUGH_STORAGE = 1 << 1,
+  DICT_INVALID_ARGS = 1 << 2,
+} DictionaryResult;
+
+DictionaryResult dict_write_begin(DictionaryIterator *iter, uint8_t *const buffer, const uint16_t size);
+DictionaryResult dict_write_data(DictionaryIterator *iter, const uint32_t key, const uint8_t *const data,
+                                 const uint16_t size);
+DictionaryResult dict_write_int32(DictionaryIterator *iter, const uint32_t key, const int32_t value);
+uint32_t dict_write_end(DictionaryIterator *iter);
+Tuple *dict_read_begin_from_buffer(DictionaryIterator *iter, const uint8_t *const buffer, const uint16_t size);
+Tuple *dict_read_next(DictionaryIterator *iter);
+Tuple *dict_find(const DictionaryIterator *iter, const uint32_t key);
+
+typedef enum {
+  APP_MSG_OK = 0,
+  APP_MSG_SEND_TIMEOUT = 1 << 1,
+  APP_MSG_SEND_REJECTED = 1 << 2,
+  APP_MSG_NOT_CONNECTED = 1 << 3,
+  APP_MSG_APP_NOT_RUNNING = 1 << 4,
+  APP_MSG_INVALID_ARGS = 1 << 5,
+  APP_MSG_BUSY = 1 << 6,
+  APP_MSG_BUFFER_OVERFLOW = 1 << 7,
+  APP_MSG_ALREADY_RELEASED = 1 << 9,
+  APP_MSG_CALLBACK_ALREADY_REGISTERED = 1 << 10,
+  APP_MSG_CALLBACK_NOT_REGISTERED = 1 << 11,
+  APP_MSG_OUT_OF_MEMORY = 1 << 12,
+  APP_MSG_CLOSED = 1 << 13,
+  APP_MSG_INTERNAL_ERROR = 1 << 14,
+} AppMessageResult;
+
+typedef void (*AppMessageInboxReceived)(DictionaryIterator *iterator, void *context);
+
+AppMessageResult app_message_open(const uint32_t size_inbound, const uint32_t size_outbound);
+AppMessageInboxReceived app_message_register_inbox_received(AppMessageInboxReceived received_callback);
+AppMessageResult app_message_outbox_begin(DictionaryIterator **iterator);
+AppMessageResult app_message_outbox_send(void);
+
+// Persistent storage
+
+#define PERSIST_DATA_MAX_LENGTH 256
+
+bool persist_exists(const uint32_t key);
+bool persist_read_bool(const uint32_t key);
+int32_t persist_read_int(const uint32_t key);
+int persist_read_data(const uint32_t key, void *buffer, const size_t buffer_size);
+int persist_write_bool(const uint32_t key, const bool value);
+int persist_write_int(const uint32_t key, const int32_t value);
+int persist_write_data(const uint32_t key, const void *data, const size_t size);
+int persist_delete(const uint32_t key);
+
+// Heap. Faces allocate from a simulated app heap sized for the platform, so
+// malloc fails where it would on the watch and usage can be measured.
+
+size_t heap_bytes_free(void);
+size_t heap_bytes_used(void);
+
+void *host_malloc(size_t size);
+void *host_calloc(size_t count, size_t size);
+void *host_realloc(void *ptr, size_t size);
+void host_free(void *ptr);
+
+#ifndef HOST_SHIM
+#define malloc(size) host_malloc(size)
+#define calloc(count, size) host_calloc(count, size)
+#define realloc(ptr, size) host_realloc(ptr, size)
+#define free(ptr) host_free(ptr)
+#endif
+
+// Event loop. On the host this hands control to the harness.
+
+void app_event_loop(void);
@@ -0,0 +1,177 @@
+#pragma once
+
+// Harness-side control surface of the host Pebble shim: platform selection,
+// framebuffer access, the simulated clock, message injection and per-frame
+// rendering statistics. Faces never include this header.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+typedef enum {
+  HostPlatformAplite,
+  HostPlatformBasalt,
+  HostPlatformChalk,
+  HostPlatformEmery,
+  HostPlatformCount,
+} HostPlatform;
+
+typedef enum {
+  HostPrimFillRect,
+  HostPrimDrawRect,
+  HostPrimFillCircle,
+  HostPrimDrawCircle,
+  HostPrimFillRadial,
+  HostPrimDrawLine,
+  HostPrimDrawPixel,
+  HostPrimPathFilled,
+  HostPrimPathOutline,
+  HostPrimDrawCommandImage,
+  HostPrimCaptureFrameBuffer,
+  HostPrimCount,
+} HostPrim;
+
+typedef struct {
+  uint32_t prims[HostPrimCount];
+  // Pixels written by drawing primitives
+  uint64_t pixels;
+  // Pixels changed through graphics_capture_frame_buffer(), found by diffing
+  // the frame at release; only tracked while accounting is enabled
+  uint64_t direct_pixels;
+  // Heap blocks allocated, and the most heap in use above the level at the
+  // last stats reset
+  uint32_t allocations;
+  size_t heap_high_water;
+} HostFrameStats;
+
+typedef struct {
+  const char *name;
+  uint16_t width;
+  uint16_t height;
+  bool color;
+  bool round;
+  uint32_t heap_size;
+  // Rows a Timeline Quick View peek covers at the bottom of the screen, 0
+  // where there is no Quick View
+  uint16_t peek_height;
+} HostPlatformInfo;
+
+typedef struct {
+  const char *name;
+  uint32_t id;
+} HostNamedId;
+
+// Generated per face from its package.json by tools/gen_auto_headers.py
+typedef struct {
+  const char *name;
+  const HostNamedId *message_keys;
+  const HostNamedId *resources;
+  const char *const *resource_files;
+} HostFaceManifest;
+
+typedef int (*HostFaceMain)(void);
+typedef void (*HostEventLoop)(void *context);
+
+const HostPlatformInfo *host_platform_info(HostPlatform platform);
+const char *host_prim_name(HostPrim prim);
+
+// APP_LOG output goes to stderr only when enabled
+void host_set_log_enabled(bool enabled);
+
+// Resets all shim state and selects the platform and face manifest for the
+// next run. host_run() then calls face_main, which reaches app_event_loop(),
+// which calls loop(context); the face is torn down when loop returns.
+void host_reset(HostPlatform platform, const HostFaceManifest *manifest);
+int host_run(HostFaceMain face_main, HostEventLoop loop, void *context);
+
+uint32_t host_manifest_message_key(const HostFaceManifest *manifest, const char *name);
+
+void host_set_time(time_t now);
+// The faces read it through FACE_CLOCK (common/src/c/face_clock.h)
+time_t host_get_time(void);
+
+// Fires the subscribed tick handler (if any) for the current host time
+void host_tick(uint32_t units_changed);
+
+// Tells the app it lost or regained focus, as around a notification
+void host_focus(bool in_focus);
+
+// Sets the battery state and fires the subscribed handler (if any)
+void host_set_battery(uint8_t charge_percent, bool plugged);
+
+// What the health service reports as the current activities
+void host_set_activities(uint32_t activities);
+
+// The reading accel_service_peek() returns, in milli-g
+void host_set_accel(int16_t x, int16_t y, int16_t z);
+
+// Fires the subscribed tap handler (if any), as a flick of the wrist
+void host_tap(void);
+
+// Rows a Timeline Quick View peek covers at the bottom of the screen, set
+// without an animation, as when the app starts under one
+void host_set_obstruction(uint16_t rows);
+
+// Plays a peek animation towards covering rows (0 to clear the screen):
+// host_peek_begin() calls the will_change handler, each host_peek_step() the
+// change handler with that progress, and host_peek_end() did_change.
+// layer_get_unobstructed_bounds() follows the animation.
+void host_peek_begin(uint16_t rows);
+void host_peek_step(int32_t progress);
+void host_peek_end(void);
+
+// Delivers an inbox message built from parallel key / value arrays. What the
+// app sent before it is forgotten, so host_sent_data() sees its replies.
+void host_send_message(const uint32_t *keys, const int32_t *values, int count);
+
+// Value of key in the last message the app sent, or NULL
+const uint8_t *host_sent_data(uint32_t key, uint16_t *length);
+
+// Renders the window stack into the framebuffer if anything is dirty, or
+// unconditionally when force is set. Returns true if a frame was drawn.
+// App timers pending by then fire first, as events queued ahead of the frame.
+bool host_render(bool force);
+
+// While held, host_render() leaves the app's timers pending, as on the watch
+// for the frames drawn before they expire
+void host_hold_timers(bool held);
+
+// A fresh context drawing to the whole screen, for calling the drawing API
+// outside of a render
+struct GContext *host_screen_context(void);
+
+void host_stats_reset(void);
+const HostFrameStats *host_stats(void);
+
+// Enables the bookkeeping behind direct_pixels. It copies the frame on every
+// capture, so keep it off while timing.
+void host_set_accounting(bool enabled);
+
+// The last frame a face's display list (common/src/c/display_list.h) ended
+typedef struct {
+  uint32_t frames;
+  uint32_t commands;
+  // Commands that differ from the frame before
+  uint32_t changed;
+  uint32_t regions;
+  // Area of the regions that get redrawn
+  uint32_t dirty_pixels;
+} HostDisplayListStats;
+
+const HostDisplayListStats *host_display_list_stats(void);
+
+// Persist writes and deletes since the last reset; each costs a flash write
+// on the watch
+uint32_t host_persist_writes(void);
+
+// Simulated app heap
+size_t host_heap_peak(void);
+void host_heap_reset_peak(void);
+
+// Framebuffer readback as 0xRRGGBB, for image dumps
+uint32_t host_framebuffer_pixel(int x, int y);
+bool host_framebuffer_visible(int x, int y);
+
+// Hash of the visible framebuffer contents, to compare frames across builds
+uint64_t host_framebuffer_digest(void);
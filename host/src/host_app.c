@@ -0,0 +1,854 @@
+#include <stdarg.h>
+
+#include "host_internal.h"
+
+// Windows, layers, services and storage for a single face instance. All of
+// it is torn down by host_reset() so consecutive runs start from scratch.
+
+struct Layer {
+  GRect frame;
+  GRect bounds;
+  LayerUpdateProc update_proc;
+  Layer *parent;
+  Layer *first_child;
+  Layer *next_sibling;
+  bool hidden;
+  void *data;
+};
+
+struct Window {
+  Layer *root_layer;
+  WindowHandlers handlers;
+  GColor background_color;
+  bool loaded;
+};
+
+struct AppTimer {
+  AppTimerCallback callback;
+  void *data;
+  bool pending;
+};
+
+#define MAX_WINDOWS 4
+#define MAX_PERSIST_KEYS 64
+#define MAX_TIMERS 8
+
+typedef struct {
+  uint32_t key;
+  uint16_t size;
+  uint8_t data[PERSIST_DATA_MAX_LENGTH];
+} PersistEntry;
+
+static HostPlatform s_platform;
+static const HostFaceManifest *s_manifest;
+
+static Window *s_window_stack[MAX_WINDOWS];
+static int s_window_count;
+static bool s_dirty;
+
+static AppTimer s_timers[MAX_TIMERS];
+static bool s_timers_held;
+
+static TickHandler s_tick_handler;
+static AppFocusHandlers s_focus_handlers;
+static AccelTapHandler s_tap_handler;
+static BatteryStateHandler s_battery_handler;
+static BatteryChargeState s_battery;
+static uint32_t s_activities;
+static AccelData s_accel;
+static bool s_accel_subscribed;
+static UnobstructedAreaHandlers s_unobstructed_handlers;
+static void *s_unobstructed_context;
+// Rows the peek covers now, and where its animation started and ends
+static int32_t s_obstruction;
+static int32_t s_peek_from;
+static int32_t s_peek_to;
+static TimeUnits s_tick_units;
+static AppMessageInboxReceived s_inbox_handler;
+static uint32_t s_inbox_size;
+static uint32_t s_outbox_size;
+// The outbox being written, and the last message sent from it
+static uint8_t s_outbox[512];
+static DictionaryIterator s_outbox_iter;
+static bool s_outbox_open;
+static uint8_t s_sent[512];
+static uint32_t s_sent_size;
+
+static PersistEntry s_persist[MAX_PERSIST_KEYS];
+static int s_persist_count;
+static uint32_t s_persist_writes;
+
+static time_t s_now;
+// OS clock when s_now was set, in ms
+static uint64_t s_now_set_ms;
+static struct tm s_tm;
+
+static HostEventLoop s_loop;
+static void *s_loop_context;
+
+static bool s_log_enabled;
+
+const HostFaceManifest *host_manifest(void) {
+  return s_manifest;
+}
+
+HostPlatform host_platform(void) {
+  return s_platform;
+}
+
+void host_reset(HostPlatform platform, const HostFaceManifest *manifest) {
+  s_platform = platform;
+  s_manifest = manifest;
+  s_window_count = 0;
+  s_dirty = false;
+  memset(s_timers, 0, sizeof(s_timers));
+  s_timers_held = false;
+  s_tick_handler = NULL;
+  s_tick_units = 0;
+  s_focus_handlers = (AppFocusHandlers) { 0 };
+  s_tap_handler = NULL;
+  s_battery_handler = NULL;
+  s_battery = (BatteryChargeState) { .charge_percent = 100 };
+  s_activities = HealthActivityNone;
+  // Lying face up
+  s_accel = (AccelData) { .z = -1000 };
+  s_accel_subscribed = false;
+  s_unobstructed_handlers = (UnobstructedAreaHandlers) { 0 };
+  s_unobstructed_context = NULL;
+  s_obstruction = s_peek_from = s_peek_to = 0;
+  host_display_list_reset();
+  s_inbox_handler = NULL;
+  s_inbox_size = 0;
+  s_outbox_size = 0;
+  s_outbox_open = false;
+  s_sent_size = 0;
+  s_persist_count = 0;
+  s_persist_writes = 0;
+  host_heap_reset();
+  host_graphics_init(platform);
+}
+
+int host_run(HostFaceMain face_main, HostEventLoop loop, void *context) {
+  s_loop = loop;
+  s_loop_context = context;
+  return face_main();
+}
+
+void app_event_loop(void) {
+  if (s_loop) {
+    s_loop(s_loop_context);
+  }
+}
+
+uint32_t host_manifest_message_key(const HostFaceManifest *manifest, const char *name) {
+  for (const HostNamedId *entry = manifest->message_keys; entry->name; entry++) {
+    if (strcmp(entry->name, name) == 0) {
+      return entry->id;
+    }
+  }
+  return 0;
+}
+
+void host_set_log_enabled(bool enabled) {
+  s_log_enabled = enabled;
+}
+
+void app_log(uint8_t log_level, const char *src_filename, int src_line_number, const char *fmt, ...) {
+  if (!s_log_enabled) {
+    return;
+  }
+  va_list args;
+  va_start(args, fmt);
+  fprintf(stderr, "[%u] %s:%d ", log_level, src_filename, src_line_number);
+  vfprintf(stderr, fmt, args);
+  fputc('\n', stderr);
+  va_end(args);
+}
+
+// Time
+
+static uint64_t prv_monotonic_ms(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+void host_set_time(time_t now) {
+  s_now = now;
+  s_now_set_ms = prv_monotonic_ms();
+}
+
+time_t host_get_time(void) {
+  return s_now;
+}
+
+time_t host_time(time_t *tloc) {
+  if (tloc) {
+    *tloc = s_now;
+  }
+  return s_now;
+}
+
+uint16_t time_ms(time_t *tloc, uint16_t *out_ms) {
+  uint64_t elapsed = prv_monotonic_ms() - s_now_set_ms;
+  uint16_t ms = elapsed % 1000;
+  if (tloc) {
+    *tloc = s_now + elapsed / 1000;
+  }
+  if (out_ms) {
+    *out_ms = ms;
+  }
+  return ms;
+}
+
+// The host clock is always UTC so runs do not depend on the machine's zone
+struct tm *host_localtime(const time_t *timep) {
+  gmtime_r(timep, &s_tm);
+  return &s_tm;
+}
+
+void tick_timer_service_subscribe(TimeUnits tick_units, TickHandler handler) {
+  s_tick_units = tick_units;
+  s_tick_handler = handler;
+}
+
+void tick_timer_service_unsubscribe(void) {
+  s_tick_handler = NULL;
+  s_tick_units = 0;
+}
+
+AppTimer *app_timer_register(uint32_t timeout_ms, AppTimerCallback callback, void *callback_data) {
+  for (int i = 0; i < MAX_TIMERS; i++) {
+    if (!s_timers[i].pending) {
+      s_timers[i] = (AppTimer) { .callback = callback, .data = callback_data, .pending = true };
+      return &s_timers[i];
+    }
+  }
+  return NULL;
+}
+
+void app_timer_cancel(AppTimer *timer_handle) {
+  if (timer_handle) {
+    timer_handle->pending = false;
+  }
+}
+
+void host_hold_timers(bool held) {
+  s_timers_held = held;
+}
+
+// Fires the timers pending now; those their callbacks register wait for the
+// next frame
+static void prv_fire_timers(void) {
+  bool due[MAX_TIMERS];
+  for (int i = 0; i < MAX_TIMERS; i++) {
+    due[i] = s_timers[i].pending;
+  }
+  for (int i = 0; i < MAX_TIMERS; i++) {
+    if (due[i] && s_timers[i].pending) {
+      s_timers[i].pending = false;
+      s_timers[i].callback(s_timers[i].data);
+    }
+  }
+}
+
+void app_focus_service_subscribe_handlers(AppFocusHandlers handlers) {
+  s_focus_handlers = handlers;
+}
+
+void app_focus_service_unsubscribe(void) {
+  s_focus_handlers = (AppFocusHandlers) { 0 };
+}
+
+void host_focus(bool in_focus) {
+  if (s_focus_handlers.will_focus) {
+    s_focus_handlers.will_focus(in_focus);
+  }
+  if (s_focus_handlers.did_focus) {
+    s_focus_handlers.did_focus(in_focus);
+  }
+}
+
+BatteryChargeState battery_state_service_peek(void) {
+  return s_battery;
+}
+
+void battery_state_service_subscribe(BatteryStateHandler handler) {
+  s_battery_handler = handler;
+}
+
+void battery_state_service_unsubscribe(void) {
+  s_battery_handler = NULL;
+}
+
+void host_set_battery(uint8_t charge_percent, bool plugged) {
+  s_battery = (BatteryChargeState) { .charge_percent = charge_percent, .is_charging = plugged, .is_plugged = plugged };
+  if (s_battery_handler) {
+    s_battery_handler(s_battery);
+  }
+}
+
+HealthActivityMask health_service_peek_current_activities(void) {
+  return s_activities;
+}
+
+void host_set_activities(uint32_t activities) {
+  s_activities = activities;
+}
+
+int accel_service_peek(AccelData *data) {
+  if (!s_accel_subscribed) {
+    return -1;
+  }
+  *data = s_accel;
+  return 0;
+}
+
+int accel_service_set_sampling_rate(AccelSamplingRate rate) {
+  return 0;
+}
+
+void accel_data_service_subscribe(uint32_t samples_per_update, AccelDataHandler handler) {
+  s_accel_subscribed = true;
+}
+
+void accel_data_service_unsubscribe(void) {
+  s_accel_subscribed = false;
+}
+
+void host_set_accel(int16_t x, int16_t y, int16_t z) {
+  s_accel.x = x;
+  s_accel.y = y;
+  s_accel.z = z;
+}
+
+void accel_tap_service_subscribe(AccelTapHandler handler) {
+  s_tap_handler = handler;
+}
+
+void accel_tap_service_unsubscribe(void) {
+  s_tap_handler = NULL;
+}
+
+void host_tap(void) {
+  if (s_tap_handler) {
+    s_tap_handler(ACCEL_AXIS_Z, 1);
+  }
+}
+
+void unobstructed_area_service_subscribe(UnobstructedAreaHandlers handlers, void *context) {
+  s_unobstructed_handlers = handlers;
+  s_unobstructed_context = context;
+}
+
+void unobstructed_area_service_unsubscribe(void) {
+  s_unobstructed_handlers = (UnobstructedAreaHandlers) { 0 };
+  s_unobstructed_context = NULL;
+}
+
+static GRect prv_unobstructed_screen(int32_t rows) {
+  const HostPlatformInfo *info = host_platform_info(s_platform);
+  return GRect(0, 0, info->width, info->height - rows);
+}
+
+void host_set_obstruction(uint16_t rows) {
+  s_obstruction = s_peek_from = s_peek_to = rows;
+}
+
+void host_peek_begin(uint16_t rows) {
+  s_peek_from = s_obstruction;
+  s_peek_to = rows;
+  if (s_unobstructed_handlers.will_change) {
+    s_unobstructed_handlers.will_change(prv_unobstructed_screen(rows), s_unobstructed_context);
+  }
+}
+
+void host_peek_step(int32_t progress) {
+  s_obstruction = s_peek_from + (s_peek_to - s_peek_from) * progress / ANIMATION_NORMALIZED_MAX;
+  if (s_unobstructed_handlers.change) {
+    s_unobstructed_handlers.change(progress, s_unobstructed_context);
+  }
+}
+
+void host_peek_end(void) {
+  s_obstruction = s_peek_from = s_peek_to;
+  if (s_unobstructed_handlers.did_change) {
+    s_unobstructed_handlers.did_change(s_unobstructed_context);
+  }
+}
+
+void host_tick(uint32_t units_changed) {
+  if (!s_tick_handler) {
+    return;
+  }
+  struct tm tick_time;
+  gmtime_r(&s_now, &tick_time);
+  s_tick_handler(&tick_time, (TimeUnits)units_changed);
+}
+
+// Layers
+
+Layer *layer_create(GRect frame) {
+  return layer_create_with_data(frame, 0);
+}
+
+Layer *layer_create_with_data(GRect frame, size_t data_size) {
+  Layer *layer = host_calloc(1, sizeof(Layer));
+  if (!layer) {
+    return NULL;
+  }
+  layer->frame = frame;
+  layer->bounds = GRect(0, 0, frame.size.w, frame.size.h);
+  if (data_size) {
+    layer->data = host_calloc(1, data_size);
+  }
+  return layer;
+}
+
+void layer_remove_from_parent(Layer *child) {
+  if (!child || !child->parent) {
+    return;
+  }
+  Layer **link = &child->parent->first_child;
+  while (*link && *link != child) {
+    link = &(*link)->next_sibling;
+  }
+  if (*link) {
+    *link = child->next_sibling;
+  }
+  child->parent = NULL;
+  child->next_sibling = NULL;
+}
+
+void layer_destroy(Layer *layer) {
+  if (!layer) {
+    return;
+  }
+  layer_remove_from_parent(layer);
+  for (Layer *child = layer->first_child; child; child = child->next_sibling) {
+    child->parent = NULL;
+  }
+  host_free(layer->data);
+  host_free(layer);
+}
+
+void *layer_get_data(const Layer *layer) {
+  return layer->data;
+}
+
+void layer_mark_dirty(Layer *layer) {
+  if (layer) {
+    s_dirty = true;
+  }
+}
+
+void layer_set_update_proc(Layer *layer, LayerUpdateProc update_proc) {
+  layer->update_proc = update_proc;
+}
+
+void layer_add_child(Layer *parent, Layer *child) {
+  layer_remove_from_parent(child);
+  child->parent = parent;
+  Layer **link = &parent->first_child;
+  while (*link) {
+    link = &(*link)->next_sibling;
+  }
+  *link = child;
+  s_dirty = true;
+}
+
+GRect layer_get_frame(const Layer *layer) {
+  return layer->frame;
+}
+
+void layer_set_frame(Layer *layer, GRect frame) {
+  layer->frame = frame;
+  layer->bounds.size = frame.size;
+  s_dirty = true;
+}
+
+GRect layer_get_bounds(const Layer *layer) {
+  return layer->bounds;
+}
+
+static GRect prv_intersect(GRect a, GRect b);
+
+GRect layer_get_unobstructed_bounds(const Layer *layer) {
+  // Where the layer's bounds origin lands on the screen
+  GPoint origin = GPointZero;
+  for (const Layer *l = layer; l; l = l->parent) {
+    origin.x += l->frame.origin.x + l->bounds.origin.x;
+    origin.y += l->frame.origin.y + l->bounds.origin.y;
+  }
+  GRect screen = prv_unobstructed_screen(s_obstruction);
+  screen.origin.x -= origin.x;
+  screen.origin.y -= origin.y;
+  return prv_intersect(layer->bounds, screen);
+}
+
+void layer_set_bounds(Layer *layer, GRect bounds) {
+  layer->bounds = bounds;
+  s_dirty = true;
+}
+
+void layer_set_hidden(Layer *layer, bool hidden) {
+  layer->hidden = hidden;
+  s_dirty = true;
+}
+
+// Windows
+
+Window *window_create(void) {
+  Window *window = host_calloc(1, sizeof(Window));
+  if (!window) {
+    return NULL;
+  }
+  const HostPlatformInfo *info = host_platform_info(s_platform);
+  window->root_layer = layer_create(GRect(0, 0, info->width, info->height));
+  window->background_color = GColorWhite;
+  return window;
+}
+
+void window_destroy(Window *window) {
+  if (!window) {
+    return;
+  }
+  for (int i = 0; i < s_window_count; i++) {
+    if (s_window_stack[i] == window) {
+      memmove(&s_window_stack[i], &s_window_stack[i + 1], sizeof(Window *) * (s_window_count - i - 1));
+      s_window_count--;
+      break;
+    }
+  }
+  if (window->loaded && window->handlers.unload) {
+    window->handlers.unload(window);
+  }
+  layer_destroy(window->root_layer);
+  host_free(window);
+}
+
+void window_set_window_handlers(Window *window, WindowHandlers handlers) {
+  window->handlers = handlers;
+}
+
+void window_set_background_color(Window *window, GColor background_color) {
+  window->background_color = background_color;
+  s_dirty = true;
+}
+
+Layer *window_get_root_layer(const Window *window) {
+  return window->root_layer;
+}
+
+void window_stack_push(Window *window, bool animated) {
+  if (s_window_count == MAX_WINDOWS) {
+    return;
+  }
+  s_window_stack[s_window_count++] = window;
+  if (!window->loaded) {
+    window->loaded = true;
+    if (window->handlers.load) {
+      window->handlers.load(window);
+    }
+  }
+  if (window->handlers.appear) {
+    window->handlers.appear(window);
+  }
+  s_dirty = true;
+}
+
+// Rendering
+
+static GRect prv_intersect(GRect a, GRect b) {
+  int x0 = a.origin.x > b.origin.x ? a.origin.x : b.origin.x;
+  int y0 = a.origin.y > b.origin.y ? a.origin.y : b.origin.y;
+  int ax1 = a.origin.x + a.size.w;
+  int bx1 = b.origin.x + b.size.w;
+  int ay1 = a.origin.y + a.size.h;
+  int by1 = b.origin.y + b.size.h;
+  int x1 = ax1 < bx1 ? ax1 : bx1;
+  int y1 = ay1 < by1 ? ay1 : by1;
+  if (x1 <= x0 || y1 <= y0) {
+    return GRectZero;
+  }
+  return GRect(x0, y0, x1 - x0, y1 - y0);
+}
+
+static void prv_render_layer(Layer *layer, GPoint parent_origin, GRect parent_clip) {
+  if (layer->hidden) {
+    return;
+  }
+  GPoint origin = GPoint(parent_origin.x + layer->frame.origin.x, parent_origin.y + layer->frame.origin.y);
+  GRect frame = GRect(origin.x, origin.y, layer->frame.size.w, layer->frame.size.h);
+  GRect clip = prv_intersect(frame, parent_clip);
+  GPoint draw_origin = GPoint(origin.x + layer->bounds.origin.x, origin.y + layer->bounds.origin.y);
+
+  if (layer->update_proc) {
+    GContext ctx;
+    host_context_init(&ctx, draw_origin, clip);
+    layer->update_proc(layer, &ctx);
+  }
+  for (Layer *child = layer->first_child; child; child = child->next_sibling) {
+    prv_render_layer(child, draw_origin, clip);
+  }
+}
+
+bool host_render(bool force) {
+  if (!s_timers_held) {
+    prv_fire_timers();
+  }
+  if (s_window_count == 0 || (!s_dirty && !force)) {
+    return false;
+  }
+  s_dirty = false;
+
+  Window *window = s_window_stack[s_window_count - 1];
+  const HostPlatformInfo *info = host_platform_info(s_platform);
+  GRect screen = GRect(0, 0, info->width, info->height);
+
+  if (window->background_color.a) {
+    GContext ctx;
+    host_context_init(&ctx, GPointZero, screen);
+    for (int y = 0; y < info->height; y++) {
+      host_fill_span(&ctx, y, 0, info->width - 1, window->background_color);
+    }
+  }
+  prv_render_layer(window->root_layer, GPointZero, screen);
+  return true;
+}
+
+struct GContext *host_screen_context(void) {
+  static GContext ctx;
+  const HostPlatformInfo *info = host_platform_info(s_platform);
+  host_context_init(&ctx, GPointZero, GRect(0, 0, info->width, info->height));
+  return &ctx;
+}
+
+// Dictionaries. Tuples are packed back to back after a one byte count.
+
+DictionaryResult dict_write_begin(DictionaryIterator *iter, uint8_t *const buffer, const uint16_t size) {
+  if (!iter || !buffer || size < 1) {
+    return DICT_INVALID_ARGS;
+  }
+  buffer[0] = 0;
+  iter->dictionary = buffer;
+  iter->end = buffer + size;
+  iter->cursor = (Tuple *)(buffer + 1);
+  return DICT_OK;
+}
+
+DictionaryResult dict_write_data(DictionaryIterator *iter, const uint32_t key, const uint8_t *const data,
+                                 const uint16_t size) {
+  uint8_t *cursor = (uint8_t *)iter->cursor;
+  if (cursor + sizeof(Tuple) + size > (const uint8_t *)iter->end) {
+    return DICT_NOT_ENOUGH_STORAGE;
+  }
+  Tuple *tuple = iter->cursor;
+  tuple->key = key;
+  tuple->type = TUPLE_BYTE_ARRAY;
+  tuple->length = size;
+  memcpy(tuple->value, data, size);
+  iter->cursor = (Tuple *)(cursor + sizeof(Tuple) + size);
+  ((uint8_t *)iter->dictionary)[0]++;
+  return DICT_OK;
+}
+
+DictionaryResult dict_write_int32(DictionaryIterator *iter, const uint32_t key, const int32_t value) {
+  uint8_t *cursor = (uint8_t *)iter->cursor;
+  if (cursor + sizeof(Tuple) + sizeof(int32_t) > (const uint8_t *)iter->end) {
+    return DICT_NOT_ENOUGH_STORAGE;
+  }
+  Tuple *tuple = iter->cursor;
+  tuple->key = key;
+  tuple->type = TUPLE_INT;
+  tuple->length = sizeof(int32_t);
+  memcpy(tuple->value, &value, sizeof(int32_t));
+  iter->cursor = (Tuple *)(cursor + sizeof(Tuple) + sizeof(int32_t));
+  ((uint8_t *)iter->dictionary)[0]++;
+  return DICT_OK;
+}
+
+uint32_t dict_write_end(DictionaryIterator *iter) {
+  iter->end = iter->cursor;
+  return (uint32_t)((const uint8_t *)iter->cursor - iter->dictionary);
+}
+
+Tuple *dict_read_begin_from_buffer(DictionaryIterator *iter, const uint8_t *const buffer, const uint16_t size) {
+  iter->dictionary = buffer;
+  iter->end = buffer + size;
+  iter->cursor = (Tuple *)(buffer + 1);
+  return buffer[0] ? iter->cursor : NULL;
+}
+
+Tuple *dict_read_next(DictionaryIterator *iter) {
+  uint8_t *next = (uint8_t *)iter->cursor + sizeof(Tuple) + iter->cursor->length;
+  if (next >= (const uint8_t *)iter->end) {
+    return NULL;
+  }
+  iter->cursor = (Tuple *)next;
+  return iter->cursor;
+}
+
+Tuple *dict_find(const DictionaryIterator *iter, const uint32_t key) {
+  uint8_t count = iter->dictionary[0];
+  uint8_t *cursor = (uint8_t *)(iter->dictionary + 1);
+  for (uint8_t i = 0; i < count && cursor < (const uint8_t *)iter->end; i++) {
+    Tuple *tuple = (Tuple *)cursor;
+    if (tuple->key == key) {
+      return tuple;
+    }
+    cursor += sizeof(Tuple) + tuple->length;
+  }
+  return NULL;
+}
+
+// AppMessage
+
+AppMessageResult app_message_open(const uint32_t size_inbound, const uint32_t size_outbound) {
+  s_inbox_size = size_inbound;
+  s_outbox_size = size_outbound;
+  return APP_MSG_OK;
+}
+
+AppMessageInboxReceived app_message_register_inbox_received(AppMessageInboxReceived received_callback) {
+  AppMessageInboxReceived previous = s_inbox_handler;
+  s_inbox_handler = received_callback;
+  return previous;
+}
+
+// Messages are delivered as soon as they are sent, so the outbox is never busy
+AppMessageResult app_message_outbox_begin(DictionaryIterator **iterator) {
+  if (!s_outbox_size) {
+    return APP_MSG_INVALID_ARGS;
+  }
+  uint32_t size = s_outbox_size < sizeof(s_outbox) ? s_outbox_size : sizeof(s_outbox);
+  dict_write_begin(&s_outbox_iter, s_outbox, (uint16_t)size);
+  s_outbox_open = true;
+  *iterator = &s_outbox_iter;
+  return APP_MSG_OK;
+}
+
+AppMessageResult app_message_outbox_send(void) {
+  if (!s_outbox_open) {
+    return APP_MSG_INVALID_ARGS;
+  }
+  s_outbox_open = false;
+  s_sent_size = dict_write_end(&s_outbox_iter);
+  memcpy(s_sent, s_outbox, s_sent_size);
+  return APP_MSG_OK;
+}
+
+const uint8_t *host_sent_data(uint32_t key, uint16_t *length) {
+  if (!s_sent_size) {
+    return NULL;
+  }
+  DictionaryIterator iter;
+  dict_read_begin_from_buffer(&iter, s_sent, (uint16_t)s_sent_size);
+  Tuple *tuple = dict_find(&iter, key);
+  if (!tuple) {
+    return NULL;
+  }
+  *length = tuple->length;
+  return tuple->value->data;
+}
+
+void host_send_message(const uint32_t *keys, const int32_t *values, int count) {
+  s_sent_size = 0;
+  if (!s_inbox_handler) {
+    return;
+  }
+  uint8_t buffer[512];
+  DictionaryIterator iter;
+  dict_write_begin(&iter, buffer, sizeof(buffer));
+  for (int i = 0; i < count; i++) {
+    dict_write_int32(&iter, keys[i], values[i]);
+  }
+  uint32_t size = dict_write_end(&iter);
+  if (s_inbox_size && size > s_inbox_size) {
+    return;
+  }
+  DictionaryIterator read;
+  dict_read_begin_from_buffer(&read, buffer, (uint16_t)size);
+  s_inbox_handler(&read, NULL);
+}
+
+// Persistent storage
+
+static PersistEntry *prv_persist_find(uint32_t key) {
+  for (int i = 0; i < s_persist_count; i++) {
+    if (s_persist[i].key == key) {
+      return &s_persist[i];
+    }
+  }
+  return NULL;
+}
+
+static PersistEntry *prv_persist_slot(uint32_t key) {
+  PersistEntry *entry = prv_persist_find(key);
+  if (!entry && s_persist_count < MAX_PERSIST_KEYS) {
+    entry = &s_persist[s_persist_count++];
+    entry->key = key;
+    entry->size = 0;
+  }
+  return entry;
+}
+
+bool persist_exists(const uint32_t key) {
+  return prv_persist_find(key) != NULL;
+}
+
+bool persist_read_bool(const uint32_t key) {
+  return persist_read_int(key) != 0;
+}
+
+int32_t persist_read_int(const uint32_t key) {
+  PersistEntry *entry = prv_persist_find(key);
+  int32_t value = 0;
+  if (entry) {
+    memcpy(&value, entry->data, entry->size < sizeof(value) ? entry->size : sizeof(value));
+  }
+  return value;
+}
+
+int persist_read_data(const uint32_t key, void *buffer, const size_t buffer_size) {
+  PersistEntry *entry = prv_persist_find(key);
+  if (!entry) {
+    return -1;
+  }
+  size_t size = entry->size < buffer_size ? entry->size : buffer_size;
+  memcpy(buffer, entry->data, size);
+  return (int)size;
+}
+
+int persist_write_bool(const uint32_t key, const bool value) {
+  return persist_write_int(key, value ? 1 : 0) < 0 ? -1 : (int)sizeof(bool);
+}
+
+int persist_write_int(const uint32_t key, const int32_t value) {
+  return persist_write_data(key, &value, sizeof(value));
+}
+
+int persist_write_data(const uint32_t key, const void *data, const size_t size) {
+  PersistEntry *entry = prv_persist_slot(key);
+  if (!entry) {
+    return -1;
+  }
+  entry->size = size < PERSIST_DATA_MAX_LENGTH ? size : PERSIST_DATA_MAX_LENGTH;
+  memcpy(entry->data, data, entry->size);
+  s_persist_writes++;
+  return entry->size;
+}
+
+int persist_delete(const uint32_t key) {
+  PersistEntry *entry = prv_persist_find(key);
+  if (!entry) {
+    return -1;
+  }
+  *entry = s_persist[--s_persist_count];
+  s_persist_writes++;
+  return 0;
+}
+
+uint32_t host_persist_writes(void) {
+  return s_persist_writes;
+}
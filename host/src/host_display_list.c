@@ -0,0 +1,27 @@
+#include "host_internal.h"
+
+#include "display_list.h"
+
+// Faces are built with DISPLAY_LIST_OBSERVER naming this function, so every
+// frame their display list ends is reported here
+
+static HostDisplayListStats s_stats;
+
+void host_display_list_reset(void) {
+  memset(&s_stats, 0, sizeof(s_stats));
+}
+
+const HostDisplayListStats *host_display_list_stats(void) {
+  return &s_stats;
+}
+
+void host_display_list_observer(const DisplayList *list) {
+  s_stats.frames++;
+  s_stats.commands = list->num_commands;
+  s_stats.changed = list->num_changed;
+  s_stats.regions = list->num_regions;
+  s_stats.dirty_pixels = 0;
+  for (uint8_t i = 0; i < list->num_regions; i++) {
+    s_stats.dirty_pixels += (uint32_t)list->regions[i].size.w * list->regions[i].size.h;
+  }
+}
@@ -0,0 +1,275 @@
+#include "host_internal.h"
+
+// Parsed form of a PDC image resource ("PDCI" container, version 1).
+// Precise path points are 13.3 fixed point; plain path and circle points are
+// whole pixels.
+
+struct GDrawCommand {
+  GDrawCommandType type;
+  bool hidden;
+  GColor stroke_color;
+  uint8_t stroke_width;
+  GColor fill_color;
+  bool path_open;
+  uint16_t radius;
+  uint16_t num_points;
+  GPoint *points;
+};
+
+struct GDrawCommandList {
+  uint16_t num_commands;
+  GDrawCommand *commands;
+};
+
+struct GDrawCommandImage {
+  GSize size;
+  GDrawCommandList list;
+};
+
+static uint16_t prv_read_u16(const uint8_t *p) {
+  return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t prv_read_u32(const uint8_t *p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint8_t *prv_load_resource(uint32_t resource_id, size_t *size_out) {
+  const HostFaceManifest *manifest = host_manifest();
+  if (!manifest || !manifest->resource_files || resource_id == 0) {
+    return NULL;
+  }
+  uint32_t count = 0;
+  while (manifest->resources[count].name) {
+    count++;
+  }
+  if (resource_id > count) {
+    return NULL;
+  }
+  const char *path = manifest->resource_files[resource_id];
+  FILE *file = path ? fopen(path, "rb") : NULL;
+  if (!file) {
+    return NULL;
+  }
+  fseek(file, 0, SEEK_END);
+  long size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  uint8_t *data = malloc(size > 0 ? size : 1);
+  if (fread(data, 1, size, file) != (size_t)size) {
+    free(data);
+    data = NULL;
+  }
+  fclose(file);
+  *size_out = (size_t)size;
+  return data;
+}
+
+static void prv_free_list(GDrawCommandList *list) {
+  for (uint16_t i = 0; i < list->num_commands; i++) {
+    host_free(list->commands[i].points);
+  }
+  host_free(list->commands);
+}
+
+GDrawCommandImage *gdraw_command_image_create_with_resource(uint32_t resource_id) {
+  size_t size = 0;
+  uint8_t *data = prv_load_resource(resource_id, &size);
+  if (!data) {
+    return NULL;
+  }
+
+  GDrawCommandImage *image = NULL;
+  const uint8_t *p = data;
+  const uint8_t *end = data + size;
+  if (size < 16 || memcmp(p, "PDCI", 4) != 0 || prv_read_u32(p + 4) + 8 > size || p[8] != 1) {
+    goto done;
+  }
+  p += 10;
+
+  image = host_calloc(1, sizeof(GDrawCommandImage));
+  if (!image) {
+    goto done;
+  }
+  image->size = GSize((int16_t)prv_read_u16(p), (int16_t)prv_read_u16(p + 2));
+  image->list.num_commands = prv_read_u16(p + 4);
+  image->list.commands = host_calloc(image->list.num_commands ? image->list.num_commands : 1, sizeof(GDrawCommand));
+  if (!image->list.commands) {
+    image->list.num_commands = 0;
+    goto fail;
+  }
+  p += 6;
+
+  for (uint16_t i = 0; i < image->list.num_commands; i++) {
+    GDrawCommand *command = &image->list.commands[i];
+    if (p + 9 > end) {
+      goto fail;
+    }
+    command->type = (GDrawCommandType)p[0];
+    command->hidden = (p[1] & 1) != 0;
+    command->stroke_color = (GColor){ .argb = p[2] };
+    command->stroke_width = p[3];
+    command->fill_color = (GColor){ .argb = p[4] };
+    uint16_t open_or_radius = prv_read_u16(p + 5);
+    command->path_open = (open_or_radius & 1) != 0;
+    command->radius = open_or_radius;
+    command->num_points = prv_read_u16(p + 7);
+    p += 9;
+    if (p + command->num_points * 4 > end) {
+      goto fail;
+    }
+    command->points = host_malloc(sizeof(GPoint) * (command->num_points ? command->num_points : 1));
+    if (!command->points) {
+      goto fail;
+    }
+    for (uint16_t j = 0; j < command->num_points; j++) {
+      command->points[j] = GPoint((int16_t)prv_read_u16(p), (int16_t)prv_read_u16(p + 2));
+      p += 4;
+    }
+  }
+  goto done;
+
+fail:
+  gdraw_command_image_destroy(image);
+  image = NULL;
+done:
+  free(data);
+  return image;
+}
+
+void gdraw_command_image_destroy(GDrawCommandImage *image) {
+  if (!image) {
+    return;
+  }
+  prv_free_list(&image->list);
+  host_free(image);
+}
+
+GSize gdraw_command_image_get_bounds_size(GDrawCommandImage *image) {
+  return image ? image->size : GSizeZero;
+}
+
+GDrawCommandList *gdraw_command_image_get_command_list(GDrawCommandImage *image) {
+  return image ? &image->list : NULL;
+}
+
+static void prv_draw_command(GContext *ctx, GDrawCommand *command, GPoint offset) {
+  if (command->hidden || command->num_points == 0) {
+    return;
+  }
+  double ox = ctx->offset.x + offset.x;
+  double oy = ctx->offset.y + offset.y;
+
+  if (command->type == GDrawCommandTypeCircle) {
+    GPoint center = GPoint(offset.x + command->points[0].x, offset.y + command->points[0].y);
+    GContext local = *ctx;
+    local.fill_color = command->fill_color;
+    local.stroke_color = command->stroke_color;
+    local.stroke_width = command->stroke_width;
+    if (command->fill_color.a) {
+      graphics_fill_circle(&local, center, command->radius);
+    }
+    if (command->stroke_color.a && command->stroke_width) {
+      graphics_draw_circle(&local, center, command->radius);
+    }
+    return;
+  }
+
+  double stack[64];
+  double *xs = command->num_points <= 32 ? stack : malloc(sizeof(double) * command->num_points * 2);
+  double *ys = xs + command->num_points;
+  for (uint16_t i = 0; i < command->num_points; i++) {
+    GPoint p = command->points[i];
+    if (command->type == GDrawCommandTypePrecisePath) {
+      // Precise coordinates address pixel corners; shift to pixel centers
+      xs[i] = ox + p.x / 8.0 - 0.5;
+      ys[i] = oy + p.y / 8.0 - 0.5;
+    } else {
+      xs[i] = ox + p.x;
+      ys[i] = oy + p.y;
+    }
+  }
+
+  if (command->fill_color.a && !command->path_open) {
+    host_fill_polygon(ctx, xs, ys, command->num_points, command->fill_color);
+  }
+  if (command->stroke_color.a && command->stroke_width) {
+    uint16_t segments = command->path_open ? command->num_points - 1 : command->num_points;
+    for (uint16_t i = 0; i < segments; i++) {
+      uint16_t j = (i + 1) % command->num_points;
+      host_draw_capsule(ctx, xs[i], ys[i], xs[j], ys[j], command->stroke_width, command->stroke_color);
+    }
+  }
+
+  if (xs != stack) {
+    free(xs);
+  }
+}
+
+void gdraw_command_image_draw(GContext *ctx, GDrawCommandImage *image, GPoint offset) {
+  host_count_prim(HostPrimDrawCommandImage);
+  if (!image) {
+    return;
+  }
+  for (uint16_t i = 0; i < image->list.num_commands; i++) {
+    prv_draw_command(ctx, &image->list.commands[i], offset);
+  }
+}
+
+void gdraw_command_list_iterate(GDrawCommandList *command_list, GDrawCommandListIteratorCb handle_command,
+                                void *callback_context) {
+  if (!command_list || !handle_command) {
+    return;
+  }
+  for (uint16_t i = 0; i < command_list->num_commands; i++) {
+    if (!handle_command(&command_list->commands[i], i, callback_context)) {
+      break;
+    }
+  }
+}
+
+uint32_t gdraw_command_list_get_num_commands(GDrawCommandList *command_list) {
+  return command_list ? command_list->num_commands : 0;
+}
+
+GDrawCommand *gdraw_command_list_get_command(GDrawCommandList *command_list, uint16_t command_idx) {
+  if (!command_list || command_idx >= command_list->num_commands) {
+    return NULL;
+  }
+  return &command_list->commands[command_idx];
+}
+
+GDrawCommandType gdraw_command_get_type(GDrawCommand *command) {
+  return command->type;
+}
+
+GColor gdraw_command_get_fill_color(GDrawCommand *command) {
+  return command->fill_color;
+}
+
+void gdraw_command_set_fill_color(GDrawCommand *command, GColor fill_color) {
+  command->fill_color = fill_color;
+}
+
+GColor gdraw_command_get_stroke_color(GDrawCommand *command) {
+  return command->stroke_color;
+}
+
+void gdraw_command_set_stroke_color(GDrawCommand *command, GColor stroke_color) {
+  command->stroke_color = stroke_color;
+}
+
+uint8_t gdraw_command_get_stroke_width(GDrawCommand *command) {
+  return command->stroke_width;
+}
+
+void gdraw_command_set_stroke_width(GDrawCommand *command, uint8_t stroke_width) {
+  command->stroke_width = stroke_width;
+}
+
+bool gdraw_command_get_hidden(GDrawCommand *command) {
+  return command->hidden;
+}
+
+void gdraw_command_set_hidden(GDrawCommand *command, bool hidden) {
+  command->hidden = hidden;
+}
@@ -0,0 +1,73 @@
+#include "host_internal.h"
+
+// Transformed points follow the firmware: rotate about the path origin with
+// the integer trig tables, then translate by the offset
+
+GPath *gpath_create(const GPathInfo *init) {
+  GPath *path = host_malloc(sizeof(GPath));
+  if (!path) {
+    return NULL;
+  }
+  path->num_points = init->num_points;
+  path->points = init->points;
+  path->rotation = 0;
+  path->offset = GPointZero;
+  return path;
+}
+
+void gpath_destroy(GPath *gpath) {
+  host_free(gpath);
+}
+
+void gpath_rotate_to(GPath *path, int32_t angle) {
+  path->rotation = angle % TRIG_MAX_ANGLE;
+}
+
+void gpath_move_to(GPath *path, GPoint point) {
+  path->offset = point;
+}
+
+static void prv_transform(GContext *ctx, const GPath *path, double *xs, double *ys) {
+  int32_t cosine = cos_lookup(path->rotation);
+  int32_t sine = sin_lookup(path->rotation);
+  for (uint32_t i = 0; i < path->num_points; i++) {
+    GPoint p = path->points[i];
+    int32_t x = (p.x * cosine - p.y * sine) / TRIG_MAX_RATIO;
+    int32_t y = (p.y * cosine + p.x * sine) / TRIG_MAX_RATIO;
+    xs[i] = ctx->offset.x + path->offset.x + x;
+    ys[i] = ctx->offset.y + path->offset.y + y;
+  }
+}
+
+void gpath_draw_filled(GContext *ctx, GPath *path) {
+  host_count_prim(HostPrimPathFilled);
+  if (!path || path->num_points < 3) {
+    return;
+  }
+  double stack[32];
+  double *xs = path->num_points <= 16 ? stack : malloc(sizeof(double) * path->num_points * 2);
+  double *ys = xs + path->num_points;
+  prv_transform(ctx, path, xs, ys);
+  host_fill_polygon(ctx, xs, ys, path->num_points, ctx->fill_color);
+  if (xs != stack) {
+    free(xs);
+  }
+}
+
+void gpath_draw_outline(GContext *ctx, GPath *path) {
+  host_count_prim(HostPrimPathOutline);
+  if (!path || path->num_points < 2) {
+    return;
+  }
+  double stack[32];
+  double *xs = path->num_points <= 16 ? stack : malloc(sizeof(double) * path->num_points * 2);
+  double *ys = xs + path->num_points;
+  prv_transform(ctx, path, xs, ys);
+  for (uint32_t i = 0; i < path->num_points; i++) {
+    uint32_t j = (i + 1) % path->num_points;
+    host_draw_capsule(ctx, xs[i], ys[i], xs[j], ys[j], ctx->stroke_width, ctx->stroke_color);
+  }
+  if (xs != stack) {
+    free(xs);
+  }
+}
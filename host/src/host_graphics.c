@@ -0,0 +1,675 @@
+#include <math.h>
+
+#include "host_internal.h"
+
+static const HostPlatformInfo s_platforms[HostPlatformCount] = {
+  // heap_size is the app RAM budget; code and statics are not modelled.
+  // peek_height is the firmware's 51 row Quick View, scaled up for emery;
+  // aplite has no Quick View.
+  [HostPlatformAplite] = { .name = "aplite", .width = 144, .height = 168, .color = false, .round = false,
+                           .heap_size = 24 * 1024, .peek_height = 0 },
+  [HostPlatformBasalt] = { .name = "basalt", .width = 144, .height = 168, .color = true, .round = false,
+                           .heap_size = 64 * 1024, .peek_height = 51 },
+  [HostPlatformChalk] = { .name = "chalk", .width = 180, .height = 180, .color = true, .round = true,
+                          .heap_size = 64 * 1024, .peek_height = 51 },
+  [HostPlatformEmery] = { .name = "emery", .width = 200, .height = 228, .color = true, .round = false,
+                          .heap_size = 128 * 1024, .peek_height = 69 },
+};
+
+static const char *const s_prim_names[HostPrimCount] = {
+  [HostPrimFillRect] = "fill_rect",
+  [HostPrimDrawRect] = "draw_rect",
+  [HostPrimFillCircle] = "fill_circle",
+  [HostPrimDrawCircle] = "draw_circle",
+  [HostPrimFillRadial] = "fill_radial",
+  [HostPrimDrawLine] = "draw_line",
+  [HostPrimDrawPixel] = "draw_pixel",
+  [HostPrimPathFilled] = "path_filled",
+  [HostPrimPathOutline] = "path_outline",
+  [HostPrimDrawCommandImage] = "pdc_draw",
+  [HostPrimCaptureFrameBuffer] = "fb_capture",
+};
+
+struct GBitmap {
+  uint8_t *data;
+  uint16_t row_size_bytes;
+  GBitmapFormat format;
+  GRect bounds;
+};
+
+static HostFramebuffer s_fb;
+static HostFrameStats s_stats;
+static size_t s_stats_heap_base;
+static bool s_accounting = false;
+
+// Frame buffer capture state
+static GBitmap s_fb_bitmap;
+static bool s_fb_captured;
+static uint8_t *s_fb_before;
+
+const HostPlatformInfo *host_platform_info(HostPlatform platform) {
+  return &s_platforms[platform];
+}
+
+const char *host_prim_name(HostPrim prim) {
+  return s_prim_names[prim];
+}
+
+HostFramebuffer *host_framebuffer(void) {
+  return &s_fb;
+}
+
+void host_graphics_init(HostPlatform platform) {
+  host_graphics_deinit();
+
+  const HostPlatformInfo *info = &s_platforms[platform];
+  s_fb.width = info->width;
+  s_fb.height = info->height;
+  s_fb.bw = !info->color;
+  // 1-bit rows are padded to whole 32-bit words, as on the device
+  s_fb.row_size_bytes = s_fb.bw ? ((info->width + 31) / 32) * 4 : info->width;
+  s_fb.data = calloc(s_fb.row_size_bytes, s_fb.height);
+  s_fb.row_min_x = malloc(sizeof(int16_t) * s_fb.height);
+  s_fb.row_max_x = malloc(sizeof(int16_t) * s_fb.height);
+
+  for (int y = 0; y < s_fb.height; y++) {
+    if (info->round) {
+      // Row extent of a circle spanning the display, sampled at pixel centers
+      double dy = (y + 0.5) - s_fb.height / 2.0;
+      double r = s_fb.width / 2.0;
+      double half = sqrt(r * r - dy * dy);
+      s_fb.row_min_x[y] = (int16_t)ceil(s_fb.width / 2.0 - half - 0.5);
+      s_fb.row_max_x[y] = (int16_t)floor(s_fb.width / 2.0 + half - 0.5);
+    } else {
+      s_fb.row_min_x[y] = 0;
+      s_fb.row_max_x[y] = s_fb.width - 1;
+    }
+  }
+
+  memset(&s_stats, 0, sizeof(s_stats));
+  s_stats_heap_base = 0;
+}
+
+void host_graphics_deinit(void) {
+  free(s_fb_before);
+  s_fb_before = NULL;
+  s_fb_captured = false;
+  free(s_fb.data);
+  free(s_fb.row_min_x);
+  free(s_fb.row_max_x);
+  memset(&s_fb, 0, sizeof(s_fb));
+}
+
+void host_stats_reset(void) {
+  memset(&s_stats, 0, sizeof(s_stats));
+  s_stats_heap_base = heap_bytes_used();
+}
+
+const HostFrameStats *host_stats(void) {
+  return &s_stats;
+}
+
+void host_count_prim(HostPrim prim) {
+  s_stats.prims[prim]++;
+}
+
+void host_count_allocation(size_t heap_used) {
+  s_stats.allocations++;
+  if (heap_used > s_stats_heap_base && heap_used - s_stats_heap_base > s_stats.heap_high_water) {
+    s_stats.heap_high_water = heap_used - s_stats_heap_base;
+  }
+}
+
+void host_set_accounting(bool enabled) {
+  s_accounting = enabled;
+}
+
+// Framebuffer access
+
+static void prv_rgb_of(GColor color, uint8_t *r, uint8_t *g, uint8_t *b) {
+  *r = color.r * 85;
+  *g = color.g * 85;
+  *b = color.b * 85;
+}
+
+// 1-bit mapping: black and white map directly, the two grays are drawn as a
+// 50% checkerboard and everything else thresholds on brightness
+static bool prv_bw_bit(GColor color, int x, int y) {
+  int level = color.r + color.g + color.b;
+  if (level == 3 || level == 6) {
+    if (color.r == color.g && color.g == color.b) {
+      return ((x + y) & 1) != 0;
+    }
+  }
+  return level >= 5;
+}
+
+uint32_t host_framebuffer_pixel(int x, int y) {
+  if (x < 0 || y < 0 || x >= s_fb.width || y >= s_fb.height) {
+    return 0;
+  }
+  if (s_fb.bw) {
+    uint8_t byte = s_fb.data[y * s_fb.row_size_bytes + x / 8];
+    return (byte >> (x % 8)) & 1 ? 0xFFFFFF : 0x000000;
+  }
+  GColor color = { .argb = s_fb.data[y * s_fb.row_size_bytes + x] };
+  uint8_t r, g, b;
+  prv_rgb_of(color, &r, &g, &b);
+  return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+}
+
+bool host_framebuffer_visible(int x, int y) {
+  if (x < 0 || y < 0 || x >= s_fb.width || y >= s_fb.height) {
+    return false;
+  }
+  return x >= s_fb.row_min_x[y] && x <= s_fb.row_max_x[y];
+}
+
+uint64_t host_framebuffer_digest(void) {
+  // FNV-1a over the visible bytes of every row
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for (int y = 0; y < s_fb.height; y++) {
+    const uint8_t *row = s_fb.data + y * s_fb.row_size_bytes;
+    int start = s_fb.bw ? 0 : s_fb.row_min_x[y];
+    int end = s_fb.bw ? s_fb.row_size_bytes - 1 : s_fb.row_max_x[y];
+    for (int i = start; i <= end; i++) {
+      hash = (hash ^ row[i]) * 0x100000001b3ull;
+    }
+  }
+  return hash;
+}
+
+void host_context_init(GContext *ctx, GPoint offset, GRect clip) {
+  memset(ctx, 0, sizeof(*ctx));
+  ctx->stroke_color = GColorBlack;
+  ctx->fill_color = GColorBlack;
+  ctx->stroke_width = 1;
+  ctx->antialiased = true;
+  ctx->offset = offset;
+  ctx->clip = clip;
+}
+
+void host_fill_span(GContext *ctx, int y, int x0, int x1, GColor color) {
+  if (color.a == 0) {
+    return;
+  }
+  if (y < ctx->clip.origin.y || y >= ctx->clip.origin.y + ctx->clip.size.h || y < 0 || y >= s_fb.height) {
+    return;
+  }
+  if (x0 > x1) {
+    int t = x0;
+    x0 = x1;
+    x1 = t;
+  }
+  int min_x = ctx->clip.origin.x > s_fb.row_min_x[y] ? ctx->clip.origin.x : s_fb.row_min_x[y];
+  int max_x = ctx->clip.origin.x + ctx->clip.size.w - 1;
+  if (max_x > s_fb.row_max_x[y]) {
+    max_x = s_fb.row_max_x[y];
+  }
+  if (x0 < min_x) x0 = min_x;
+  if (x1 > max_x) x1 = max_x;
+  if (x0 > x1) {
+    return;
+  }
+
+  uint8_t *row = s_fb.data + y * s_fb.row_size_bytes;
+  if (s_fb.bw) {
+    for (int x = x0; x <= x1; x++) {
+      if (prv_bw_bit(color, x, y)) {
+        row[x / 8] |= (uint8_t)(1 << (x % 8));
+      } else {
+        row[x / 8] &= (uint8_t)~(1 << (x % 8));
+      }
+    }
+  } else {
+    memset(row + x0, color.argb, x1 - x0 + 1);
+  }
+  s_stats.pixels += (uint64_t)(x1 - x0 + 1);
+}
+
+void host_plot(GContext *ctx, int x, int y, GColor color) {
+  host_fill_span(ctx, y, x, x, color);
+}
+
+// Integer helpers
+
+static int prv_isqrt(int64_t v) {
+  if (v <= 0) {
+    return 0;
+  }
+  int64_t r = (int64_t)sqrt((double)v);
+  while (r * r > v) r--;
+  while ((r + 1) * (r + 1) <= v) r++;
+  return (int)r;
+}
+
+// Smallest n >= 0 with n * n >= v
+static int prv_isqrt_ceil(int64_t v) {
+  if (v <= 0) {
+    return 0;
+  }
+  int r = prv_isqrt(v);
+  return ((int64_t)r * r == v) ? r : r + 1;
+}
+
+// Context setters
+
+void graphics_context_set_stroke_color(GContext *ctx, GColor color) {
+  ctx->stroke_color = color;
+}
+
+void graphics_context_set_fill_color(GContext *ctx, GColor color) {
+  ctx->fill_color = color;
+}
+
+void graphics_context_set_stroke_width(GContext *ctx, uint8_t stroke_width) {
+  if (stroke_width == 0) {
+    return;
+  }
+  ctx->stroke_width = stroke_width;
+}
+
+void graphics_context_set_antialiased(GContext *ctx, bool enable) {
+  ctx->antialiased = enable;
+}
+
+// Rectangles
+
+void graphics_fill_rect(GContext *ctx, GRect rect, uint16_t corner_radius, GCornerMask corner_mask) {
+  host_count_prim(HostPrimFillRect);
+  if (rect.size.w <= 0 || rect.size.h <= 0) {
+    return;
+  }
+  int x0 = ctx->offset.x + rect.origin.x;
+  int y0 = ctx->offset.y + rect.origin.y;
+  int w = rect.size.w;
+  int h = rect.size.h;
+
+  int radius = corner_mask == GCornerNone ? 0 : corner_radius;
+  int max_radius = (w < h ? w : h) / 2;
+  if (radius > max_radius) {
+    radius = max_radius;
+  }
+
+  for (int row = 0; row < h; row++) {
+    int inset_l = 0;
+    int inset_r = 0;
+    if (radius > 0) {
+      bool top = row < radius;
+      bool bottom = row >= h - radius;
+      if (top || bottom) {
+        // Distance of the pixel center from the corner circle's center row
+        double d = top ? radius - (row + 0.5) : (row + 0.5) - (h - radius);
+        int inset = (int)ceil(radius - sqrt((double)radius * radius - d * d) - 0.5);
+        if (inset < 0) inset = 0;
+        GCornerMask left = top ? GCornerTopLeft : GCornerBottomLeft;
+        GCornerMask right = top ? GCornerTopRight : GCornerBottomRight;
+        if (corner_mask & left) inset_l = inset;
+        if (corner_mask & right) inset_r = inset;
+      }
+    }
+    host_fill_span(ctx, y0 + row, x0 + inset_l, x0 + w - 1 - inset_r, ctx->fill_color);
+  }
+}
+
+void graphics_draw_rect(GContext *ctx, GRect rect) {
+  host_count_prim(HostPrimDrawRect);
+  if (rect.size.w <= 0 || rect.size.h <= 0) {
+    return;
+  }
+  int x0 = ctx->offset.x + rect.origin.x;
+  int y0 = ctx->offset.y + rect.origin.y;
+  int x1 = x0 + rect.size.w - 1;
+  int y1 = y0 + rect.size.h - 1;
+  host_fill_span(ctx, y0, x0, x1, ctx->stroke_color);
+  if (y1 != y0) {
+    host_fill_span(ctx, y1, x0, x1, ctx->stroke_color);
+  }
+  for (int y = y0 + 1; y < y1; y++) {
+    host_plot(ctx, x0, y, ctx->stroke_color);
+    if (x1 != x0) {
+      host_plot(ctx, x1, y, ctx->stroke_color);
+    }
+  }
+}
+
+// Circles: a pixel at offset (dx, dy) belongs to the ring of radius r and
+// stroke width w when (2r - w)^2 <= 4(dx^2 + dy^2) < (2r + w)^2. A filled
+// circle is the w = 1 ring with no inner bound.
+
+static void prv_ring(GContext *ctx, GPoint center, int radius, int width, bool filled, GColor color) {
+  int cx = ctx->offset.x + center.x;
+  int cy = ctx->offset.y + center.y;
+  int inner = 2 * radius - width;
+  int64_t inner_sq = (filled || inner <= 0) ? 0 : (int64_t)inner * inner;
+  int64_t outer = 2 * radius + width;
+  int64_t outer_sq = outer * outer;
+  int reach = (int)(outer / 2) + 1;
+
+  for (int dy = -reach; dy <= reach; dy++) {
+    int64_t lim = outer_sq - 4 * (int64_t)dy * dy - 1;
+    if (lim < 0) {
+      continue;
+    }
+    int ho = prv_isqrt(lim / 4);
+    int hi = 0;
+    int64_t t = inner_sq - 4 * (int64_t)dy * dy;
+    if (t > 0) {
+      hi = prv_isqrt_ceil((t + 3) / 4);
+    }
+    if (hi > ho) {
+      continue;
+    }
+    if (hi == 0) {
+      host_fill_span(ctx, cy + dy, cx - ho, cx + ho, color);
+    } else {
+      host_fill_span(ctx, cy + dy, cx - ho, cx - hi, color);
+      host_fill_span(ctx, cy + dy, cx + hi, cx + ho, color);
+    }
+  }
+}
+
+void graphics_fill_circle(GContext *ctx, GPoint p, uint16_t radius) {
+  host_count_prim(HostPrimFillCircle);
+  prv_ring(ctx, p, radius, 1, true, ctx->fill_color);
+}
+
+void graphics_draw_circle(GContext *ctx, GPoint p, uint16_t radius) {
+  host_count_prim(HostPrimDrawCircle);
+  prv_ring(ctx, p, radius, ctx->stroke_width, false, ctx->stroke_color);
+}
+
+// Radial fill: the circle inscribed in rect (GOvalScaleModeFitCircle) or
+// circumscribing it (GOvalScaleModeFillCircle), limited to the ring of the
+// given inset and to the clockwise sweep from angle_start to angle_end.
+void graphics_fill_radial(GContext *ctx, GRect rect, GOvalScaleMode scale_mode, uint16_t inset,
+                          int32_t angle_start, int32_t angle_end) {
+  host_count_prim(HostPrimFillRadial);
+  if (angle_end <= angle_start || rect.size.w <= 0 || rect.size.h <= 0) {
+    return;
+  }
+  double cx = ctx->offset.x + rect.origin.x + (rect.size.w - 1) / 2.0;
+  double cy = ctx->offset.y + rect.origin.y + (rect.size.h - 1) / 2.0;
+  double r_outer;
+  if (scale_mode == GOvalScaleModeFitCircle) {
+    r_outer = (rect.size.w < rect.size.h ? rect.size.w : rect.size.h) / 2.0;
+  } else {
+    r_outer = (rect.size.w > rect.size.h ? rect.size.w : rect.size.h) / 2.0;
+  }
+  double r_inner = r_outer - inset;
+  if (r_inner < 0) r_inner = 0;
+
+  // Sector membership by cross products against the start and end rays.
+  // Pebble angles run clockwise from 12 o'clock, so a direction is
+  // (sin a, -cos a) and "clockwise of" means a positive cross product.
+  int32_t sweep = angle_end - angle_start;
+  bool full = sweep >= TRIG_MAX_ANGLE;
+  double sx = sin_lookup(angle_start) / (double)TRIG_MAX_RATIO;
+  double sy = -cos_lookup(angle_start) / (double)TRIG_MAX_RATIO;
+  double ex = sin_lookup(angle_end) / (double)TRIG_MAX_RATIO;
+  double ey = -cos_lookup(angle_end) / (double)TRIG_MAX_RATIO;
+  bool reflex = sweep > TRIG_MAX_ANGLE / 2;
+
+  int y_min = (int)ceil(cy - r_outer);
+  int y_max = (int)floor(cy + r_outer);
+  for (int y = y_min; y <= y_max; y++) {
+    double dy = y - cy;
+    double span_sq = r_outer * r_outer - dy * dy;
+    if (span_sq < 0) {
+      continue;
+    }
+    double half = sqrt(span_sq);
+    int x_min = (int)ceil(cx - half);
+    int x_max = (int)floor(cx + half);
+    int run_start = 0;
+    bool in_run = false;
+    for (int x = x_min; x <= x_max + 1; x++) {
+      bool inside = false;
+      if (x <= x_max) {
+        double dx = x - cx;
+        double d_sq = dx * dx + dy * dy;
+        inside = d_sq >= r_inner * r_inner || r_inner == 0;
+        if (inside && !full) {
+          double after_start = sx * dy - sy * dx;
+          double before_end = dx * ey - dy * ex;
+          if (reflex) {
+            inside = !(after_start < 0 && before_end < 0);
+          } else {
+            inside = after_start >= 0 && before_end >= 0;
+          }
+        }
+      }
+      if (inside && !in_run) {
+        run_start = x;
+        in_run = true;
+      } else if (!inside && in_run) {
+        host_fill_span(ctx, y, run_start, x - 1, ctx->fill_color);
+        in_run = false;
+      }
+    }
+  }
+}
+
+// Lines
+
+static void prv_line_1px(GContext *ctx, int x0, int y0, int x1, int y1, GColor color) {
+  int dx = abs(x1 - x0);
+  int dy = -abs(y1 - y0);
+  int sx = x0 < x1 ? 1 : -1;
+  int sy = y0 < y1 ? 1 : -1;
+  int err = dx + dy;
+  for (;;) {
+    host_plot(ctx, x0, y0, color);
+    if (x0 == x1 && y0 == y1) {
+      break;
+    }
+    int e2 = 2 * err;
+    if (e2 >= dy) {
+      err += dy;
+      x0 += sx;
+    }
+    if (e2 <= dx) {
+      err += dx;
+      y0 += sy;
+    }
+  }
+}
+
+static void prv_interval_add(double lo, double hi, double *min_x, double *max_x) {
+  if (lo < *min_x) *min_x = lo;
+  if (hi > *max_x) *max_x = hi;
+}
+
+// Round-capped thick segment. Each row of a capsule is a single interval:
+// the union of the rows of the two end discs and of the swept rectangle.
+void host_draw_capsule(GContext *ctx, double x0, double y0, double x1, double y1, double width, GColor color) {
+  const double eps = 1e-9;
+  double r = width / 2.0;
+  double dx = x1 - x0;
+  double dy = y1 - y0;
+  double len = sqrt(dx * dx + dy * dy);
+  double nx = 0;
+  double ny = 0;
+  if (len > 0) {
+    nx = -dy / len * r;
+    ny = dx / len * r;
+  }
+  double quad_x[4] = { x0 + nx, x1 + nx, x1 - nx, x0 - nx };
+  double quad_y[4] = { y0 + ny, y1 + ny, y1 - ny, y0 - ny };
+
+  double top = (y0 < y1 ? y0 : y1) - r;
+  double bottom = (y0 > y1 ? y0 : y1) + r;
+  for (int y = (int)ceil(top - eps); y <= (int)floor(bottom + eps); y++) {
+    double min_x = INFINITY;
+    double max_x = -INFINITY;
+
+    double ends_x[2] = { x0, x1 };
+    double ends_y[2] = { y0, y1 };
+    for (int i = 0; i < 2; i++) {
+      double ey = y - ends_y[i];
+      double s = r * r - ey * ey;
+      if (s >= -eps) {
+        double half = sqrt(s > 0 ? s : 0);
+        prv_interval_add(ends_x[i] - half, ends_x[i] + half, &min_x, &max_x);
+      }
+    }
+
+    if (len > 0) {
+      for (int i = 0; i < 4; i++) {
+        double ax = quad_x[i], ay = quad_y[i];
+        double bx = quad_x[(i + 1) % 4], by = quad_y[(i + 1) % 4];
+        if ((y < ay - eps && y < by - eps) || (y > ay + eps && y > by + eps)) {
+          continue;
+        }
+        if (fabs(by - ay) < eps) {
+          prv_interval_add(ax < bx ? ax : bx, ax > bx ? ax : bx, &min_x, &max_x);
+        } else {
+          double x = ax + (y - ay) * (bx - ax) / (by - ay);
+          prv_interval_add(x, x, &min_x, &max_x);
+        }
+      }
+    }
+
+    if (min_x <= max_x) {
+      host_fill_span(ctx, y, (int)ceil(min_x - eps), (int)floor(max_x + eps), color);
+    }
+  }
+}
+
+void graphics_draw_line(GContext *ctx, GPoint p0, GPoint p1) {
+  host_count_prim(HostPrimDrawLine);
+  int x0 = ctx->offset.x + p0.x;
+  int y0 = ctx->offset.y + p0.y;
+  int x1 = ctx->offset.x + p1.x;
+  int y1 = ctx->offset.y + p1.y;
+  if (ctx->stroke_width <= 1) {
+    prv_line_1px(ctx, x0, y0, x1, y1, ctx->stroke_color);
+    return;
+  }
+  // Even widths straddle the pixel grid, so shift them by half a pixel
+  double shift = (ctx->stroke_width % 2 == 0) ? -0.5 : 0.0;
+  host_draw_capsule(ctx, x0 + shift, y0 + shift, x1 + shift, y1 + shift, ctx->stroke_width, ctx->stroke_color);
+}
+
+void graphics_draw_pixel(GContext *ctx, GPoint point) {
+  host_count_prim(HostPrimDrawPixel);
+  host_plot(ctx, ctx->offset.x + point.x, ctx->offset.y + point.y, ctx->stroke_color);
+}
+
+// Polygons: pixel centers are sampled on each row, edges are half-open in y
+
+static int prv_compare_double(const void *a, const void *b) {
+  double da = *(const double *)a;
+  double db = *(const double *)b;
+  return (da > db) - (da < db);
+}
+
+void host_fill_polygon(GContext *ctx, const double *xs, const double *ys, int count, GColor color) {
+  if (count < 3) {
+    return;
+  }
+  double top = ys[0];
+  double bottom = ys[0];
+  for (int i = 1; i < count; i++) {
+    if (ys[i] < top) top = ys[i];
+    if (ys[i] > bottom) bottom = ys[i];
+  }
+
+  double stack_hits[16];
+  double *hits = count <= 16 ? stack_hits : malloc(sizeof(double) * count);
+  for (int y = (int)ceil(top); y <= (int)floor(bottom); y++) {
+    int num_hits = 0;
+    for (int i = 0; i < count; i++) {
+      double ax = xs[i], ay = ys[i];
+      double bx = xs[(i + 1) % count], by = ys[(i + 1) % count];
+      if ((ay <= y && y < by) || (by <= y && y < ay)) {
+        hits[num_hits++] = ax + (y - ay) * (bx - ax) / (by - ay);
+      }
+    }
+    qsort(hits, num_hits, sizeof(double), prv_compare_double);
+    for (int i = 0; i + 1 < num_hits; i += 2) {
+      host_fill_span(ctx, y, (int)ceil(hits[i] - 0.5), (int)floor(hits[i + 1] + 0.5), color);
+    }
+  }
+  if (hits != stack_hits) {
+    free(hits);
+  }
+}
+
+// Direct frame buffer access. Writes through the returned bitmap bypass the
+// drawing primitives, so when accounting is on the frame is copied at capture
+// and the changed visible pixels are counted at release.
+
+GBitmap *graphics_capture_frame_buffer(GContext *ctx) {
+  host_count_prim(HostPrimCaptureFrameBuffer);
+  if (s_fb_captured) {
+    return NULL;
+  }
+  s_fb_captured = true;
+  s_fb_bitmap.data = s_fb.data;
+  s_fb_bitmap.row_size_bytes = s_fb.row_size_bytes;
+  s_fb_bitmap.bounds = GRect(0, 0, s_fb.width, s_fb.height);
+  if (s_fb.bw) {
+    s_fb_bitmap.format = GBitmapFormat1Bit;
+  } else if (s_fb.row_min_x[0] > 0) {
+    s_fb_bitmap.format = GBitmapFormat8BitCircular;
+  } else {
+    s_fb_bitmap.format = GBitmapFormat8Bit;
+  }
+  if (s_accounting) {
+    size_t size = (size_t)s_fb.row_size_bytes * s_fb.height;
+    if (!s_fb_before) {
+      s_fb_before = malloc(size);
+    }
+    memcpy(s_fb_before, s_fb.data, size);
+  }
+  return &s_fb_bitmap;
+}
+
+bool graphics_release_frame_buffer(GContext *ctx, GBitmap *buffer) {
+  if (!s_fb_captured || buffer != &s_fb_bitmap) {
+    return false;
+  }
+  s_fb_captured = false;
+  if (s_accounting && s_fb_before) {
+    for (int y = 0; y < s_fb.height; y++) {
+      const uint8_t *now = s_fb.data + y * s_fb.row_size_bytes;
+      const uint8_t *before = s_fb_before + y * s_fb.row_size_bytes;
+      for (int x = s_fb.row_min_x[y]; x <= s_fb.row_max_x[y]; x++) {
+        bool changed = s_fb.bw ? ((now[x / 8] ^ before[x / 8]) >> (x % 8)) & 1 : now[x] != before[x];
+        s_stats.direct_pixels += changed;
+      }
+    }
+  }
+  return true;
+}
+
+uint8_t *gbitmap_get_data(const GBitmap *bitmap) {
+  return bitmap->data;
+}
+
+uint16_t gbitmap_get_bytes_per_row(const GBitmap *bitmap) {
+  // Circular frame buffers have no fixed stride; use the row info instead
+  return bitmap->format == GBitmapFormat8BitCircular ? 0 : bitmap->row_size_bytes;
+}
+
+GBitmapFormat gbitmap_get_format(const GBitmap *bitmap) {
+  return bitmap->format;
+}
+
+GRect gbitmap_get_bounds(const GBitmap *bitmap) {
+  return bitmap->bounds;
+}
+
+GBitmapDataRowInfo gbitmap_get_data_row_info(const GBitmap *bitmap, uint16_t y) {
+  GBitmapDataRowInfo info = {
+    .data = bitmap->data + y * bitmap->row_size_bytes,
+    .min_x = 0,
+    .max_x = bitmap->bounds.size.w - 1,
+  };
+  if (bitmap->data == s_fb.data && y < s_fb.height) {
+    info.min_x = s_fb.row_min_x[y];
+    info.max_x = s_fb.row_max_x[y];
+  }
+  return info;
+}
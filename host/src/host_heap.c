@@ -0,0 +1,89 @@
+#include "host_internal.h"
+
+// Simulated app heap. Every block carries a header recording its size, plus
+// a fixed per-block overhead like the firmware allocator's.
+
+#define BLOCK_OVERHEAD 8
+
+typedef struct {
+  size_t size;
+  size_t pad;
+} BlockHeader;
+
+static size_t s_used;
+static size_t s_peak;
+
+static size_t prv_capacity(void) {
+  return host_platform_info(host_platform())->heap_size;
+}
+
+void host_heap_reset(void) {
+  s_used = 0;
+  s_peak = 0;
+}
+
+size_t host_heap_peak(void) {
+  return s_peak;
+}
+
+void host_heap_reset_peak(void) {
+  s_peak = s_used;
+}
+
+size_t heap_bytes_used(void) {
+  return s_used;
+}
+
+size_t heap_bytes_free(void) {
+  size_t capacity = prv_capacity();
+  return s_used < capacity ? capacity - s_used : 0;
+}
+
+void *host_malloc(size_t size) {
+  size_t charge = size + BLOCK_OVERHEAD;
+  if (s_used + charge > prv_capacity()) {
+    return NULL;
+  }
+  BlockHeader *header = malloc(sizeof(BlockHeader) + (size ? size : 1));
+  if (!header) {
+    return NULL;
+  }
+  header->size = size;
+  s_used += charge;
+  if (s_used > s_peak) {
+    s_peak = s_used;
+  }
+  host_count_allocation(s_used);
+  return header + 1;
+}
+
+void *host_calloc(size_t count, size_t size) {
+  void *ptr = host_malloc(count * size);
+  if (ptr) {
+    memset(ptr, 0, count * size);
+  }
+  return ptr;
+}
+
+void host_free(void *ptr) {
+  if (!ptr) {
+    return;
+  }
+  BlockHeader *header = (BlockHeader *)ptr - 1;
+  size_t charge = header->size + BLOCK_OVERHEAD;
+  s_used = s_used > charge ? s_used - charge : 0;
+  free(header);
+}
+
+void *host_realloc(void *ptr, size_t size) {
+  if (!ptr) {
+    return host_malloc(size);
+  }
+  BlockHeader *header = (BlockHeader *)ptr - 1;
+  void *resized = host_malloc(size);
+  if (resized) {
+    memcpy(resized, ptr, header->size < size ? header->size : size);
+    host_free(ptr);
+  }
+  return resized;
+}
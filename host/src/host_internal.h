@@ -0,0 +1,55 @@
+#pragma once
+
+// Shared state between the translation units of the host shim.
+
+#include <pebble.h>
+
+#include "pebble_host.h"
+
+struct GContext {
+  GColor stroke_color;
+  GColor fill_color;
+  uint8_t stroke_width;
+  bool antialiased;
+  // Absolute origin of the layer being drawn and its absolute clip rect
+  GPoint offset;
+  GRect clip;
+};
+
+typedef struct {
+  uint8_t *data;
+  uint16_t row_size_bytes;
+  int16_t width;
+  int16_t height;
+  bool bw;
+  // Visible x range per row; chalk's display is round
+  int16_t *row_min_x;
+  int16_t *row_max_x;
+} HostFramebuffer;
+
+// host_display_list.c
+void host_display_list_reset(void);
+
+// host_graphics.c
+void host_graphics_init(HostPlatform platform);
+void host_graphics_deinit(void);
+HostFramebuffer *host_framebuffer(void);
+void host_context_init(GContext *ctx, GPoint offset, GRect clip);
+void host_count_prim(HostPrim prim);
+void host_count_allocation(size_t heap_used);
+
+// Fills pixels [x0, x1] of row y, in absolute framebuffer coordinates,
+// clipped against the context clip and the visible display area
+void host_fill_span(GContext *ctx, int y, int x0, int x1, GColor color);
+void host_plot(GContext *ctx, int x, int y, GColor color);
+
+// Sub-pixel primitives in absolute coordinates, pixel centers on integers
+void host_fill_polygon(GContext *ctx, const double *xs, const double *ys, int count, GColor color);
+void host_draw_capsule(GContext *ctx, double x0, double y0, double x1, double y1, double width, GColor color);
+
+// host_heap.c
+void host_heap_reset(void);
+
+// host_app.c
+const HostFaceManifest *host_manifest(void);
+HostPlatform host_platform(void);
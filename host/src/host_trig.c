@@ -0,0 +1,61 @@
+#include <math.h>
+
+#include "host_internal.h"
+
+// Quarter-wave table indexed by angle, like the firmware's lookup tables, so
+// trig calls on the host cost a table read rather than a libm call
+#define QUARTER (TRIG_MAX_ANGLE / 4)
+
+static int32_t s_sin_table[QUARTER + 1];
+static bool s_sin_table_ready;
+
+static void prv_init_table(void) {
+  for (int i = 0; i <= QUARTER; i++) {
+    s_sin_table[i] = (int32_t)lround(sin(i * (2 * M_PI / TRIG_MAX_ANGLE)) * TRIG_MAX_RATIO);
+  }
+  s_sin_table_ready = true;
+}
+
+int32_t sin_lookup(int32_t angle) {
+  if (!s_sin_table_ready) {
+    prv_init_table();
+  }
+  int32_t a = angle & (TRIG_MAX_ANGLE - 1);
+  if (a < QUARTER) {
+    return s_sin_table[a];
+  } else if (a < 2 * QUARTER) {
+    return s_sin_table[2 * QUARTER - a];
+  } else if (a < 3 * QUARTER) {
+    return -s_sin_table[a - 2 * QUARTER];
+  }
+  return -s_sin_table[TRIG_MAX_ANGLE - a];
+}
+
+int32_t cos_lookup(int32_t angle) {
+  return sin_lookup(angle + QUARTER);
+}
+
+int32_t atan2_lookup(int16_t y, int16_t x) {
+  double a = atan2((double)y, (double)x);
+  if (a < 0) {
+    a += 2 * M_PI;
+  }
+  return (int32_t)(a * TRIG_MAX_ANGLE / (2 * M_PI)) & (TRIG_MAX_ANGLE - 1);
+}
+
+GPoint grect_center_point(const GRect *rect) {
+  return GPoint(rect->origin.x + rect->size.w / 2, rect->origin.y + rect->size.h / 2);
+}
+
+bool gpoint_equal(const GPoint *const point_a, const GPoint *const point_b) {
+  return point_a->x == point_b->x && point_a->y == point_b->y;
+}
+
+bool grect_equal(const GRect *const rect_a, const GRect *const rect_b) {
+  return gpoint_equal(&rect_a->origin, &rect_b->origin) &&
+         rect_a->size.w == rect_b->size.w && rect_a->size.h == rect_b->size.h;
+}
+
+bool gcolor_equal(GColor8 x, GColor8 y) {
+  return x.argb == y.argb || (x.a == 0 && y.a == 0);
+}
@@ -0,0 +1,78 @@
+#!/usr/bin/env python3
+"""Generate the SDK's auto headers for one face from its package.json.
+
+Writes message_keys.auto.h and resource_ids.auto.h, numbered the way the
+Pebble SDK numbers them, plus manifest.c describing the face to the host
+harness (key names, resource names and resource file paths).
+
+usage: gen_auto_headers.py <face_dir> <out_dir> <face_name>
+"""
+
+import json
+import os
+import re
+import sys
+
+MESSAGE_KEY_BASE = 10000
+
+
+def c_ident(name):
+    return re.sub(r'[^A-Za-z0-9_]', '_', name)
+
+
+def main(argv):
+    if len(argv) != 4:
+        sys.stderr.write(__doc__)
+        return 2
+    face_dir, out_dir, face_name = argv[1:]
+    with open(os.path.join(face_dir, 'package.json')) as f:
+        pebble = json.load(f)['pebble']
+
+    keys = []
+    next_key = MESSAGE_KEY_BASE
+    for entry in pebble.get('messageKeys', []):
+        match = re.match(r'^(\w+)(?:\[(\d+)\])?$', entry)
+        keys.append((match.group(1), next_key))
+        next_key += int(match.group(2) or 1)
+
+    media = pebble.get('resources', {}).get('media', [])
+    resources = [(m['name'], i + 1, os.path.abspath(os.path.join(face_dir, 'resources', m['file'])))
+                 for i, m in enumerate(media)]
+
+    os.makedirs(out_dir, exist_ok=True)
+    with open(os.path.join(out_dir, 'message_keys.auto.h'), 'w') as f:
+        f.write('#pragma once\n\n')
+        for name, value in keys:
+            f.write('#define MESSAGE_KEY_%s %d\n' % (name, value))
+
+    with open(os.path.join(out_dir, 'resource_ids.auto.h'), 'w') as f:
+        f.write('#pragma once\n\n')
+        for name, value, _ in resources:
+            f.write('#define RESOURCE_ID_%s %d\n' % (name, value))
+
+    ident = c_ident(face_name)
+    with open(os.path.join(out_dir, 'manifest.c'), 'w') as f:
+        f.write('#include "pebble_host.h"\n\n')
+        f.write('static const HostNamedId s_message_keys[] = {\n')
+        for name, value in keys:
+            f.write('  { "%s", %d },\n' % (name, value))
+        f.write('  { 0 },\n};\n\n')
+        f.write('static const HostNamedId s_resources[] = {\n')
+        for name, value, _ in resources:
+            f.write('  { "%s", %d },\n' % (name, value))
+        f.write('  { 0 },\n};\n\n')
+        f.write('static const char *const s_resource_files[] = {\n  0,\n')
+        for _, _, path in resources:
+            f.write('  %s,\n' % json.dumps(path))
+        f.write('};\n\n')
+        f.write('const HostFaceManifest host_manifest_%s = {\n' % ident)
+        f.write('  .name = "%s",\n' % face_name)
+        f.write('  .message_keys = s_message_keys,\n')
+        f.write('  .resources = s_resources,\n')
+        f.write('  .resource_files = s_resource_files,\n')
+        f.write('};\n')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
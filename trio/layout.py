@@ -0,0 +1,25 @@
+# Per-platform geometry of Trio, written to layout.auto.h at build time by
+# common/tools/gen_layout.py. Lengths are in pixels of the 144 wide (or 180
+# round) design and scale with the display.
+
+
+def build(layout, p):
+    hour_inset = 28 if not p.round else 44
+    minute_inset = 8 if not p.round else 22
+
+    layout.constant('DOT_INSET', p.scaled(6), 'Dots and numerals, from the display edge')
+    layout.constant('NUMBER_INSET', p.scaled(12))
+    layout.constant('HUB_OUTER_RADIUS', p.scaled(4), 'Center circle')
+    layout.constant('HUB_INNER_RADIUS', p.scaled(3))
+
+    # Radial lines at 10, 2 and 6 o'clock, long enough to leave the display
+    radius = max(p.width, p.height)
+    layout.points('LINES', [layout.ray(layout.TRIG_MAX_ANGLE * hour // 12, radius) for hour in (10, 2, 6)],
+                  'Radial lines at 10, 2 and 6 o\'clock')
+
+    layout.rays('HOUR_TIP', layout.hour_angles(), p.width // 2 - p.scaled(hour_inset),
+                'Hour hand tip by LAYOUT_HOUR_INDEX')
+    layout.rays('HAND_TAIL', layout.hour_angles(), -p.scaled(16),
+                'Tail of either hand, by LAYOUT_HOUR_INDEX or tm_min * 12')
+    layout.rays('MINUTE_TIP', layout.minute_angles(), p.width // 2 - p.scaled(minute_inset),
+                'Minute hand tip by tm_min')
@@ -1,19 +1,89 @@
 #include <pebble.h>
 
+#include "dial_cache.h"
+#include "display_list.h"
+#include "face.h"
+#include "face_clock.h"
+#include "instrument.h"
+#include "layout.auto.h"
+#include "numeral_cache.h"
+#include "pdc_color.h"
+#include "peek.h"
+#include "power.h"
+#include "profile.h"
+#include "render_tier.h"
+#include "ray_box.h"
+#include "settings.h"
+
 static Window *s_main_window;
 static Layer *s_canvas_layer;
-static GDrawCommandImage *s_number_6_white;
-static GDrawCommandImage *s_number_6_black;
-static GDrawCommandImage *s_number_2_white;
-static GDrawCommandImage *s_number_2_black;
-static GDrawCommandImage *s_number_10_white;
-static GDrawCommandImage *s_number_10_black;
+// Recolored in place for the current colors when the dial is drawn
+static GDrawCommandImage *s_number_6;
+static GDrawCommandImage *s_number_2;
+static GDrawCommandImage *s_number_10;
+// Loads them after the first frame
+static AppTimer *s_load_timer;
+
+// Snapshot of everything but the hands
+static DialCache s_dial_cache;
+// Center of the dial in the snapshot; a peek moves it
+static int16_t s_dial_center_y;
+// The numerals as drawn, for when the snapshot doesn't fit
+static NumeralCache s_numeral_cache;
+// Hands and hub, redrawn only where they change
+static DisplayList *s_display;
+
+// Dot and numeral positions
+typedef struct {
+  GPoint center;
+  GPoint dots[12];   // indexed by hour; 10, 2 and 6 have lines instead
+  GPoint number_10;  // top-left corners of the numeral images
+  GPoint number_2;
+  int16_t number_6_y;
+} DialLayout;
+
+// Solved for the layer bounds with the screen clear and under a full Quick
+// View peek; s_layout, which is drawn, lies between the two
+static DialLayout s_full_layout;
+static DialLayout s_peek_layout;
+static DialLayout s_layout;
 
 // Time tracking
 static struct tm s_last_time;
 
 // Settings
 static bool s_invert_colors = false;
+static Settings s_settings;
+
+// What each render tier draws beyond the lines, dots, numerals and hands
+enum {
+  ElementNumeralBackgrounds = 1 << 0,
+  ElementHub = 1 << 1,
+};
+
+static const uint32_t s_tiers[RenderTierCount] = {
+  [RenderTierFull] = ElementNumeralBackgrounds | ElementHub,
+  [RenderTierSaver] = 0,
+};
+
+static void update_overlay(bool full);
+
+// The dial changes with the colors, the render tier, and the numerals once
+// they are loaded
+static uint32_t dial_key() {
+  return (s_invert_colors ? 1 : 0) | (render_tier_get() << 1) | ((s_load_timer ? 0 : 1) << 2);
+}
+
+// The numerals copied back as drawn, which a peek moves along with the
+// center
+static uint32_t numeral_key() {
+  return dial_key() | ((uint32_t)(uint16_t)s_layout.center.y << 3);
+}
+
+// Whether the snapshot holds the dial where the peek leaves it
+static bool dial_cached() {
+  return dial_cache_has(&s_dial_cache, dial_key()) && s_dial_center_y == s_layout.center.y;
+}
 
 // Color helper functions
 static GColor get_background_color() {
@@ -43,313 +113,348 @@ static GColor get_hand_minute_color() {
   #endif
 }
 
-// Load settings
+// Load settings, from the blob or the keys older versions used
 static void load_settings() {
-  s_invert_colors = persist_exists(MESSAGE_KEY_INVERT_COLORS) ? 
-                    persist_read_bool(MESSAGE_KEY_INVERT_COLORS) : false;
-}
+  s_invert_colors = false;
 
-// Save settings
-static void save_settings() {
-  persist_write_bool(MESSAGE_KEY_INVERT_COLORS, s_invert_colors);
+  settings_init(&s_settings, 1);
+  settings_add_bool(&s_settings, MESSAGE_KEY_INVERT_COLORS, &s_invert_colors);
+  power_add_settings(&s_settings);
+  render_tier_add_settings(&s_settings);
+  settings_load(&s_settings);
 }
 
 // Inbox received callback
 static void inbox_received_callback(DictionaryIterator *iterator, void *context) {
-  Tuple *invert_tuple = dict_find(iterator, MESSAGE_KEY_INVERT_COLORS);
-  
-  if (invert_tuple) {
-    s_invert_colors = invert_tuple->value->int32 == 1;
-    save_settings();
-    layer_mark_dirty(s_canvas_layer);
+  profile_receive(iterator);
+  if (settings_apply(&s_settings, iterator)) {
+    power_settings_changed();
+    render_tier_settings_changed();
+    update_overlay(true);
   }
 }
 
 // Drawing the clock face
-static void canvas_update_proc(Layer *layer, GContext *ctx) {
-  GRect bounds = layer_get_bounds(layer);
+static GSize number_size(GDrawCommandImage *image) {
+  return image ? gdraw_command_image_get_bounds_size(image) : GSizeZero;
+}
+
+// Places the dots LAYOUT_DOT_INSET from the screen border and the numerals
+// at 10 and 2 o'clock along their lines: on round screens at a fixed
+// radius, on rectangular ones where the line meets the inset border. The 6
+// sits LAYOUT_NUMBER_INSET from the bottom border.
+static void solve_dial_layout(DialLayout *layout, GRect bounds) {
   GPoint center = grect_center_point(&bounds);
-  
-  // Set background
-  graphics_context_set_fill_color(ctx, get_background_color());
-  graphics_fill_rect(ctx, bounds, 0, GCornerNone);
-  
-  // Draw radial lines only for 10, 2, and 6 o'clock
-  graphics_context_set_stroke_color(ctx, get_line_color());
-  graphics_context_set_stroke_width(ctx, 1);
-  
-  // Use a large enough radius to ensure all lines reach edges
-  int radius = bounds.size.w > bounds.size.h ? bounds.size.w : bounds.size.h;
-  
-  // 10 o'clock (position 10)
+  GSize size_10 = number_size(s_number_10);
+  GSize size_2 = number_size(s_number_2);
   int32_t angle_10 = TRIG_MAX_ANGLE * 10 / 12;
-  GPoint outer_10 = {
-    .x = (int16_t)(sin_lookup(angle_10) * radius / TRIG_MAX_RATIO) + center.x,
-    .y = (int16_t)(-cos_lookup(angle_10) * radius / TRIG_MAX_RATIO) + center.y,
-  };
-  graphics_draw_line(ctx, center, outer_10);
-  
-  // 2 o'clock (position 2)
   int32_t angle_2 = TRIG_MAX_ANGLE * 2 / 12;
-  GPoint outer_2 = {
-    .x = (int16_t)(sin_lookup(angle_2) * radius / TRIG_MAX_RATIO) + center.x,
-    .y = (int16_t)(-cos_lookup(angle_2) * radius / TRIG_MAX_RATIO) + center.y,
-  };
-  graphics_draw_line(ctx, center, outer_2);
-  
-  // 6 o'clock (position 6)
-  int32_t angle_6 = TRIG_MAX_ANGLE * 6 / 12;
-  GPoint outer_6 = {
-    .x = (int16_t)(sin_lookup(angle_6) * radius / TRIG_MAX_RATIO) + center.x,
-    .y = (int16_t)(-cos_lookup(angle_6) * radius / TRIG_MAX_RATIO) + center.y,
-  };
-  graphics_draw_line(ctx, center, outer_6);
-  
-  // Draw black dots for other hour positions (3px size, 6px from screen border)
-  graphics_context_set_fill_color(ctx, get_accent_color());
-  
-  // Calculate dot positions for rectangular and round screens
+
   #ifdef PBL_ROUND
-    // For round screens (Chalk), position dots using radius calculation
-    int dot_radius = (bounds.size.w / 2) - 6 - 2;  // 6px from border, 2px for dot radius
+    int dot_radius = (bounds.size.w / 2) - LAYOUT_DOT_INSET - 2;  // 2px for dot radius
+    for (int i = 0; i < 12; i++) {
+      layout->dots[i] = ray_point(TRIG_MAX_ANGLE * i / 12, dot_radius);
+    }
+    GPoint offset_10 = ray_point(angle_10, (bounds.size.w / 2) - LAYOUT_NUMBER_INSET - (size_10.w / 2));
+    GPoint offset_2 = ray_point(angle_2, (bounds.size.w / 2) - LAYOUT_NUMBER_INSET - (size_2.w / 2));
   #else
-    // For rectangular screens, calculate distance to nearest edge at each angle
-    int dot_radius = 0;  // Will be calculated per position
+    RayBox dot_box = {
+      .left = center.x - LAYOUT_DOT_INSET,
+      .top = center.y - LAYOUT_DOT_INSET,
+      .right = bounds.size.w - center.x - LAYOUT_DOT_INSET,
+      .bottom = bounds.size.h - center.y - LAYOUT_DOT_INSET,
+    };
+    for (int i = 0; i < 12; i++) {
+      layout->dots[i] = ray_box_exit(TRIG_MAX_ANGLE * i / 12, dot_box);
+    }
+
+    // The numerals' centers stay LAYOUT_DOT_INSET plus half their size from
+    // the side and top borders
+    RayBox box_10 = { .left = center.x - LAYOUT_DOT_INSET - size_10.w / 2, .top = center.y - LAYOUT_DOT_INSET - size_10.h / 2 };
+    RayBox box_2 = { .right = bounds.size.w - LAYOUT_DOT_INSET - size_2.w / 2 - center.x, .top = center.y - LAYOUT_DOT_INSET - size_2.h / 2 };
+    GPoint offset_10 = ray_box_exit(angle_10, box_10);
+    GPoint offset_2 = ray_box_exit(angle_2, box_2);
   #endif
-  
+
   for (int i = 0; i < 12; i++) {
-    // Skip 10, 2, and 6 o'clock (keep the lines)
-    if (i == 10 || i == 2 || i == 6) continue;
-    
-    int32_t angle = TRIG_MAX_ANGLE * i / 12;
-    
-    #ifdef PBL_ROUND
-      // Round screen: simple radius-based positioning
-      GPoint dot_pos = {
-        .x = (int16_t)(sin_lookup(angle) * dot_radius / TRIG_MAX_RATIO) + center.x,
-        .y = (int16_t)(-cos_lookup(angle) * dot_radius / TRIG_MAX_RATIO) + center.y,
-      };
-    #else
-      // Rectangular screen: calculate distance to nearest edge
-      float sin_a = sin_lookup(angle) / (float)TRIG_MAX_RATIO;
-      float cos_a = -cos_lookup(angle) / (float)TRIG_MAX_RATIO;
-      
-      // Calculate which edge we'll hit first
-      float dist_to_edge;
-      if (sin_a > 0.01) {
-        // Moving right
-        float dist_right = (bounds.size.w - center.x - 6) / sin_a;
-        if (cos_a > 0.01 || cos_a < -0.01) {
-          float dist_vert = (cos_a > 0) ? (bounds.size.h - center.y - 6) / cos_a : (center.y - 6) / -cos_a;
-          dist_to_edge = (dist_right < dist_vert) ? dist_right : dist_vert;
-        } else {
-          dist_to_edge = dist_right;  // Purely horizontal (3 o'clock)
-        }
-      } else if (sin_a < -0.01) {
-        // Moving left
-        float dist_left = (center.x - 6) / -sin_a;
-        if (cos_a > 0.01 || cos_a < -0.01) {
-          float dist_vert = (cos_a > 0) ? (bounds.size.h - center.y - 6) / cos_a : (center.y - 6) / -cos_a;
-          dist_to_edge = (dist_left < dist_vert) ? dist_left : dist_vert;
-        } else {
-          dist_to_edge = dist_left;  // Purely horizontal (9 o'clock)
-        }
-      } else {
-        // sin_a == 0, moving purely vertical
-        dist_to_edge = (cos_a > 0) ? (bounds.size.h - center.y - 6) : (center.y - 6);
-      }
-      
-      GPoint dot_pos = {
-        .x = (int16_t)(sin_a * dist_to_edge) + center.x,
-        .y = (int16_t)(cos_a * dist_to_edge) + center.y,
-      };
-    #endif
-    
-    graphics_fill_circle(ctx, dot_pos, 1);  // 2px diameter = 1px radius
+    layout->dots[i] = GPoint(layout->dots[i].x + center.x, layout->dots[i].y + center.y);
   }
+  layout->number_10 = GPoint(offset_10.x + center.x - size_10.w / 2, offset_10.y + center.y - size_10.h / 2);
+  layout->number_2 = GPoint(offset_2.x + center.x - size_2.w / 2, offset_2.y + center.y - size_2.h / 2);
+  layout->number_6_y = bounds.origin.y + bounds.size.h - number_size(s_number_6).h - LAYOUT_NUMBER_INSET;
+  layout->center = center;
+}
 
-  // Draw PDC number 10 at 10 o'clock position (12px from screen border)
-  if (s_number_10_black && s_number_10_white) {
-    GSize img_size_10 = gdraw_command_image_get_bounds_size(s_invert_colors ? s_number_10_white : s_number_10_black);
-    
-    // Calculate position along 10 o'clock line (300 degrees)
-    int32_t angle_10_pos = TRIG_MAX_ANGLE * 10 / 12;
-    float sin_a = sin_lookup(angle_10_pos) / (float)TRIG_MAX_RATIO;
-    float cos_a = -cos_lookup(angle_10_pos) / (float)TRIG_MAX_RATIO;
-    
-    GPoint pos_10;
-    #ifdef PBL_ROUND
-      // Round screen: simple radius-based positioning
-      int dist_10 = (bounds.size.w / 2) - 12 - (img_size_10.w / 2);
-      pos_10.x = (int16_t)(sin_a * dist_10) + center.x - img_size_10.w / 2;
-      pos_10.y = (int16_t)(cos_a * dist_10) + center.y - img_size_10.h / 2;
-    #else
-      // Rectangular screen: position along the line, accounting for which edge we hit
-      // For 10 o'clock: moving up-left, will hit left edge or top edge
-      // sin_a is negative (moving left), cos_a is negative (moving up)
-      float dist_to_left = (6 + img_size_10.w / 2 - center.x) / sin_a;  // Negative distance
-      float dist_to_top = (6 + img_size_10.h / 2 - center.y) / cos_a;   // Negative distance
-      float dist = (dist_to_left < dist_to_top) ? dist_to_left : dist_to_top;  // Use less negative (closer)
-      
-      pos_10.x = (int16_t)(sin_a * dist) + center.x - img_size_10.w / 2;
-      pos_10.y = (int16_t)(cos_a * dist) + center.y - img_size_10.h / 2;
-    #endif
-    
-    // Draw background for number 10
-    graphics_context_set_fill_color(ctx, get_background_color());
-    graphics_fill_rect(ctx, GRect(pos_10.x + 2, pos_10.y + 2, img_size_10.w - 4, img_size_10.h - 4), 2, GCornersAll);
-    
-    // Draw number 10
-    gdraw_command_image_draw(ctx, s_invert_colors ? s_number_10_white : s_number_10_black, pos_10);
+// Places the dial for how far in the peek is
+static void update_dial_layout() {
+  s_layout.center = peek_lerp_point(s_full_layout.center, s_peek_layout.center);
+  for (int i = 0; i < 12; i++) {
+    s_layout.dots[i] = peek_lerp_point(s_full_layout.dots[i], s_peek_layout.dots[i]);
   }
+  s_layout.number_10 = peek_lerp_point(s_full_layout.number_10, s_peek_layout.number_10);
+  s_layout.number_2 = peek_lerp_point(s_full_layout.number_2, s_peek_layout.number_2);
+  s_layout.number_6_y = peek_lerp(s_full_layout.number_6_y, s_peek_layout.number_6_y);
+}
 
-  // Draw PDC number 2 at 2 o'clock position (12px from screen border)
-  if (s_number_2_black && s_number_2_white) {
-    GSize img_size_2 = gdraw_command_image_get_bounds_size(s_invert_colors ? s_number_2_white : s_number_2_black);
-    
-    // Calculate position along 2 o'clock line (60 degrees)
-    int32_t angle_2_pos = TRIG_MAX_ANGLE * 2 / 12;
-    float sin_a = sin_lookup(angle_2_pos) / (float)TRIG_MAX_RATIO;
-    float cos_a = -cos_lookup(angle_2_pos) / (float)TRIG_MAX_RATIO;
+static void canvas_update_proc(Layer *layer, GContext *ctx) {
+  instrument_stack_begin();
+  profile_frame_begin();
+
+  GRect bounds = layer_get_bounds(layer);
+  GPoint center = s_layout.center;
+  
+  // The dial only changes with its key; restore the last snapshot of it
+  // under the display list's regions when there is one. While a peek
+  // animates the snapshot slides along with the center instead, until the
+  // last frame draws the dial laid out as it ends up.
+  if (s_display && dial_cached()) {
+    for (uint8_t i = 0; i < display_list_get_num_regions(s_display); i++) {
+      dial_cache_restore_rect(&s_dial_cache, ctx, dial_key(), display_list_get_region(s_display, i));
+    }
+  } else if (!peek_is_animating() ||
+             !dial_cache_restore_moved(&s_dial_cache, ctx, dial_key(), center.y - s_dial_center_y)) {
+    // Set background
+    graphics_context_set_fill_color(ctx, get_background_color());
+    graphics_fill_rect(ctx, bounds, 0, GCornerNone);
     
-    GPoint pos_2;
-    #ifdef PBL_ROUND
-      // Round screen: simple radius-based positioning
-      int dist_2 = (bounds.size.w / 2) - 12 - (img_size_2.w / 2);
-      pos_2.x = (int16_t)(sin_a * dist_2) + center.x - img_size_2.w / 2;
-      pos_2.y = (int16_t)(cos_a * dist_2) + center.y - img_size_2.h / 2;
-    #else
-      // Rectangular screen: position along the line, accounting for which edge we hit
-      // For 2 o'clock: moving up-right, will hit right edge or top edge
-      float dist_to_right = (bounds.size.w - 6 - img_size_2.w / 2 - center.x) / sin_a;
-      float dist_to_top = (6 + img_size_2.h / 2 - center.y) / cos_a;
-      float dist = (dist_to_right < dist_to_top) ? dist_to_right : dist_to_top;  // Use the smaller distance
-      
-      pos_2.x = (int16_t)(sin_a * dist) + center.x - img_size_2.w / 2;
-      pos_2.y = (int16_t)(cos_a * dist) + center.y - img_size_2.h / 2;
-    #endif
+    // Draw radial lines only for 10, 2, and 6 o'clock
+    graphics_context_set_stroke_color(ctx, get_line_color());
+    graphics_context_set_stroke_width(ctx, 1);
     
-    // Draw background for number 2
-    graphics_context_set_fill_color(ctx, get_background_color());
-    graphics_fill_rect(ctx, GRect(pos_2.x + 2, pos_2.y + 2, img_size_2.w - 4, img_size_2.h - 4), 2, GCornersAll);
+    // Lines run far enough to leave the screen
+    for (int i = 0; i < 3; i++) {
+      graphics_draw_line(ctx, center, LAYOUT_POINT(center, LAYOUT_LINES[i]));
+    }
     
-    // Draw number 2
-    gdraw_command_image_draw(ctx, s_invert_colors ? s_number_2_white : s_number_2_black, pos_2);
-  }
+    // Draw black dots for other hour positions (3px size, LAYOUT_DOT_INSET from screen border)
+    graphics_context_set_fill_color(ctx, get_accent_color());
+    for (int i = 0; i < 12; i++) {
+      // Skip 10, 2, and 6 o'clock (keep the lines)
+      if (i == 10 || i == 2 || i == 6) continue;
+      graphics_fill_circle(ctx, s_layout.dots[i], 1);  // 2px diameter = 1px radius
+    }
+
+    // Each numeral with its background, as drawn
+    GRect numerals[3];
+    uint8_t num_numerals = 0;
+    bool numerals_cached = numeral_cache_draw(&s_numeral_cache, ctx, numeral_key());
+    if (!numerals_cached) {
+      pdc_color_set(s_number_10, get_accent_color());
+      pdc_color_set(s_number_2, get_accent_color());
+      pdc_color_set(s_number_6, get_accent_color());
+    }
+
+    // Draw PDC number 10 at 10 o'clock position
+    if (s_number_10 && !numerals_cached) {
+      GSize img_size_10 = gdraw_command_image_get_bounds_size(s_number_10);
+      GPoint pos_10 = s_layout.number_10;
+
+      // Draw background for number 10
+      if (render_tier_draws(ElementNumeralBackgrounds)) {
+        graphics_context_set_fill_color(ctx, get_background_color());
+        graphics_fill_rect(ctx, GRect(pos_10.x + 2, pos_10.y + 2, img_size_10.w - 4, img_size_10.h - 4), 2, GCornersAll);
+      }
+
+      // Draw number 10
+      gdraw_command_image_draw(ctx, s_number_10, pos_10);
+      numerals[num_numerals++] = GRect(pos_10.x, pos_10.y, img_size_10.w, img_size_10.h);
+    }
+
+    // Draw PDC number 2 at 2 o'clock position
+    if (s_number_2 && !numerals_cached) {
+      GSize img_size_2 = gdraw_command_image_get_bounds_size(s_number_2);
+      GPoint pos_2 = s_layout.number_2;
+
+      // Draw background for number 2
+      if (render_tier_draws(ElementNumeralBackgrounds)) {
+        graphics_context_set_fill_color(ctx, get_background_color());
+        graphics_fill_rect(ctx, GRect(pos_2.x + 2, pos_2.y + 2, img_size_2.w - 4, img_size_2.h - 4), 2, GCornersAll);
+      }
 
-  // Draw PDC number 6 at bottom (12px from screen border)
-  if (s_number_6_black && s_number_6_white) {
-    GSize img_size = gdraw_command_image_get_bounds_size(s_invert_colors ? s_number_6_white : s_number_6_black);
+      // Draw number 2
+      gdraw_command_image_draw(ctx, s_number_2, pos_2);
+      numerals[num_numerals++] = GRect(pos_2.x, pos_2.y, img_size_2.w, img_size_2.h);
+    }
+
+    // Draw PDC number 6 at bottom (LAYOUT_NUMBER_INSET from screen border)
+    if (s_number_6 && !numerals_cached) {
+      GSize img_size = gdraw_command_image_get_bounds_size(s_number_6);
     
-    // Position 12px from bottom border
-    int y_position = bounds.size.h - img_size.h - 12;
+      // Position LAYOUT_NUMBER_INSET from bottom border
+      int y_position = s_layout.number_6_y;
 
-    // Draw background for number 6
-    graphics_context_set_fill_color(ctx, get_background_color());
-    graphics_fill_rect(ctx, GRect(center.x - (img_size.w - 4) / 2, y_position - 4, img_size.w - 4, img_size.h + 8), 2, GCornersAll);
+      // Draw background for number 6
+      if (render_tier_draws(ElementNumeralBackgrounds)) {
+        graphics_context_set_fill_color(ctx, get_background_color());
+        graphics_fill_rect(ctx, GRect(center.x - (img_size.w - 4) / 2, y_position - 4, img_size.w - 4, img_size.h + 8), 2, GCornersAll);
+      }
     
-    GRect img_rect = GRect(center.x - img_size.w / 2, y_position, img_size.w, img_size.h);
-    gdraw_command_image_draw(ctx, s_invert_colors ? s_number_6_white : s_number_6_black, img_rect.origin);
+      GRect img_rect = GRect(center.x - img_size.w / 2, y_position, img_size.w, img_size.h);
+      gdraw_command_image_draw(ctx, s_number_6, img_rect.origin);
+      // Its background is taller than the image
+      numerals[num_numerals++] = GRect(img_rect.origin.x, y_position - 4, img_size.w, img_size.h + 8);
+    }
+
+    // The frames of a peek animation each place the dial differently
+    if (!peek_is_animating()) {
+      dial_cache_store(&s_dial_cache, ctx, dial_key());
+      s_dial_center_y = center.y;
+    }
+    // Without a snapshot the dial is drawn every frame; copy the numerals
+    // back from then on instead of drawing them
+    if (dial_cache_has(&s_dial_cache, dial_key())) {
+      numeral_cache_destroy(&s_numeral_cache);
+    } else if (num_numerals) {
+      numeral_cache_store(&s_numeral_cache, ctx, numeral_key(), numerals, num_numerals);
+    }
+  }
+
+  profile_frame_end();
+  instrument_frame(!s_load_timer);
+  instrument_heap(InstrumentPointUpdateProc);
+  instrument_stack_end();
+}
+
+// Records the hands and hub for s_last_time
+static void update_overlay(bool full) {
+  update_dial_layout();
+  GPoint center = s_layout.center;
+
+  // Without a display list (out of memory at load) the dial goes without
+  // the parts it records
+  if (!s_display) {
+    layer_mark_dirty(s_canvas_layer);
+    return;
   }
+
+  display_list_begin(s_display);
   
-  // Calculate time values
-  int hour = s_last_time.tm_hour % 12;
+  // Hand endpoints come from the tables in layout.auto.h: the hour hand has
+  // a position for every minute of 12 hours, the minute hand one per minute
+  int hour_index = LAYOUT_HOUR_INDEX(&s_last_time);
   int minute = s_last_time.tm_min;
   
-  // Calculate hand angles
-  int32_t minute_angle = TRIG_MAX_ANGLE * minute / 60;
-  int32_t hour_angle = (TRIG_MAX_ANGLE * ((hour * 60) + minute)) / (12 * 60);
-  
   // Draw hour hand (shorter, thicker, red)
-  graphics_context_set_stroke_width(ctx, 3);
-  graphics_context_set_stroke_color(ctx, get_hand_hour_color());
-  GPoint hour_hand = {
-    .x = (int16_t)(sin_lookup(hour_angle) * (bounds.size.w / 2 - PBL_IF_RECT_ELSE(28, 44)) / TRIG_MAX_RATIO) + center.x,
-    .y = (int16_t)(-cos_lookup(hour_angle) * (bounds.size.w / 2 - PBL_IF_RECT_ELSE(28, 44)) / TRIG_MAX_RATIO) + center.y,
-  };
-  GPoint hour_hand_tail = {
-    .x = (int16_t)(-sin_lookup(hour_angle) * 16 / TRIG_MAX_RATIO) + center.x,
-    .y = (int16_t)(cos_lookup(hour_angle) * 16 / TRIG_MAX_RATIO) + center.y,
-  };
+  GPoint hour_hand = LAYOUT_POINT(center, LAYOUT_HOUR_TIP[hour_index]);
+  GPoint hour_hand_tail = LAYOUT_POINT(center, LAYOUT_HAND_TAIL[hour_index]);
   // Draw from tail through center to tip
-  graphics_draw_line(ctx, hour_hand_tail, center);
-  graphics_draw_line(ctx, center, hour_hand);
+  display_list_draw_line(s_display, hour_hand_tail, center, 3, get_hand_hour_color());
+  display_list_draw_line(s_display, center, hour_hand, 3, get_hand_hour_color());
   
   // Draw minute hand (longer, medium thickness, red)
-  graphics_context_set_stroke_width(ctx, 3);
-  graphics_context_set_stroke_color(ctx, get_hand_minute_color());
-  GPoint minute_hand = {
-    .x = (int16_t)(sin_lookup(minute_angle) * (bounds.size.w / 2 - PBL_IF_RECT_ELSE(8, 22)) / TRIG_MAX_RATIO) + center.x,
-    .y = (int16_t)(-cos_lookup(minute_angle) * (bounds.size.w / 2 - PBL_IF_RECT_ELSE(8, 22)) / TRIG_MAX_RATIO) + center.y,
-  };
-  GPoint minute_hand_tail = {
-    .x = (int16_t)(-sin_lookup(minute_angle) * 16 / TRIG_MAX_RATIO) + center.x,
-    .y = (int16_t)(cos_lookup(minute_angle) * 16 / TRIG_MAX_RATIO) + center.y,
-  };
+  GPoint minute_hand = LAYOUT_POINT(center, LAYOUT_MINUTE_TIP[minute]);
+  GPoint minute_hand_tail = LAYOUT_POINT(center, LAYOUT_HAND_TAIL[minute * 12]);
   // Draw from tail through center to tip
-  graphics_draw_line(ctx, minute_hand_tail, center);
-  graphics_draw_line(ctx, center, minute_hand);
+  display_list_draw_line(s_display, minute_hand_tail, center, 3, get_hand_minute_color());
+  display_list_draw_line(s_display, center, minute_hand, 3, get_hand_minute_color());
   
   // Draw center circle with red border
-  graphics_context_set_stroke_color(ctx, GColorRed);
-  graphics_context_set_stroke_width(ctx, 2);
-  graphics_draw_circle(ctx, center, 4);
-  graphics_context_set_fill_color(ctx, GColorWhite);
-  graphics_fill_circle(ctx, center, 3);
+  if (render_tier_draws(ElementHub)) {
+    display_list_draw_circle(s_display, center, LAYOUT_HUB_OUTER_RADIUS, 2, GColorRed);
+    display_list_fill_circle(s_display, center, LAYOUT_HUB_INNER_RADIUS, GColorWhite);
+  }
+
+  // Without a snapshot of the dial as it stands everything is redrawn
+  display_list_end(s_display, full || !dial_cached());
+}
+
+static void peek_layout(GRect bounds, GRect obstructed) {
+  solve_dial_layout(&s_full_layout, bounds);
+  solve_dial_layout(&s_peek_layout, obstructed);
+}
+
+static void peek_frame(void) {
+  update_overlay(false);
+}
+
+// Redraws everything for the tier the battery charge calls for
+static void render_tier_handler(RenderTier tier) {
+  update_overlay(true);
+}
+
+// Catches up at once on a tap while the power policy held back redraws
+static void power_wake_handler(void) {
+  s_last_time = face_clock_now();
+  update_overlay(false);
 }
 
 // Update time
 static void tick_handler(struct tm *tick_time, TimeUnits units_changed) {
   s_last_time = *tick_time;
-  layer_mark_dirty(s_canvas_layer);
+  if (power_tick(tick_time, units_changed)) {
+    update_overlay(false);
+  }
+  instrument_report();
+}
+
+// Loads the numeral PDC resources once the first frame is out, and places
+// them on the dial, which is then drawn again with them
+static void load_numerals(void *data) {
+  s_load_timer = NULL;
+  s_number_6 = gdraw_command_image_create_with_resource(RESOURCE_ID_NUMBER_6);
+  s_number_2 = gdraw_command_image_create_with_resource(RESOURCE_ID_NUMBER_2);
+  s_number_10 = gdraw_command_image_create_with_resource(RESOURCE_ID_NUMBER_10);
+  peek_relayout();
+  update_overlay(true);
 }
 
 // Window load
 static void main_window_load(Window *window) {
   Layer *window_layer = window_get_root_layer(window);
   GRect bounds = layer_get_bounds(window_layer);
-  
-  // Load NUMBER_6 PDC resource
-  s_number_6_white = gdraw_command_image_create_with_resource(RESOURCE_ID_NUMBER_6_WHITE);
-  s_number_6_black = gdraw_command_image_create_with_resource(RESOURCE_ID_NUMBER_6_BLACK);
-  
-  // Load NUMBER_2 PDC resource
-  s_number_2_white = gdraw_command_image_create_with_resource(RESOURCE_ID_NUMBER_2_WHITE);
-  s_number_2_black = gdraw_command_image_create_with_resource(RESOURCE_ID_NUMBER_2_BLACK);
-  
-  // Load NUMBER_10 PDC resource
-  s_number_10_white = gdraw_command_image_create_with_resource(RESOURCE_ID_NUMBER_10_WHITE);
-  s_number_10_black = gdraw_command_image_create_with_resource(RESOURCE_ID_NUMBER_10_BLACK);
-  
+
   // Create canvas layer
   s_canvas_layer = layer_create(bounds);
   layer_set_update_proc(s_canvas_layer, canvas_update_proc);
   layer_add_child(window_layer, s_canvas_layer);
   
   // Get initial time
-  time_t temp = time(NULL);
-  s_last_time = *localtime(&temp);
+  s_last_time = face_clock_now();
+
+  s_display = display_list_create(s_canvas_layer, 8);
+  peek_init(s_canvas_layer, peek_layout, peek_frame);
+  update_overlay(true);
+
+  // The first frame has the lines, dots and hands; parsing the numerals
+  // would only hold it back
+  s_number_6 = s_number_2 = s_number_10 = NULL;
+  s_load_timer = app_timer_register(0, load_numerals, NULL);
+  if (!s_load_timer) {
+    load_numerals(NULL);
+  }
+
+  instrument_heap(InstrumentPointWindowLoad);
 }
 
 // Window unload
 static void main_window_unload(Window *window) {
+  if (s_load_timer) {
+    app_timer_cancel(s_load_timer);
+    s_load_timer = NULL;
+  }
+  peek_deinit();
+  display_list_destroy(s_display);
   layer_destroy(s_canvas_layer);
-  gdraw_command_image_destroy(s_number_6_white);
-  gdraw_command_image_destroy(s_number_6_black);
-  gdraw_command_image_destroy(s_number_2_white);
-  gdraw_command_image_destroy(s_number_2_black);
-  gdraw_command_image_destroy(s_number_10_white);
-  gdraw_command_image_destroy(s_number_10_black);
+  dial_cache_destroy(&s_dial_cache);
+  numeral_cache_destroy(&s_numeral_cache);
+  gdraw_command_image_destroy(s_number_6);
+  gdraw_command_image_destroy(s_number_2);
+  gdraw_command_image_destroy(s_number_10);
 }
 
 // App initialization
 static void init() {
+  instrument_heap(InstrumentPointInit);
+
   // Load settings
   load_settings();
+  render_tier_init(s_tiers, render_tier_handler);
+  profile_init(&s_settings);
   
   // Create main window
   s_main_window = window_create();
-  window_set_background_color(s_main_window, get_background_color());
+  // The frame buffer keeps the last frame; only changed regions are redrawn
+  window_set_background_color(s_main_window, GColorClear);
   window_set_window_handlers(s_main_window, (WindowHandlers) {
     .load = main_window_load,
     .unload = main_window_unload,
@@ -358,20 +463,28 @@ static void init() {
   
   // Register with TickTimerService
   tick_timer_service_subscribe(MINUTE_UNIT, tick_handler);
+  power_init(power_wake_handler);
   
   // Register callbacks
-  app_message_register_inbox_received(inbox_received_callback);
-  app_message_open(128, 128);
+  face_open_messages(inbox_received_callback, settings_inbox_size(&s_settings), 128);
+  instrument_heap(InstrumentPointAppMessageOpen);
 }
 
 // App deinitialization
 static void deinit() {
+  power_deinit();
+  render_tier_deinit();
+  tick_timer_service_unsubscribe();
   window_destroy(s_main_window);
 }
 
 // Main
+#ifdef FACE_COLLECTION
+const Face face_trio = { .name = "trio", .init = init, .deinit = deinit };
+#else
 int main(void) {
   init();
   app_event_loop();
   deinit();
 }
+#endif
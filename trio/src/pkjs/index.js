@@ -1,9 +1,49 @@
 var Clay = require('@rebble/clay');
 var clayConfig = require('./config');
-var clay = new Clay(clayConfig);
+var clay = new Clay(clayConfig, null, { autoHandleEvents: false });
+
+// Settings go to the watch as deltas it acknowledges (common/src/pkjs)
+require('simple-common/settings')(clay);
 
 Pebble.addEventListener("ready",
     function(e) {
         console.log("Simple Enough watchface ready!");
     }
 );
+
+// Heap, stack and launch figures from builds with INSTRUMENTATION set, laid
+// out as InstrumentSummary in common/src/c/instrument.h
+Pebble.addEventListener('appmessage', function(e) {
+  var data = e.payload.INSTRUMENTATION;
+  if (!data || data[0] !== 2) {
+    return;
+  }
+  var u32 = function(i) {
+    return (data[i] | (data[i + 1] << 8) | (data[i + 2] << 16) | (data[i + 3] << 24)) >>> 0;
+  };
+  var points = ['init', 'window load', 'app message open', 'update proc'];
+  var heap = points.map(function(name, i) {
+    return name + ' ' + u32(1 + i * 8) + ' used/' + u32(5 + i * 8) + ' free';
+  });
+  var u16 = function(i) {
+    return data[i] | (data[i + 1] << 8);
+  };
+  console.log('heap: ' + heap.join(', ') + '; update proc stack: ' + u16(33) + ' bytes; launch: first frame ' +
+    u16(35) + ' ms, complete ' + u16(37) + ' ms');
+});
+
+// Minutes spent in each power mode, laid out as PowerReport in
+// common/src/c/power.h
+Pebble.addEventListener('appmessage', function(e) {
+  var data = e.payload.POWER_REPORT;
+  if (!data || data[0] !== 1) {
+    return;
+  }
+  var u32 = function(i) {
+    return (data[i] | (data[i + 1] << 8) | (data[i + 2] << 16) | (data[i + 3] << 24)) >>> 0;
+  };
+  console.log('power: ' + u32(1) + ' minutes active, ' + u32(5) + ' idle, ' + u32(9) + ' redraws skipped');
+});
+
+// Frame times from builds with PROFILING set (common/src/pkjs)
+require('simple-common/profile')(['INVERT_COLORS', 'POWER_POLICY', 'POWER_INTERVAL', 'BATTERY_SAVER']);